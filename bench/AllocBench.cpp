@@ -0,0 +1,52 @@
+/**
+ * Measures how long it takes to build and tear down a large graph. Most of
+ * this time is spent allocating and freeing Node and Edge objects, so this is
+ * the benchmark to watch when changing how graph elements are allocated.
+ *
+ * Usage: allocbench [nodes] [edges per node]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <sys/time.h>
+
+#include "DotWriter.h"
+
+using namespace DotWriter;
+
+static double Now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+int main(int argc, char** argv) {
+  unsigned long numNodes = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+  unsigned long edgesPerNode = argc > 2 ? strtoul(argv[2], NULL, 10) : 3;
+
+  double start = Now();
+  RootGraph* graph = new RootGraph(true);
+  std::vector<Node*> nodes;
+  nodes.reserve(numNodes);
+  for (unsigned long i = 0; i < numNodes; i++) {
+    nodes.push_back(graph->AddNode());
+  }
+
+  // A cheap LCG keeps the edge list reproducible between runs.
+  unsigned long seed = 12345;
+  for (unsigned long i = 0; i < numNodes; i++) {
+    for (unsigned long j = 0; j < edgesPerNode; j++) {
+      seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+      graph->AddEdge(nodes[i], nodes[(seed >> 33) % numNodes]);
+    }
+  }
+  double built = Now();
+
+  delete graph;
+  double destroyed = Now();
+
+  printf("nodes=%lu edges=%lu construct=%.3fs teardown=%.3fs\n", numNodes,
+    numNodes * edgesPerNode, built - start, destroyed - built);
+  return 0;
+}
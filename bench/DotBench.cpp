@@ -0,0 +1,489 @@
+/**
+ * Benchmarks for DotWriter's hot paths: building graphs, handing out ids,
+ * escaping labels, setting and printing attributes, nesting clusters, and
+ * writing whole graphs to files.
+ *
+ * Each benchmark runs in a child process of its own, so that its peak RSS is
+ * its own. It runs several times over the same inputs (generated from fixed
+ * seeds), and the fastest run is reported, as one line per benchmark:
+ *
+ *   name  items  seconds  items/s  MB/s  peak-RSS-KB
+ *
+ * MB/s is "-" for benchmarks that do not process bytes. The lines come in a
+ * fixed order, so the output of two commits can be compared line by line.
+ *
+ * Usage: dotbench [-r repeats] [name prefix...]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "DotWriter.h"
+
+using namespace DotWriter;
+
+static double Now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/**
+ * Times the part of a benchmark that matters, leaving out its setup.
+ */
+class Timer {
+private:
+  double _start;
+  double _total;
+
+public:
+  Timer() : _start(0), _total(0) {}
+
+  void Start() {
+    _start = Now();
+  }
+
+  void Stop() {
+    _total += Now() - _start;
+  }
+
+  double GetTotal() const {
+    return _total;
+  }
+};
+
+/**
+ * What a benchmark got through. bytes is zero if it does not process bytes.
+ */
+struct Work {
+  unsigned long items;
+  unsigned long bytes;
+};
+
+typedef Work (*BenchFunction)(Timer& timer, unsigned long size);
+
+struct Benchmark {
+  const char* name;
+  BenchFunction function;
+  unsigned long size;
+};
+
+/**
+ * Counts the bytes printed to it, and throws them away.
+ */
+class CountingDotSink : public DotSink {
+private:
+  unsigned long _count;
+
+protected:
+  virtual bool WriteOut(const char* data, size_t length) {
+    (void)data;
+    _count += length;
+    return true;
+  }
+
+public:
+  CountingDotSink() : _count(0) {}
+
+  virtual ~CountingDotSink() {
+    Flush();
+  }
+
+  unsigned long GetCount() {
+    Flush();
+    return _count;
+  }
+};
+
+/**
+ * A cheap LCG keeps generated inputs the same from run to run.
+ */
+class Random {
+private:
+  unsigned long _seed;
+
+public:
+  Random() : _seed(12345) {}
+
+  unsigned long Next(unsigned long limit) {
+    _seed = _seed * 6364136223846793005UL + 1442695040888963407UL;
+    return (_seed >> 33) % limit;
+  }
+};
+
+/**
+ * Fills graph with size nodes and twice as many edges.
+ */
+static void BuildGraph(RootGraph& graph, unsigned long size) {
+  graph.Reserve(size, size * 2);
+  Graph::NodeRange nodes = graph.AddNodes(size);
+  Random random;
+  for (unsigned long i = 0; i < size * 2; i++) {
+    graph.AddEdge(nodes[i / 2], nodes[random.Next(size)]);
+  }
+}
+
+static Work BenchAddNodes(Timer& timer, unsigned long size) {
+  RootGraph graph(true);
+  timer.Start();
+  for (unsigned long i = 0; i < size; i++) {
+    graph.AddNode();
+  }
+  timer.Stop();
+
+  Work work = { size, 0 };
+  return work;
+}
+
+static Work BenchAddEdges(Timer& timer, unsigned long size) {
+  RootGraph graph(true);
+  unsigned long numNodes = size / 3;
+  Graph::NodeRange nodes = graph.AddNodes(numNodes);
+  std::vector<Node*> nodeList(nodes.begin(), nodes.end());
+
+  Random random;
+  timer.Start();
+  for (unsigned long i = 0; i < size; i++) {
+    graph.AddEdge(nodeList[i % numNodes], nodeList[random.Next(numNodes)]);
+  }
+  timer.Stop();
+
+  Work work = { size, 0 };
+  return work;
+}
+
+static Work BenchAutoIds(Timer& timer, unsigned long size) {
+  IdManager ids;
+  timer.Start();
+  for (unsigned long i = 0; i < size; i++) {
+    ids.CreateNodeId();
+  }
+  timer.Stop();
+
+  Work work = { size, 0 };
+  return work;
+}
+
+static Work BenchCustomIds(Timer& timer, unsigned long size) {
+  std::vector<std::string> names(size);
+  for (unsigned long i = 0; i < size; i++) {
+    names[i] = "id" + std::to_string(i);
+  }
+
+  IdManager ids;
+  timer.Start();
+  for (unsigned long i = 0; i < size; i++) {
+    ids.CreateCustomId(names[i]);
+  }
+  timer.Stop();
+
+  Work work = { size, 0 };
+  return work;
+}
+
+/**
+ * Every id but the first collides: half of them with an earlier custom id,
+ * half with a generated one.
+ */
+static Work BenchCollidingIds(Timer& timer, unsigned long size) {
+  std::vector<std::string> names(size);
+  for (unsigned long i = 0; i < size; i++) {
+    names[i] = i % 2 == 0 ? "dup" : "Node" + std::to_string(i / 2);
+  }
+
+  IdManager ids;
+  for (unsigned long i = 0; i < size / 2; i++) {
+    ids.CreateNodeId();
+  }
+
+  timer.Start();
+  for (unsigned long i = 0; i < size; i++) {
+    ids.CreateCustomId(names[i]);
+  }
+  timer.Stop();
+
+  Work work = { size, 0 };
+  return work;
+}
+
+/**
+ * Labels of about 100 characters, one in ten of which needs escaping.
+ */
+static void MakeLabels(std::vector<std::string>& labels, unsigned long size) {
+  static const char* specials[] = { "\"", "\\", "\n" };
+  Random random;
+  labels.resize(size);
+  for (unsigned long i = 0; i < size; i++) {
+    std::string& label = labels[i];
+    while (label.size() < 100) {
+      unsigned long pick = random.Next(40);
+      if (pick < 3) {
+        label += specials[pick];
+      } else {
+        label += static_cast<char>('a' + pick % 26);
+      }
+    }
+  }
+}
+
+static Work BenchSanitize(Timer& timer, unsigned long size) {
+  std::vector<std::string> labels;
+  MakeLabels(labels, size);
+  unsigned long bytes = 0;
+  for (unsigned long i = 0; i < size; i++) {
+    bytes += labels[i].size();
+  }
+
+  timer.Start();
+  for (unsigned long i = 0; i < size; i++) {
+    SanitizeString(labels[i]);
+  }
+  timer.Stop();
+
+  Work work = { size, bytes };
+  return work;
+}
+
+/**
+ * Gives every node a private attribute of the given kind. Each node gets a
+ * different value, so that none of them share a style.
+ */
+static void SetAttributes(Graph::NodeRange& nodes, const char* kind) {
+  for (size_t i = 0; i < nodes.Size(); i++) {
+    NodeAttributeSet& attributes = nodes[i]->MutableAttributes();
+    switch (kind[0]) {
+      case 'b':
+        attributes.SetFixedSize(i % 2 == 0);
+        break;
+      case 'i':
+        attributes.SetPeripheries(static_cast<int>(i));
+        break;
+      case 'u':
+        attributes.SetSides(static_cast<unsigned>(i));
+        break;
+      case 'd':
+        attributes.SetWidth(i * 0.25);
+        break;
+      case 'e':
+        attributes.SetShape(i % 2 == 0 ? NodeShape::BOX : NodeShape::OVAL);
+        break;
+      case 's':
+        attributes.SetTooltip("tip " + std::to_string(i));
+        break;
+      default:
+        attributes.AddCustomAttribute("weight", std::to_string(i));
+        break;
+    }
+  }
+}
+
+static Work BenchSetAttributes(Timer& timer, unsigned long size,
+  const char* kind) {
+  RootGraph graph(true);
+  Graph::NodeRange nodes = graph.AddNodes(size);
+  timer.Start();
+  SetAttributes(nodes, kind);
+  timer.Stop();
+
+  Work work = { size, 0 };
+  return work;
+}
+
+static Work BenchPrintAttributes(Timer& timer, unsigned long size,
+  const char* kind) {
+  RootGraph graph(true);
+  Graph::NodeRange nodes = graph.AddNodes(size);
+  SetAttributes(nodes, kind);
+
+  CountingDotSink sink;
+  timer.Start();
+  graph.Print(sink);
+  unsigned long bytes = sink.GetCount();
+  timer.Stop();
+
+  Work work = { size, bytes };
+  return work;
+}
+
+#define ATTRIBUTE_BENCHMARKS(KIND) \
+  static Work BenchSet_##KIND(Timer& timer, unsigned long size) { \
+    return BenchSetAttributes(timer, size, #KIND); \
+  } \
+  static Work BenchPrint_##KIND(Timer& timer, unsigned long size) { \
+    return BenchPrintAttributes(timer, size, #KIND); \
+  }
+
+ATTRIBUTE_BENCHMARKS(bool)
+ATTRIBUTE_BENCHMARKS(int)
+ATTRIBUTE_BENCHMARKS(unsigned)
+ATTRIBUTE_BENCHMARKS(double)
+ATTRIBUTE_BENCHMARKS(enum)
+ATTRIBUTE_BENCHMARKS(string)
+ATTRIBUTE_BENCHMARKS(custom)
+
+/**
+ * size clusters, each inside the one before, with a few nodes and an edge
+ * back to the enclosing cluster in each.
+ */
+static void BuildNestedClusters(RootGraph& graph, unsigned long size) {
+  Graph* parent = &graph;
+  Node* previous = graph.AddNode("top");
+  for (unsigned long i = 0; i < size; i++) {
+    Cluster* cluster = parent->AddCluster("level " + std::to_string(i));
+    Graph::NodeRange nodes = cluster->AddNodes(4);
+    cluster->AddEdge(previous, nodes[0]);
+    previous = nodes[3];
+    parent = cluster;
+  }
+}
+
+static Work BenchBuildClusters(Timer& timer, unsigned long size) {
+  RootGraph graph(true);
+  timer.Start();
+  BuildNestedClusters(graph, size);
+  timer.Stop();
+
+  Work work = { size, 0 };
+  return work;
+}
+
+static Work BenchPrintClusters(Timer& timer, unsigned long size) {
+  RootGraph graph(true);
+  BuildNestedClusters(graph, size);
+
+  CountingDotSink sink;
+  timer.Start();
+  graph.Print(sink);
+  unsigned long bytes = sink.GetCount();
+  timer.Stop();
+
+  Work work = { size, bytes };
+  return work;
+}
+
+/**
+ * size is the number of elements: a third nodes, the rest edges.
+ */
+static Work BenchWriteToFile(Timer& timer, unsigned long size) {
+  RootGraph graph(true);
+  BuildGraph(graph, size / 3);
+
+  std::string filename = "dotbench.tmp.dot";
+  timer.Start();
+  bool written = graph.WriteToFile(filename);
+  timer.Stop();
+
+  Work work = { size, 0 };
+  struct stat st;
+  if (written && stat(filename.c_str(), &st) == 0) work.bytes = st.st_size;
+  unlink(filename.c_str());
+  return work;
+}
+
+static const Benchmark benchmarks[] = {
+  { "add_nodes", BenchAddNodes, 1000000 },
+  { "add_edges", BenchAddEdges, 3000000 },
+  { "ids_auto", BenchAutoIds, 2000000 },
+  { "ids_custom", BenchCustomIds, 1000000 },
+  { "ids_collide", BenchCollidingIds, 200000 },
+  { "sanitize", BenchSanitize, 500000 },
+  { "attr_set_bool", BenchSet_bool, 200000 },
+  { "attr_set_int", BenchSet_int, 200000 },
+  { "attr_set_unsigned", BenchSet_unsigned, 200000 },
+  { "attr_set_double", BenchSet_double, 200000 },
+  { "attr_set_enum", BenchSet_enum, 200000 },
+  { "attr_set_string", BenchSet_string, 200000 },
+  { "attr_set_custom", BenchSet_custom, 200000 },
+  { "attr_print_bool", BenchPrint_bool, 200000 },
+  { "attr_print_int", BenchPrint_int, 200000 },
+  { "attr_print_unsigned", BenchPrint_unsigned, 200000 },
+  { "attr_print_double", BenchPrint_double, 200000 },
+  { "attr_print_enum", BenchPrint_enum, 200000 },
+  { "attr_print_string", BenchPrint_string, 200000 },
+  { "attr_print_custom", BenchPrint_custom, 200000 },
+  { "cluster_nest_build", BenchBuildClusters, 3000 },
+  { "cluster_nest_print", BenchPrintClusters, 3000 },
+  { "write_10k", BenchWriteToFile, 10000 },
+  { "write_1m", BenchWriteToFile, 1000000 },
+  { "write_10m", BenchWriteToFile, 10000000 },
+};
+
+/**
+ * Runs the benchmark repeats times in this process, and prints its line.
+ */
+static void Run(const Benchmark& benchmark, unsigned repeats) {
+  double best = 0;
+  Work work = { 0, 0 };
+  for (unsigned i = 0; i < repeats; i++) {
+    Timer timer;
+    work = benchmark.function(timer, benchmark.size);
+    if (i == 0 || timer.GetTotal() < best) best = timer.GetTotal();
+  }
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  char rate[32] = "-";
+  if (work.bytes != 0 && best > 0) {
+    snprintf(rate, sizeof(rate), "%.1f", work.bytes / best / 1e6);
+  }
+  printf("%-20s %10lu %10.4f %12.0f %10s %10ld\n", benchmark.name,
+    work.items, best, best > 0 ? work.items / best : 0.0, rate,
+    usage.ru_maxrss);
+}
+
+static bool Selected(const char* name, int argc, char** argv, int first) {
+  if (first == argc) return true;
+  for (int i = first; i < argc; i++) {
+    if (strncmp(name, argv[i], strlen(argv[i])) == 0) return true;
+  }
+  return false;
+}
+
+int main(int argc, char** argv) {
+  unsigned repeats = 3;
+  int first = 1;
+  if (argc > 2 && strcmp(argv[1], "-r") == 0) {
+    repeats = strtoul(argv[2], NULL, 10);
+    if (repeats == 0) repeats = 1;
+    first = 3;
+  }
+
+  printf("%-20s %10s %10s %12s %10s %10s\n", "# benchmark", "items",
+    "seconds", "items/s", "MB/s", "peak-RSS-KB");
+  fflush(stdout);
+
+  int status = 0;
+  for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+    const Benchmark& benchmark = benchmarks[i];
+    if (!Selected(benchmark.name, argc, argv, first)) continue;
+
+    pid_t child = fork();
+    if (child < 0) {
+      perror("fork");
+      return 1;
+    }
+    if (child == 0) {
+      Run(benchmark, repeats);
+      fflush(stdout);
+      _exit(0);
+    }
+
+    int childStatus;
+    if (waitpid(child, &childStatus, 0) < 0 || !WIFEXITED(childStatus) ||
+      WEXITSTATUS(childStatus) != 0) {
+      fprintf(stderr, "%s: failed\n", benchmark.name);
+      status = 1;
+    }
+  }
+
+  return status;
+}
@@ -0,0 +1,78 @@
+#include "Arena.h"
+
+#include <cstdlib>
+
+namespace DotWriter {
+
+const size_t Arena::_blockSize = 64 * 1024;
+const size_t Arena::_alignment = 16;
+
+Arena::~Arena() {
+  std::vector<char*>::iterator it;
+  for (it = _blocks.begin(); it != _blocks.end(); it++) {
+    free(*it);
+  }
+}
+
+Arena::FreeList* Arena::GetFreeList(size_t size) {
+  std::vector<FreeList>::iterator it;
+  for (it = _freeLists.begin(); it != _freeLists.end(); it++) {
+    if (it->size == size) return &(*it);
+  }
+
+  FreeList list;
+  list.size = size;
+  list.head = NULL;
+  _freeLists.push_back(list);
+  return &_freeLists.back();
+}
+
+void Arena::Grow(size_t size) {
+  // Oversized objects get a block of their own, so that they don't waste the
+  // remainder of the current block.
+  size_t blockSize = size > _blockSize / 4 ? size : _blockSize;
+  char* block = static_cast<char*>(malloc(blockSize));
+  if (block == NULL) throw std::bad_alloc();
+
+  _blocks.push_back(block);
+  _reservedBytes += blockSize;
+  if (blockSize == _blockSize) {
+    _cursor = block;
+    _end = block + blockSize;
+  }
+}
+
+void* Arena::Allocate(size_t size) {
+  size = RoundUp(size);
+
+  FreeList* list = GetFreeList(size);
+  if (list->head != NULL) {
+    FreeChunk* chunk = list->head;
+    list->head = chunk->next;
+    return chunk;
+  }
+
+  if (size > _blockSize / 4) {
+    Grow(size);
+    return _blocks.back();
+  }
+
+  if (static_cast<size_t>(_end - _cursor) < size) {
+    Grow(size);
+  }
+
+  void* ptr = _cursor;
+  _cursor += size;
+  return ptr;
+}
+
+void Arena::Deallocate(void* ptr, size_t size) {
+  if (ptr == NULL) return;
+
+  FreeList* list = GetFreeList(RoundUp(size));
+  FreeChunk* chunk = static_cast<FreeChunk*>(ptr);
+  chunk->next = list->head;
+  list->head = chunk;
+}
+
+}  // namespace DotWriter
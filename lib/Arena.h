@@ -0,0 +1,105 @@
+/**
+ * A region allocator for graph elements.
+ *
+ * Nodes, edges, subgraphs and clusters are carved out of large blocks owned by
+ * the arena, and all of the blocks are released at once when the arena is
+ * destroyed. Chunks that are given back with Deallocate (e.g. by RemoveNode)
+ * are kept on per-size free lists and handed out again by later allocations of
+ * the same size.
+ */
+
+#ifndef DOTWRITER_ARENA_H_
+#define DOTWRITER_ARENA_H_
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace DotWriter {
+
+class Arena {
+private:
+  /**
+   * A freed chunk. Overlaid on top of the chunk's own memory.
+   */
+  struct FreeChunk {
+    FreeChunk* next;
+  };
+
+  /**
+   * All of the freed chunks of a single (rounded) size.
+   */
+  struct FreeList {
+    size_t size;
+    FreeChunk* head;
+  };
+
+  // Size of each block requested from the system allocator.
+  static const size_t _blockSize;
+  // Every chunk is aligned (and sized) to a multiple of this.
+  static const size_t _alignment;
+
+  std::vector<char*> _blocks;
+  size_t _reservedBytes;
+  char* _cursor;
+  char* _end;
+  // Graph elements come in a handful of sizes, so a flat list is all we need.
+  std::vector<FreeList> _freeLists;
+
+  static size_t RoundUp(size_t size) {
+    return (size + _alignment - 1) & ~(_alignment - 1);
+  }
+
+  FreeList* GetFreeList(size_t size);
+
+  /**
+   * Starts a new block large enough to hold an object of the given size.
+   */
+  void Grow(size_t size);
+
+  // Not copyable.
+  Arena(const Arena&);
+  Arena& operator=(const Arena&);
+
+public:
+  Arena() : _reservedBytes(0), _cursor(NULL), _end(NULL) {}
+
+  /**
+   * Releases every block. Objects still living in the arena are *not*
+   * destructed; owners must do that first.
+   */
+  virtual ~Arena();
+
+  /**
+   * Returns uninitialized memory for an object of the given size.
+   */
+  void* Allocate(size_t size);
+
+  /**
+   * Gives a chunk obtained from Allocate back to the arena so that it can be
+   * reused. size must match the size passed to Allocate.
+   */
+  void Deallocate(void* ptr, size_t size);
+
+  /**
+   * Runs the destructor of an object allocated in this arena, and gives its
+   * memory back to the arena.
+   */
+  template<typename T>
+  void Destroy(T* obj) {
+    if (obj == NULL) return;
+    obj->~T();
+    Deallocate(obj, sizeof(T));
+  }
+
+  /**
+   * Number of bytes requested from the system allocator so far.
+   */
+  size_t GetReservedBytes() const {
+    return _reservedBytes;
+  }
+};
+
+}  // namespace DotWriter
+
+#endif
@@ -0,0 +1,290 @@
+/**
+ * What the library knows about each standard attribute, as a table that is
+ * available at compile time: its name in DOT files, the kinds of element it
+ * applies to, and the kinds of value it can be given.
+ *
+ * The setters in AttributeSet.h check themselves against this table when they
+ * are compiled, so an attribute cannot be offered on an element it does not
+ * apply to, or with a value of the wrong kind, without the build failing.
+ */
+
+#ifndef DOTWRITER_ATTRIBUTEINFO_H_
+#define DOTWRITER_ATTRIBUTEINFO_H_
+
+#include <string_view>
+
+#include "Attribute.h"
+#include "Enums.h"
+
+namespace DotWriter {
+
+/**
+ * The kinds of element an attribute can be set on. Used as bit flags.
+ */
+struct AttributeTarget {
+  enum e {
+    GRAPH = 1 << 0,
+    SUBGRAPH = 1 << 1,
+    CLUSTER = 1 << 2,
+    NODE = 1 << 3,
+    EDGE = 1 << 4
+  };
+};
+
+/**
+ * The AttributeKind stored by a setter taking a T.
+ */
+template <typename T> struct AttributeKindOf;
+template <> struct AttributeKindOf<bool> {
+  static constexpr AttributeKind::e value = AttributeKind::BOOL;
+};
+template <> struct AttributeKindOf<int> {
+  static constexpr AttributeKind::e value = AttributeKind::INT;
+};
+template <> struct AttributeKindOf<unsigned> {
+  static constexpr AttributeKind::e value = AttributeKind::UNSIGNED;
+};
+template <> struct AttributeKindOf<double> {
+  static constexpr AttributeKind::e value = AttributeKind::DOUBLE;
+};
+
+class AttributeInfo {
+private:
+  struct Entry {
+    AttributeType::e type;
+    std::string_view name;
+    unsigned targets;  // AttributeTarget flags.
+    unsigned kinds;    // One bit per AttributeKind.
+  };
+
+  static constexpr unsigned _g = AttributeTarget::GRAPH;
+  static constexpr unsigned _s = AttributeTarget::SUBGRAPH;
+  static constexpr unsigned _c = AttributeTarget::CLUSTER;
+  static constexpr unsigned _n = AttributeTarget::NODE;
+  static constexpr unsigned _e = AttributeTarget::EDGE;
+
+  static constexpr unsigned _bool = 1 << AttributeKind::BOOL;
+  static constexpr unsigned _int = 1 << AttributeKind::INT;
+  static constexpr unsigned _unsigned = 1 << AttributeKind::UNSIGNED;
+  static constexpr unsigned _double = 1 << AttributeKind::DOUBLE;
+  static constexpr unsigned _addDouble = 1 << AttributeKind::ADD_DOUBLE;
+  static constexpr unsigned _point = 1 << AttributeKind::POINT;
+  static constexpr unsigned _addPoint = 1 << AttributeKind::ADD_POINT;
+  static constexpr unsigned _enum = 1 << AttributeKind::ENUM;
+  // Text, including lists, which are formatted into text when they are set.
+  static constexpr unsigned _string = 1 << AttributeKind::STRING;
+
+  // In AttributeType order.
+  static constexpr Entry _table[] = {
+    { AttributeType::DAMPING, "Damping", _g, _double },
+    { AttributeType::K, "K", _g|_c, _double },
+    { AttributeType::URL, "URL", _g|_c|_n|_e, _string },
+    { AttributeType::AREA, "area", _c|_n, _double },
+    { AttributeType::ARROWHEAD, "arrowhead", _e, _enum },
+    { AttributeType::ARROWSIZE, "arrowsize", _e, _double },
+    { AttributeType::ARROWTAIL, "arrowtail", _e, _enum },
+    { AttributeType::ASPECT, "aspect", _g, _double },
+    { AttributeType::BB, "bb", _g, _string },
+    { AttributeType::BGCOLOR, "bgcolor", _g|_c, _enum|_string },
+    { AttributeType::CENTER, "center", _g, _bool },
+    { AttributeType::CHARSET, "charset", _g, _enum },
+    { AttributeType::CLUSTERRANK, "clusterrank", _g, _enum },
+    { AttributeType::COLOR, "color", _c|_n|_e, _enum|_string },
+    { AttributeType::COLORSCHEME, "colorscheme", _g|_c|_n|_e, _string },
+    { AttributeType::COMMENT, "comment", _g|_n|_e, _string },
+    { AttributeType::COMPOUND, "compound", _g, _bool },
+    { AttributeType::CONCENTRATE, "concentrate", _g, _bool },
+    { AttributeType::CONSTRAINT, "constraint", _e, _bool },
+    { AttributeType::DECORATE, "decorate", _e, _bool },
+    { AttributeType::DEFAULTDIST, "defaultdist", _g, _double },
+    { AttributeType::DIM, "dim", _g, _unsigned },
+    { AttributeType::DIMEN, "dimen", _g, _unsigned },
+    { AttributeType::DIR, "dir", _e, _enum },
+    { AttributeType::DIREDGECONSTRAINTS, "diredgeconstraints", _g, _enum },
+    { AttributeType::DISTORTION, "distortion", _n, _double },
+    { AttributeType::DPI, "dpi", _g, _double },
+    { AttributeType::EDGEURL, "edgeurl", _e, _string },
+    { AttributeType::EDGEHREF, "edgehref", _e, _string },
+    { AttributeType::EDGETARGET, "edgetarget", _e, _string },
+    { AttributeType::EDGETOOLTIP, "edgetooltip", _e, _string },
+    { AttributeType::EPSILON, "epsilon", _g, _double },
+    { AttributeType::ESEP, "esep", _g, _addPoint },
+    { AttributeType::FILLCOLOR, "fillcolor", _c|_n|_e, _enum|_string },
+    { AttributeType::FIXEDSIZE, "fixedsize", _n, _bool },
+    { AttributeType::FONTCOLOR, "fontcolor", _g|_c|_n|_e, _enum },
+    { AttributeType::FONTNAME, "fontname", _g|_c|_n|_e, _string },
+    { AttributeType::FONTNAMES, "fontnames", _g, _string },
+    { AttributeType::FONTPATH, "fontpath", _g, _string },
+    { AttributeType::FONTSIZE, "fontsize", _g|_c|_n|_e, _double },
+    { AttributeType::FORCELABELS, "forcelabels", _g, _bool },
+    { AttributeType::GRADIENTANGLE, "gradientangle", _g|_c|_n, _int },
+    { AttributeType::GROUP, "group", _n, _string },
+    { AttributeType::HEADURL, "headurl", _e, _string },
+    { AttributeType::HEADCLIP, "headclip", _e, _bool },
+    { AttributeType::HEADHREF, "headhref", _e, _string },
+    { AttributeType::HEADLABEL, "headlabel", _e, _string },
+    { AttributeType::HEADPORT, "headport", _e, _enum },
+    { AttributeType::HEADTARGET, "headtarget", _e, _string },
+    { AttributeType::HEADTOOLTIP, "headtooltip", _e, _string },
+    { AttributeType::HEIGHT, "height", _n, _double },
+    { AttributeType::HREF, "href", _g|_c|_n|_e, _string },
+    { AttributeType::ID, "id", _g|_c|_n|_e, _string },
+    { AttributeType::IMAGE, "image", _n, _string },
+    { AttributeType::IMAGEPATH, "imagepath", _g, _string },
+    { AttributeType::IMAGESCALE, "imagescale", _n, _bool|_enum },
+    { AttributeType::LABEL, "label", _g|_c|_n|_e, _string },
+    { AttributeType::LABELURL, "labelurl", _e, _string },
+    { AttributeType::LABEL_SCHEME, "label_scheme", _g, _unsigned },
+    { AttributeType::LABELANGLE, "labelangle", _e, _double },
+    { AttributeType::LABELDISTANCE, "labeldistance", _e, _double },
+    { AttributeType::LABELFLOAT, "labelfloat", _e, _bool },
+    { AttributeType::LABELFONTCOLOR, "labelfontcolor", _e, _enum },
+    { AttributeType::LABELFONTNAME, "labelfontname", _e, _string },
+    { AttributeType::LABELFONTSIZE, "labelfontsize", _e, _double },
+    { AttributeType::LABELHREF, "labelhref", _e, _string },
+    { AttributeType::LABELJUST, "labeljust", _g|_c, _enum },
+    { AttributeType::LABELLOC, "labelloc", _g|_c|_n, _enum },
+    { AttributeType::LABELTARGET, "labeltarget", _e, _string },
+    { AttributeType::LABELTOOLTIP, "labeltooltip", _e, _string },
+    { AttributeType::LANDSCAPE, "landscape", _g, _bool },
+    { AttributeType::LAYER, "layer", _c|_n|_e, _string },
+    { AttributeType::LAYERS, "layers", _g, _string },
+    { AttributeType::LAYERSELECT, "layerselect", _g, _string },
+    { AttributeType::LAYERSEP, "layersep", _g, _string },
+    { AttributeType::LAYOUT, "layout", _g, _string },
+    { AttributeType::LEN, "len", _e, _double },
+    { AttributeType::LEVELS, "levels", _g, _int },
+    { AttributeType::LEVELSGAP, "levelsgap", _g, _double },
+    { AttributeType::LHEAD, "lhead", _e, _string },
+    { AttributeType::LHEIGHT, "lheight", _g|_c, _double },
+    { AttributeType::LP, "lp", _g|_c|_e, _point },
+    { AttributeType::LTAIL, "ltail", _e, _string },
+    { AttributeType::LWIDTH, "lwidth", _g|_c, _double },
+    { AttributeType::MARGIN, "margin", _g|_c|_n, _point },
+    { AttributeType::MAXITER, "maxiter", _g, _int },
+    { AttributeType::MCLIMIT, "mclimit", _g, _double },
+    { AttributeType::MINDIST, "mindist", _g, _double },
+    { AttributeType::MINLEN, "minlen", _e, _int },
+    { AttributeType::MODE, "mode", _g, _enum },
+    { AttributeType::MODEL, "model", _g, _enum },
+    { AttributeType::MOSEK, "mosek", _g, _bool },
+    { AttributeType::NODESEP, "nodesep", _g, _double },
+    { AttributeType::NOJUSTIFY, "nojustify", _g|_c|_n|_e, _bool },
+    { AttributeType::NORMALIZE, "normalize", _g, _bool },
+    { AttributeType::NSLIMIT, "nslimit", _g, _double },
+    { AttributeType::NSLIMIT1, "nslimit1", _g, _double },
+    { AttributeType::ORDERING, "ordering", _g|_n, _enum },
+    { AttributeType::ORIENTATION, "orientation", _g|_n, _double|_string },
+    { AttributeType::OUTPUTORDER, "outputorder", _g, _enum },
+    { AttributeType::OVERLAP, "overlap", _g, _string },
+    { AttributeType::OVERLAP_SCALING, "overlap_scaling", _g, _double },
+    { AttributeType::PACK, "pack", _g, _bool|_int },
+    { AttributeType::PACKMODE, "packmode", _g, _string },
+    { AttributeType::PAD, "pad", _g, _point },
+    { AttributeType::PAGE, "page", _g, _point },
+    { AttributeType::PAGEDIR, "pagedir", _g, _enum },
+    { AttributeType::PENCOLOR, "pencolor", _c, _enum },
+    { AttributeType::PENWIDTH, "penwidth", _c|_n|_e, _double },
+    { AttributeType::PERIPHERIES, "peripheries", _c|_n, _int },
+    { AttributeType::PIN, "pin", _n, _bool },
+    { AttributeType::POS, "pos", _n|_e, _point|_enum },
+    { AttributeType::QUADTREE, "quadtree", _g, _enum },
+    { AttributeType::QUANTUM, "quantum", _g, _double },
+    { AttributeType::RANK, "rank", _s|_c, _enum },
+    { AttributeType::RANKDIR, "rankdir", _g, _enum },
+    { AttributeType::RANKSEP, "ranksep", _g, _double|_string },
+    { AttributeType::RATIO, "ratio", _g, _double|_enum },
+    { AttributeType::RECTS, "rects", _n, _string },
+    { AttributeType::REGULAR, "regular", _n, _bool },
+    { AttributeType::REMINCROSS, "remincross", _g, _bool },
+    { AttributeType::REPULSIVEFORCE, "repulsiveforce", _g, _double },
+    { AttributeType::RESOLUTION, "resolution", _g, _double },
+    { AttributeType::ROOT, "root", _g|_n, _bool|_string },
+    { AttributeType::ROTATE, "rotate", _g, _int },
+    { AttributeType::ROTATION, "rotation", _g, _double },
+    { AttributeType::SAMEHEAD, "samehead", _e, _string },
+    { AttributeType::SAMETAIL, "sametail", _e, _string },
+    { AttributeType::SAMPLEPOINTS, "samplepoints", _n, _unsigned },
+    { AttributeType::SCALE, "scale", _g, _point },
+    { AttributeType::SEARCHSIZE, "searchsize", _g, _int|_addDouble },
+    { AttributeType::SEP, "sep", _g, _addPoint },
+    { AttributeType::SHAPE, "shape", _n, _enum },
+    { AttributeType::SHOWBOXES, "showboxes", _g|_n|_e, _unsigned },
+    { AttributeType::SIDES, "sides", _n, _unsigned },
+    { AttributeType::SIZE, "size", _g, _point },
+    { AttributeType::SKEW, "skew", _n, _double },
+    { AttributeType::SMOOTHING, "smoothing", _g, _enum },
+    { AttributeType::SORTV, "sortv", _g|_c|_n, _int },
+    { AttributeType::SPLINES, "splines", _g, _enum },
+    { AttributeType::START, "start", _g, _string },
+    { AttributeType::STYLE, "style", _g|_c|_n|_e, _string },
+    { AttributeType::STYLESHEET, "stylesheet", _g, _string },
+    { AttributeType::TAILURL, "tailurl", _e, _string },
+    { AttributeType::TAILCLIP, "tailclip", _e, _bool },
+    { AttributeType::TAILHREF, "tailhref", _e, _string },
+    { AttributeType::TAILLABEL, "taillabel", _e, _string },
+    { AttributeType::TAILPORT, "tailport", _e, _enum },
+    { AttributeType::TAILTARGET, "tailtarget", _e, _string },
+    { AttributeType::TAILTOOLTIP, "tailtooltip", _e, _string },
+    { AttributeType::TARGET, "target", _g|_c|_n|_e, _string },
+    { AttributeType::TOOLTIP, "tooltip", _c|_n|_e, _string },
+    { AttributeType::TRUECOLOR, "truecolor", _g, _bool },
+    { AttributeType::VERTICES, "vertices", _n, _string },
+    { AttributeType::VIEWPORT, "viewport", _g, _string },
+    { AttributeType::VORO_MARGIN, "voro_margin", _g, _double },
+    { AttributeType::WEIGHT, "weight", _e, _double },
+    { AttributeType::WIDTH, "width", _n, _double },
+    { AttributeType::XLABEL, "xlabel", _n|_e, _string },
+  };
+
+public:
+  /**
+   * Returns true if there is an entry for every AttributeType, in its own
+   * slot, and each has a name, at least one target and at least one kind of
+   * value. Checked below.
+   */
+  static constexpr bool TableIsValid() {
+    unsigned size = sizeof(_table) / sizeof(_table[0]);
+    if (size != AttributeType::COUNT) return false;
+
+    for (unsigned i = 0; i < size; i++) {
+      const Entry& entry = _table[i];
+      if (entry.type != static_cast<AttributeType::e>(i) ||
+        entry.name.empty() || entry.targets == 0 || entry.kinds == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * The attribute's name in DOT files.
+   */
+  static constexpr std::string_view Name(AttributeType::e type) {
+    return _table[type].name;
+  }
+
+  static constexpr bool AppliesTo(AttributeType::e type,
+    AttributeTarget::e target) {
+    return (_table[type].targets & target) != 0;
+  }
+
+  static constexpr bool Takes(AttributeType::e type, AttributeKind::e kind) {
+    return (_table[type].kinds & (1U << kind)) != 0;
+  }
+
+  /**
+   * Returns true if type can be set to a kind value on target.
+   */
+  static constexpr bool Allows(AttributeType::e type,
+    AttributeTarget::e target, AttributeKind::e kind) {
+    return AppliesTo(type, target) && Takes(type, kind);
+  }
+};
+
+static_assert(AttributeInfo::TableIsValid(),
+  "AttributeInfo needs one complete entry per AttributeType, in order");
+
+}  // namespace DotWriter
+
+#endif
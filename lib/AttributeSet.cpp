@@ -1,8 +1,881 @@
 #include "AttributeSet.h"
 #include "Node.h"
 
+#include <charconv>
+#include <cstring>
+#include <stdint.h>
+
 namespace DotWriter {
 
+AttributeSet::AttributeSet() : _attributes(_inlineAttributes), _size(0),
+  _capacity(_inlineCapacity), _deadBytes(0), _listener(NULL) {
+}
+
+AttributeSet::AttributeSet(const AttributeSet& other) :
+  _attributes(_inlineAttributes), _size(0), _capacity(_inlineCapacity),
+  _deadBytes(0), _listener(NULL) {
+  *this = other;
+}
+
+AttributeSet& AttributeSet::operator=(const AttributeSet& other) {
+  if (this == &other) return *this;
+
+  if (other._size > _capacity) {
+    if (_attributes != _inlineAttributes) delete[] _attributes;
+    _attributes = new Attribute[other._size];
+    _capacity = other._size;
+  }
+
+  std::copy(other._attributes, other._attributes + other._size, _attributes);
+  _size = other._size;
+  _strings = other._strings;
+  _deadBytes = other._deadBytes;
+  Changed();
+  return *this;
+}
+
+AttributeSet::~AttributeSet() {
+  if (_attributes != _inlineAttributes) delete[] _attributes;
+}
+
+const Attribute* AttributeSet::GetAttribute(AttributeType::e type) const {
+  // Standard attributes come first, sorted by type.
+  for (unsigned i = 0; i < _size; i++) {
+    const Attribute& attr = _attributes[i];
+    if (attr.IsCustom() || attr.type > type) break;
+    if (attr.type == type) return &attr;
+  }
+
+  return NULL;
+}
+
+size_t AttributeSet::GetMemoryUsage() const {
+  size_t bytes = sizeof(*this);
+  if (_attributes != _inlineAttributes) bytes += _capacity * sizeof(Attribute);
+  // Short strings are kept inside the std::string itself.
+  if (_strings.capacity() > std::string().capacity()) {
+    bytes += _strings.capacity() + 1;
+  }
+  return bytes;
+}
+
+bool AttributeSet::SetsAllOf(const AttributeSet& other) const {
+  for (unsigned i = 0; i < other._size; i++) {
+    const Attribute& wanted = other._attributes[i];
+    if (!wanted.IsCustom()) {
+      if (GetAttribute(wanted.type) == NULL) return false;
+      continue;
+    }
+
+    const PooledString& name = wanted.value.custom.name;
+    bool found = false;
+    for (unsigned j = 0; j < _size && !found; j++) {
+      const Attribute& attr = _attributes[j];
+      found = attr.IsCustom() && attr.value.custom.name.length == name.length &&
+        memcmp(GetPooled(attr.value.custom.name), other.GetPooled(name),
+        name.length) == 0;
+    }
+    if (!found) return false;
+  }
+
+  return true;
+}
+
+bool AttributeSet::SamePooled(const PooledString& str,
+  const AttributeSet& other, const PooledString& theirs) const {
+  return str.length == theirs.length &&
+    memcmp(GetPooled(str), other.GetPooled(theirs), str.length) == 0;
+}
+
+bool AttributeSet::operator==(const AttributeSet& other) const {
+  if (_size != other._size) return false;
+
+  // Both sets keep their attributes in the same canonical order.
+  for (unsigned i = 0; i < _size; i++) {
+    const Attribute& mine = _attributes[i];
+    const Attribute& theirs = other._attributes[i];
+    if (mine.kind != theirs.kind) return false;
+    if (!mine.IsCustom() && mine.type != theirs.type) return false;
+
+    bool same;
+    switch (mine.kind) {
+      case AttributeKind::BOOL:
+        same = mine.value.boolean == theirs.value.boolean;
+        break;
+      case AttributeKind::INT:
+        same = mine.value.integer == theirs.value.integer;
+        break;
+      case AttributeKind::UNSIGNED:
+        same = mine.value.unsignedInteger == theirs.value.unsignedInteger;
+        break;
+      case AttributeKind::DOUBLE:
+      case AttributeKind::ADD_DOUBLE:
+        same = mine.value.number == theirs.value.number;
+        break;
+      case AttributeKind::POINT:
+      case AttributeKind::ADD_POINT:
+        same = mine.value.point.x == theirs.value.point.x &&
+          mine.value.point.y == theirs.value.point.y;
+        break;
+      case AttributeKind::ENUM:
+        same = mine.value.enumeration.value == theirs.value.enumeration.value;
+        break;
+      case AttributeKind::STRING:
+        same = SamePooled(mine.value.string, other, theirs.value.string);
+        break;
+      case AttributeKind::CUSTOM:
+        same = SamePooled(mine.value.custom.name, other,
+          theirs.value.custom.name) &&
+          SamePooled(mine.value.custom.value, other,
+          theirs.value.custom.value);
+        break;
+      default:
+        same = false;
+        break;
+    }
+    if (!same) return false;
+  }
+
+  return true;
+}
+
+Attribute& AttributeSet::InsertAt(unsigned index) {
+  if (_size == _capacity) {
+    unsigned newCapacity = _capacity * 2;
+    Attribute* newAttributes = new Attribute[newCapacity];
+    std::copy(_attributes, _attributes + _size, newAttributes);
+    if (_attributes != _inlineAttributes) delete[] _attributes;
+    _attributes = newAttributes;
+    _capacity = newCapacity;
+  }
+
+  std::copy_backward(_attributes + index, _attributes + _size,
+    _attributes + _size + 1);
+  _size++;
+  return _attributes[index];
+}
+
+Attribute& AttributeSet::SetAttribute(AttributeType::e type,
+  AttributeKind::e kind) {
+  Changed();
+  CompactStrings();
+
+  unsigned i;
+  for (i = 0; i < _size; i++) {
+    Attribute& attr = _attributes[i];
+    if (attr.IsCustom() || attr.type > type) break;
+
+    if (attr.type == type) {
+      ReleaseStrings(attr);
+      attr.kind = kind;
+      return attr;
+    }
+  }
+
+  Attribute& attr = InsertAt(i);
+  attr.type = type;
+  attr.kind = kind;
+  return attr;
+}
+
+PooledString AttributeSet::StoreString(std::string_view str) {
+  PooledString pooled;
+  pooled.offset = _strings.size();
+  pooled.length = str.size();
+  _strings.append(str);
+  _strings.push_back('\0');
+  return pooled;
+}
+
+PooledString AttributeSet::StoreEscapedString(std::string_view str) {
+  PooledString pooled;
+  pooled.offset = _strings.size();
+  AppendEscaped(_strings, str.data(), str.size());
+  pooled.length = _strings.size() - pooled.offset;
+  _strings.push_back('\0');
+  return pooled;
+}
+
+void AttributeSet::ReleaseString(const PooledString& str) {
+  _deadBytes += str.length + 1;
+}
+
+void AttributeSet::ReleaseStrings(const Attribute& attr) {
+  if (attr.kind == AttributeKind::STRING) {
+    ReleaseString(attr.value.string);
+  } else if (attr.kind == AttributeKind::CUSTOM) {
+    ReleaseString(attr.value.custom.name);
+    ReleaseString(attr.value.custom.value);
+  }
+}
+
+void AttributeSet::CompactStrings() {
+  if (_deadBytes < 64 || _deadBytes * 2 < _strings.size()) return;
+
+  std::string oldStrings;
+  oldStrings.swap(_strings);
+  _strings.reserve(oldStrings.size() - _deadBytes);
+  _deadBytes = 0;
+
+  for (unsigned i = 0; i < _size; i++) {
+    Attribute& attr = _attributes[i];
+    PooledString* strs[2] = { NULL, NULL };
+    if (attr.kind == AttributeKind::STRING) {
+      strs[0] = &attr.value.string;
+    } else if (attr.kind == AttributeKind::CUSTOM) {
+      strs[0] = &attr.value.custom.name;
+      strs[1] = &attr.value.custom.value;
+    }
+
+    for (unsigned j = 0; j < 2 && strs[j] != NULL; j++) {
+      unsigned newOffset = _strings.size();
+      _strings.append(oldStrings, strs[j]->offset, strs[j]->length + 1);
+      strs[j]->offset = newOffset;
+    }
+  }
+}
+
+void AttributeSet::AddCustomAttribute(std::string_view name,
+  std::string_view val) {
+  if (InPool(name) || InPool(val)) {
+    AddCustomAttribute(std::string(name), std::string(val));
+    return;
+  }
+
+  Changed();
+  CompactStrings();
+
+  // Custom attributes follow the standard ones, sorted by name.
+  unsigned i;
+  for (i = 0; i < _size; i++) {
+    Attribute& attr = _attributes[i];
+    if (!attr.IsCustom()) continue;
+
+    const PooledString& attrName = attr.value.custom.name;
+    int cmp = name.compare(0, name.size(), GetPooled(attrName),
+      attrName.length);
+    if (cmp == 0) {
+      ReleaseString(attr.value.custom.value);
+      attr.value.custom.value = StoreEscapedString(val);
+      return;
+    }
+
+    if (cmp < 0) break;
+  }
+
+  Attribute& attr = InsertAt(i);
+  attr.kind = AttributeKind::CUSTOM;
+  attr.value.custom.name = StoreString(name);
+  attr.value.custom.value = StoreEscapedString(val);
+}
+
+/**
+ * Calls visitor.Visit<F>() for the enum F that type takes its values from
+ * (see the ENUM_ATTRIBUTE setters). Returns false if type takes no enum.
+ */
+template <typename V>
+static bool VisitEnum(AttributeType::e type, V& visitor) {
+  switch (type) {
+    case AttributeType::ARROWHEAD:
+    case AttributeType::ARROWTAIL:
+      return visitor.template Visit<EdgeArrowTypeName>();
+    case AttributeType::BGCOLOR:
+    case AttributeType::COLOR:
+    case AttributeType::FILLCOLOR:
+    case AttributeType::FONTCOLOR:
+    case AttributeType::LABELFONTCOLOR:
+    case AttributeType::PENCOLOR:
+      return visitor.template Visit<Color>();
+    case AttributeType::CHARSET:
+      return visitor.template Visit<Charset>();
+    case AttributeType::CLUSTERRANK:
+      return visitor.template Visit<ClusterMode>();
+    case AttributeType::DIR:
+      return visitor.template Visit<DirType>();
+    case AttributeType::DIREDGECONSTRAINTS:
+      return visitor.template Visit<DirEdgeConstraints>();
+    case AttributeType::HEADPORT:
+    case AttributeType::TAILPORT:
+      return visitor.template Visit<CompassPoint>();
+    case AttributeType::LABELJUST:
+      return visitor.template Visit<Justification>();
+    case AttributeType::LABELLOC:
+      return visitor.template Visit<LabelLoc>();
+    case AttributeType::MODE:
+      return visitor.template Visit<Mode>();
+    case AttributeType::MODEL:
+      return visitor.template Visit<Model>();
+    case AttributeType::ORDERING:
+      return visitor.template Visit<Ordering>();
+    case AttributeType::OUTPUTORDER:
+      return visitor.template Visit<OutputMode>();
+    case AttributeType::PAGEDIR:
+      return visitor.template Visit<PageDir>();
+    case AttributeType::QUADTREE:
+      return visitor.template Visit<QuadType>();
+    case AttributeType::RANK:
+      return visitor.template Visit<RankType>();
+    case AttributeType::RANKDIR:
+      return visitor.template Visit<RankDir>();
+    case AttributeType::SHAPE:
+      return visitor.template Visit<NodeShape>();
+    case AttributeType::SMOOTHING:
+      return visitor.template Visit<SmoothType>();
+    case AttributeType::SPLINES:
+      return visitor.template Visit<SplineType>();
+    default:
+      return false;
+  }
+}
+
+namespace {
+
+/**
+ * Looks text up in an attribute's enum.
+ */
+struct EnumParser {
+  std::string_view text;
+  int* val;
+  std::string_view* name;
+
+  template <typename F>
+  bool Visit() {
+    typename F::e value;
+    if (!F::FromString(text, &value)) return false;
+    *val = value;
+    *name = F::ToStringView(value);
+    return true;
+  }
+};
+
+/**
+ * Finds the text of a value of an attribute's enum.
+ */
+struct EnumNamer {
+  int val;
+  std::string_view* name;
+
+  template <typename F>
+  bool Visit() {
+    if (val < 0 || val >= F::COUNT) return false;
+    *name = F::ToStringView(static_cast<typename F::e>(val));
+    return true;
+  }
+};
+
+}  // namespace
+
+static bool ParseEnum(AttributeType::e type, std::string_view text, int* val,
+  std::string_view* name) {
+  EnumParser parser = { text, val, name };
+  return VisitEnum(type, parser);
+}
+
+/**
+ * Parses all of text as a T. from_chars skips no spaces and accepts no '+'.
+ */
+template <typename T>
+static bool ParseNumber(std::string_view text, T* val) {
+  const char* end = text.data() + text.size();
+  std::from_chars_result result = std::from_chars(text.data(), end, *val);
+  return result.ec == std::errc() && result.ptr == end && !text.empty();
+}
+
+static bool ParsePoint(std::string_view text, double* x, double* y) {
+  size_t comma = text.find(',');
+  if (comma == std::string_view::npos) return false;
+  // A trailing '!' (pin the node) has no typed equivalent.
+  return ParseNumber(text.substr(0, comma), x) &&
+    ParseNumber(text.substr(comma + 1), y);
+}
+
+void AttributeSet::SetFromText(AttributeTarget::e target,
+  std::string_view name, std::string_view val) {
+  AttributeType::e type;
+  if (!AttributeType::FromString(name, &type) ||
+      !AttributeInfo::AppliesTo(type, target)) {
+    AddCustomAttribute(name, val);
+    return;
+  }
+
+  int enumValue;
+  std::string_view enumName;
+  if (AttributeInfo::Takes(type, AttributeKind::ENUM) &&
+      ParseEnum(type, val, &enumValue, &enumName)) {
+    SetEnumValue(type, enumValue, enumName);
+    return;
+  }
+
+  if (AttributeInfo::Takes(type, AttributeKind::BOOL) &&
+      (val == "true" || val == "false")) {
+    SetValue(type, val == "true");
+    return;
+  }
+
+  int intValue;
+  if (AttributeInfo::Takes(type, AttributeKind::INT) &&
+      ParseNumber(val, &intValue)) {
+    SetValue(type, intValue);
+    return;
+  }
+
+  unsigned unsignedValue;
+  if (AttributeInfo::Takes(type, AttributeKind::UNSIGNED) &&
+      ParseNumber(val, &unsignedValue)) {
+    SetValue(type, unsignedValue);
+    return;
+  }
+
+  double x, y;
+  bool added = !val.empty() && val[0] == '+';
+  std::string_view number = added ? val.substr(1) : val;
+  if (AttributeInfo::Takes(type,
+        added ? AttributeKind::ADD_DOUBLE : AttributeKind::DOUBLE) &&
+      ParseNumber(number, &x)) {
+    if (added) {
+      AddAddDoubleAttribute(type, x);
+    } else {
+      SetValue(type, x);
+    }
+    return;
+  }
+
+  if (AttributeInfo::Takes(type,
+        added ? AttributeKind::ADD_POINT : AttributeKind::POINT) &&
+      ParsePoint(number, &x, &y)) {
+    SetPointValue(type, added ? AttributeKind::ADD_POINT : AttributeKind::POINT,
+      x, y);
+    return;
+  }
+
+  if (AttributeInfo::Takes(type, AttributeKind::STRING)) {
+    AddStringAttribute(type, val);
+    return;
+  }
+
+  AddCustomAttribute(name, val);
+}
+
+void AttributeSet::SetValue(AttributeType::e type, bool val) {
+  SetAttribute(type, AttributeKind::BOOL).value.boolean = val;
+}
+
+void AttributeSet::SetValue(AttributeType::e type, int val) {
+  SetAttribute(type, AttributeKind::INT).value.integer = val;
+}
+
+void AttributeSet::SetValue(AttributeType::e type, unsigned val) {
+  SetAttribute(type, AttributeKind::UNSIGNED).value.unsignedInteger = val;
+}
+
+void AttributeSet::SetValue(AttributeType::e type, double val) {
+  SetAttribute(type, AttributeKind::DOUBLE).value.number = val;
+}
+
+void AttributeSet::SetValue(AttributeType::e type, std::string_view val) {
+  if (InPool(val)) {
+    SetValue(type, std::string(val));
+    return;
+  }
+
+  Attribute& attr = SetAttribute(type, AttributeKind::STRING);
+  attr.value.string = StoreString(val);
+}
+
+void AttributeSet::AddStringAttribute(AttributeType::e type,
+  std::string_view val) {
+  if (InPool(val)) {
+    AddStringAttribute(type, std::string(val));
+    return;
+  }
+
+  Attribute& attr = SetAttribute(type, AttributeKind::STRING);
+  attr.value.string = StoreEscapedString(val);
+}
+
+void AttributeSet::SetEnumValue(AttributeType::e type, int val,
+  std::string_view name) {
+  Attribute& attr = SetAttribute(type, AttributeKind::ENUM);
+  attr.value.enumeration.value = val;
+  attr.value.enumeration.length = name.size();
+  attr.value.enumeration.name = name.data();
+}
+
+void AttributeSet::SetPointValue(AttributeType::e type, AttributeKind::e kind,
+  double x, double y) {
+  Attribute& attr = SetAttribute(type, kind);
+  attr.value.point.x = x;
+  attr.value.point.y = y;
+}
+
+// Unpack reads these as 32-bit numbers.
+static_assert(sizeof(AttributeKind::e) == sizeof(uint32_t) &&
+  sizeof(AttributeType::e) == sizeof(uint32_t), "unexpected enum size");
+
+namespace {
+
+/**
+ * A packed set is this header, then its attributes, and then the text they
+ * refer to, with offsets relative to the start of that text.
+ */
+struct PackedHeader {
+  uint32_t size;
+  uint32_t stringsLength;
+};
+
+}  // namespace
+
+/**
+ * Copies the pooled string str, with its NUL, onto the end of out, whose
+ * packed text starts at base.
+ */
+static PooledString Repack(std::string& out, size_t base,
+  const std::string& strings, const PooledString& str) {
+  PooledString packed;
+  packed.offset = out.size() - base;
+  packed.length = str.length;
+  out.append(strings, str.offset, str.length + 1);
+  return packed;
+}
+
+void AttributeSet::Pack(std::string& out) const {
+  size_t headerAt = out.size();
+  size_t attributesAt = headerAt + sizeof(PackedHeader);
+  out.append(sizeof(PackedHeader) + _size*sizeof(Attribute), '\0');
+  size_t stringsAt = out.size();
+
+  for (unsigned i = 0; i < _size; i++) {
+    const Attribute& attr = _attributes[i];
+    // Only the member in use is copied, so that the same set always packs
+    // into the same bytes. Enum names are looked up again by Unpack.
+    Attribute packed;
+    memset(&packed, 0, sizeof(packed));
+    packed.kind = attr.kind;
+    if (!attr.IsCustom()) packed.type = attr.type;
+
+    switch (attr.kind) {
+      case AttributeKind::BOOL:
+        packed.value.boolean = attr.value.boolean;
+        break;
+      case AttributeKind::INT:
+        packed.value.integer = attr.value.integer;
+        break;
+      case AttributeKind::UNSIGNED:
+        packed.value.unsignedInteger = attr.value.unsignedInteger;
+        break;
+      case AttributeKind::DOUBLE:
+      case AttributeKind::ADD_DOUBLE:
+        packed.value.number = attr.value.number;
+        break;
+      case AttributeKind::POINT:
+      case AttributeKind::ADD_POINT:
+        packed.value.point = attr.value.point;
+        break;
+      case AttributeKind::ENUM:
+        packed.value.enumeration.value = attr.value.enumeration.value;
+        break;
+      case AttributeKind::STRING:
+        packed.value.string = Repack(out, stringsAt, _strings,
+          attr.value.string);
+        break;
+      case AttributeKind::CUSTOM:
+        packed.value.custom.name = Repack(out, stringsAt, _strings,
+          attr.value.custom.name);
+        packed.value.custom.value = Repack(out, stringsAt, _strings,
+          attr.value.custom.value);
+        break;
+      default:
+        break;
+    }
+
+    memcpy(&out[attributesAt + i*sizeof(Attribute)], &packed, sizeof(packed));
+  }
+
+  PackedHeader header;
+  header.size = _size;
+  header.stringsLength = out.size() - stringsAt;
+  memcpy(&out[headerAt], &header, sizeof(header));
+}
+
+bool AttributeSet::Unpack(std::string_view packed) {
+  Changed();
+  _size = 0;
+  _strings.clear();
+  _deadBytes = 0;
+
+  PackedHeader header;
+  if (packed.size() < sizeof(header)) return false;
+  memcpy(&header, packed.data(), sizeof(header));
+  size_t attributesSize = static_cast<size_t>(header.size)*sizeof(Attribute);
+  if (packed.size() - sizeof(header) < attributesSize ||
+      packed.size() - sizeof(header) - attributesSize !=
+      header.stringsLength) {
+    return false;
+  }
+
+  if (header.size > _capacity) {
+    if (_attributes != _inlineAttributes) delete[] _attributes;
+    _attributes = new Attribute[header.size];
+    _capacity = header.size;
+  }
+  memcpy(_attributes, packed.data() + sizeof(header), attributesSize);
+  _strings.assign(packed.data() + sizeof(header) + attributesSize,
+    header.stringsLength);
+
+  // Nothing is trusted: every attribute must be one that the setters could
+  // have stored, in the order they keep them in.
+  bool seenCustom = false;
+  unsigned i;
+  for (i = 0; i < header.size; i++) {
+    Attribute& attr = _attributes[i];
+    // Read as plain numbers first, since they need not be valid enum values.
+    uint32_t kind, type;
+    memcpy(&kind, &attr.kind, sizeof(kind));
+    memcpy(&type, &attr.type, sizeof(type));
+    if (kind >= AttributeKind::COUNT) break;
+
+    if (attr.IsCustom()) {
+      if (!IsValidPooled(attr.value.custom.name) ||
+          !IsValidPooled(attr.value.custom.value)) {
+        break;
+      }
+      seenCustom = true;
+      continue;
+    }
+
+    if (seenCustom || type >= AttributeType::COUNT ||
+        (i > 0 && attr.type <= _attributes[i - 1].type)) {
+      break;
+    }
+
+    if (attr.kind == AttributeKind::BOOL) {
+      unsigned char boolean;
+      memcpy(&boolean, &attr.value.boolean, sizeof(boolean));
+      attr.value.boolean = boolean != 0;
+    }
+
+    if (attr.kind == AttributeKind::STRING &&
+        !IsValidPooled(attr.value.string)) {
+      break;
+    }
+
+    if (attr.kind == AttributeKind::ENUM) {
+      std::string_view name;
+      EnumNamer namer = { attr.value.enumeration.value, &name };
+      if (!VisitEnum(attr.type, namer)) break;
+      attr.value.enumeration.length = name.size();
+      attr.value.enumeration.name = name.data();
+    }
+  }
+
+  if (i != header.size) {
+    _strings.clear();
+    return false;
+  }
+
+  _size = header.size;
+  return true;
+}
+
+bool AttributeSet::PrintBareValue(DotSink& out, const Attribute& attr) const {
+  char number[32];
+  const char* text;
+  size_t length;
+
+  switch (attr.kind) {
+    case AttributeKind::BOOL:
+      text = attr.value.boolean ? "true" : "false";
+      length = strlen(text);
+      break;
+    case AttributeKind::INT:
+      out.Put('=');
+      out.WriteInteger(attr.value.integer);
+      return true;
+    case AttributeKind::UNSIGNED:
+      out.Put('=');
+      out.WriteUnsigned(attr.value.unsignedInteger);
+      return true;
+    case AttributeKind::DOUBLE:
+      // Exponents and the like still need quotes.
+      length = FormatDouble(attr.value.number, number);
+      text = number;
+      break;
+    case AttributeKind::ENUM:
+      text = attr.value.enumeration.name;
+      length = attr.value.enumeration.length;
+      break;
+    case AttributeKind::STRING:
+      text = GetPooled(attr.value.string);
+      length = attr.value.string.length;
+      break;
+    case AttributeKind::CUSTOM:
+      text = GetPooled(attr.value.custom.value);
+      length = attr.value.custom.value.length;
+      break;
+    default:
+      return false;
+  }
+
+  if (!IsPlainId(text, length)) return false;
+  out.Put('=');
+  out.Write(text, length);
+  return true;
+}
+
+void AttributeSet::PrintAttribute(DotSink& out, const Attribute& attr,
+  bool compact) const {
+  if (attr.IsCustom()) {
+    PrintPooled(out, attr.value.custom.name);
+  } else {
+    std::string_view name = AttributeInfo::Name(attr.type);
+    out.Write(name.data(), name.size());
+  }
+
+  if (compact && PrintBareValue(out, attr)) return;
+
+  out.Write("=\"", 2);
+  PrintValue(out, attr);
+  out.Put('"');
+}
+
+void AttributeSet::PrintValue(DotSink& out, const Attribute& attr) const {
+  switch (attr.kind) {
+    case AttributeKind::BOOL:
+      out.Write(attr.value.boolean ? "true" : "false");
+      break;
+    case AttributeKind::INT:
+      out.WriteInteger(attr.value.integer);
+      break;
+    case AttributeKind::UNSIGNED:
+      out.WriteUnsigned(attr.value.unsignedInteger);
+      break;
+    case AttributeKind::ADD_DOUBLE:
+      out.Put('+');
+      // Fall through.
+    case AttributeKind::DOUBLE:
+      out.WriteDouble(attr.value.number);
+      break;
+    case AttributeKind::ADD_POINT:
+      out.Put('+');
+      // Fall through.
+    case AttributeKind::POINT:
+      out.WriteDouble(attr.value.point.x);
+      out.Put(',');
+      out.WriteDouble(attr.value.point.y);
+      break;
+    case AttributeKind::ENUM:
+      out.Write(attr.value.enumeration.name, attr.value.enumeration.length);
+      break;
+    case AttributeKind::STRING:
+      PrintPooled(out, attr.value.string);
+      break;
+    case AttributeKind::CUSTOM:
+      PrintPooled(out, attr.value.custom.value);
+      break;
+    default:
+      break;
+  }
+}
+
+void AttributeSet::GetAttributeText(unsigned index, std::string& name,
+  std::string& value) const {
+  const Attribute& attr = _attributes[index];
+  if (attr.IsCustom()) {
+    name.assign(GetPooled(attr.value.custom.name),
+      attr.value.custom.name.length);
+  } else {
+    name.assign(AttributeInfo::Name(attr.type));
+  }
+
+  value.clear();
+  StringDotSink sink(value, 256);
+  PrintValue(sink, attr);
+  sink.Flush();
+  // Text is stored escaped, and escaped quotes are the only escapes that
+  // DOT itself undoes. Graphviz takes care of the rest, such as \n.
+  ReplaceAll(value, "\\\"", "\"");
+}
+
+void AttributeSet::Print(DotSink& out, const std::string& prefix,
+  const std::string& postfix) const {
+  PrintAll(out, prefix, postfix, false);
+}
+
+void AttributeSet::PrintAll(DotSink& out, const std::string& prefix,
+  const std::string& postfix, bool compact) const {
+  for (unsigned i = 0; i < _size; i++) {
+    out.Write(prefix);
+    PrintAttribute(out, _attributes[i], compact);
+
+    if (i + 1 != _size)
+      out.Write(postfix);
+  }
+}
+
+void AttributeSet::PrintWithLabel(DotSink& out, std::string_view label,
+  const std::string& prefix, const std::string& postfix, bool compact) const {
+  if (label.empty()) {
+    PrintAll(out, prefix, postfix, compact);
+    return;
+  }
+
+  static const char labelName[] = "label";
+  bool labelPending = true;
+  bool first = true;
+
+  for (unsigned i = 0; i <= _size; i++) {
+    const Attribute* attr = i < _size ? &_attributes[i] : NULL;
+
+    // The label goes where AddCustomAttribute would have put it, and replaces
+    // any custom label already in the set.
+    bool printLabel = false;
+    bool replaced = false;
+    if (labelPending) {
+      if (attr == NULL) {
+        printLabel = true;
+      } else if (attr->IsCustom()) {
+        const PooledString& name = attr->value.custom.name;
+        int cmp = std::char_traits<char>::compare(GetPooled(name), labelName,
+          std::min<size_t>(name.length, sizeof(labelName) - 1));
+        if (cmp == 0) {
+          cmp = static_cast<int>(name.length) -
+            static_cast<int>(sizeof(labelName) - 1);
+        }
+        printLabel = cmp >= 0;
+        replaced = cmp == 0;
+      }
+    }
+
+    if (printLabel) {
+      if (!first) out.Write(postfix);
+      first = false;
+      out.Write(prefix);
+      if (compact && IsPlainId(label.data(), label.size())) {
+        out.Write("label=", 6);
+        out.Write(label.data(), label.size());
+      } else {
+        out.Write("label=\"", 7);
+        out.WriteEscaped(label.data(), label.size());
+        out.Put('"');
+      }
+      labelPending = false;
+    }
+
+    if (attr == NULL || replaced) continue;
+
+    if (!first) out.Write(postfix);
+    first = false;
+    out.Write(prefix);
+    PrintAttribute(out, *attr, compact);
+  }
+}
+
+void AttributeSet::Print(std::ostream& out, const std::string& prefix,
+  const std::string& postfix) const {
+  OstreamDotSink sink(out);
+  Print(sink, prefix, postfix);
+}
+
 void GraphAttributeSet::SetRoot(Node* node) {
   //TODO(jvilk): If node is deleted, this is not cleaned up...
   AddSimpleAttribute<std::string>(AttributeType::ROOT, node->GetId());
@@ -16,52 +16,74 @@
 #define DOTWRITER_ATTRIBUTESET_H_
 
 #include <algorithm>
+#include <functional>
 #include <ostream>
 #include <stdexcept>
-#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "Attribute.h"
+#include "AttributeInfo.h"
+#include "DotSink.h"
 #include "Enums.h"
 #include "Util.h"
 
 using std::runtime_error;
 
-/** HELPER MACROS **/
+/**
+ * HELPER MACROS
+ *
+ * Getters return NULL (or the enum's DEFAULT value) if the attribute is not
+ * set. Returned pointers point into the attribute set, and are only valid
+ * until the set is next modified.
+ *
+ * Each one checks at compile time that AttributeInfo allows the attribute on
+ * the set's target, with that kind of value.
+ */
+#define CHECK_ATTRIBUTE(ATTYPENAME, KIND) \
+  static_assert(AttributeInfo::Allows(AttributeType::ATTYPENAME, target, \
+    KIND), #ATTYPENAME " does not apply here, or takes another kind of value");
+
 #define SIMPLE_ATTRIBUTE(ATTYPENAME, GETSETNAME, TYPE) \
+  CHECK_ATTRIBUTE(ATTYPENAME, AttributeKindOf<TYPE>::value) \
   void Set##GETSETNAME (TYPE val) { \
     AddSimpleAttribute< TYPE >(AttributeType::ATTYPENAME, val); \
   } \
   \
-  SimpleAttribute<TYPE>* Get##GETSETNAME () { \
+  const TYPE* Get##GETSETNAME () const { \
     return GetSimpleAttribute<TYPE>(AttributeType::ATTYPENAME); \
   }
 
 #define STRING_ATTRIBUTE(ATTYPENAME, GETSETNAME) \
-  void Set##GETSETNAME (std::string val) { \
-    val = SanitizeString(val); \
-    AddSimpleAttribute< std::string >(AttributeType::ATTYPENAME, val); \
+  CHECK_ATTRIBUTE(ATTYPENAME, AttributeKind::STRING) \
+  void Set##GETSETNAME (std::string_view val) { \
+    AddStringAttribute(AttributeType::ATTYPENAME, val); \
   } \
   \
-  SimpleAttribute<std::string>* Get##GETSETNAME () { \
-    return GetSimpleAttribute<std::string>(AttributeType::ATTYPENAME); \
+  const char* Get##GETSETNAME () const { \
+    return GetStringAttribute(AttributeType::ATTYPENAME); \
   }
 
 #define BOOL_ATTRIBUTE(ATTYPENAME, GETSETNAME) \
+  CHECK_ATTRIBUTE(ATTYPENAME, AttributeKind::BOOL) \
   void Set##GETSETNAME (bool val) { \
     AddBoolAttribute(AttributeType::ATTYPENAME, val); \
   } \
   \
-  BoolAttribute* Get##GETSETNAME () { \
+  const bool* Get##GETSETNAME () const { \
     return GetBoolAttribute(AttributeType::ATTYPENAME); \
   }
 
 #define ENUM_ATTRIBUTE(ATTYPENAME, GETSETNAME, ENUMTYPENAME) \
+  CHECK_ATTRIBUTE(ATTYPENAME, AttributeKind::ENUM) \
   void Set##GETSETNAME (ENUMTYPENAME::e val) { \
     AddEnumAttribute<ENUMTYPENAME::e, ENUMTYPENAME>(AttributeType::ATTYPENAME, val); \
   } \
   \
-  EnumAttribute<ENUMTYPENAME::e, ENUMTYPENAME>* Get##GETSETNAME () { \
-    return GetEnumAttribute<ENUMTYPENAME::e, ENUMTYPENAME>(AttributeType::ATTYPENAME); \
+  ENUMTYPENAME::e Get##GETSETNAME () const { \
+    return static_cast<ENUMTYPENAME::e>( \
+      GetEnumAttribute(AttributeType::ATTYPENAME, ENUMTYPENAME::DEFAULT)); \
   }
 
 #define DOUBLE_ATTRIBUTE(ATTYPENAME, GETSETNAME) \
@@ -76,199 +98,351 @@ using std::runtime_error;
 namespace DotWriter {
 
 class Node;
+
+/**
+ * Told about every change to an attribute set (see AttributeSet::SetListener).
+ * Graph elements use this to find out when their cached output is stale.
+ */
+class AttributeListener {
+public:
+  virtual ~AttributeListener() {};
+
+  virtual void AttributesChanged() = 0;
+};
+
+/**
+ * Attributes are kept in a small flat array, sorted in output order: standard
+ * attributes by AttributeType, followed by custom attributes by name. The
+ * first few live inside the set itself, so typical elements never allocate.
+ * Text values share a single string pool.
+ */
 class AttributeSet {
 private:
-  std::map<AttributeType::e, StandardAttribute*> _standardAttributes;
-  std::map<std::string, CustomAttribute*> _customAttributes;
+  // Most elements carry only a handful of attributes.
+  static const unsigned _inlineCapacity = 4;
 
-  StandardAttribute* GetAttribute(AttributeType::e name) {
-    if (_standardAttributes.find(name) != _standardAttributes.end()) {
-      return _standardAttributes[name];
-    }
+  Attribute _inlineAttributes[_inlineCapacity];
+  Attribute* _attributes;  // Either _inlineAttributes or a heap array.
+  unsigned _size;
+  unsigned _capacity;
+  // Backing storage for every text value and custom attribute name.
+  std::string _strings;
+  // Bytes in _strings that belong to values that have since been replaced.
+  unsigned _deadBytes;
+  AttributeListener* _listener;
 
-    return NULL;
+  void Changed() {
+    if (_listener != NULL) _listener->AttributesChanged();
   }
 
-  CustomAttribute* GetAttribute(std::string name) {
-    if (_customAttributes.find(name) != _customAttributes.end()) {
-      return _customAttributes[name];
-    }
+  const Attribute* GetAttribute(AttributeType::e type) const;
+
+  /**
+   * Returns the slot for the given standard attribute, creating it in sorted
+   * position if necessary. Any text the slot held is released.
+   */
+  Attribute& SetAttribute(AttributeType::e type, AttributeKind::e kind);
 
-    return NULL;
+  /**
+   * Inserts an uninitialized slot at the given index.
+   */
+  Attribute& InsertAt(unsigned index);
+
+  /**
+   * Returns true if str points into the string pool, which storing anything
+   * may move.
+   */
+  bool InPool(std::string_view str) const {
+    std::less<const char*> before;
+    return !before(str.data(), _strings.data()) &&
+      before(str.data(), _strings.data() + _strings.size());
   }
 
-public:
-  AttributeSet() {
+  /**
+   * Returns true if str is a NUL terminated span of the string pool.
+   */
+  bool IsValidPooled(const PooledString& str) const {
+    return str.offset < _strings.size() &&
+      str.length < _strings.size() - str.offset &&
+      _strings[str.offset + str.length] == '\0';
   }
 
-  virtual ~AttributeSet() {
-    {
-      std::map<AttributeType::e, StandardAttribute*>::iterator it;
-      for (it = _standardAttributes.begin(); it != _standardAttributes.end();
-        it++) {
-        delete it->second;
-      }
-    }
+  PooledString StoreString(std::string_view str);
 
-    {
-      std::map<std::string, CustomAttribute*>::iterator it;
-      for (it = _customAttributes.begin(); it != _customAttributes.end();
-        it++) {
-        delete it->second;
-      }
-    }
-  }
+  /**
+   * Same as StoreString, but escapes str on the way into the pool.
+   */
+  PooledString StoreEscapedString(std::string_view str);
+  void ReleaseString(const PooledString& str);
+  void ReleaseStrings(const Attribute& attr);
+
+  /**
+   * Rebuilds the string pool if most of it belongs to replaced values. Must
+   * only be called when every slot refers to live text.
+   */
+  void CompactStrings();
+
+  /**
+   * Prints name="value". When compact is set, the quotes are left out if DOT
+   * does not need them.
+   */
+  void PrintAttribute(DotSink& out, const Attribute& attr, bool compact) const;
+
+  /**
+   * Prints the value, as it goes between the quotes.
+   */
+  void PrintValue(DotSink& out, const Attribute& attr) const;
+
+  /**
+   * Prints =value for attributes whose value needs no quotes. Returns false,
+   * having printed nothing, for any other attribute.
+   */
+  bool PrintBareValue(DotSink& out, const Attribute& attr) const;
+
+  void PrintAll(DotSink& out, const std::string& prefix,
+    const std::string& postfix, bool compact) const;
 
-  bool Empty() {
-    return _customAttributes.empty() && _standardAttributes.empty();
+  void PrintPooled(DotSink& out, const PooledString& str) const {
+    out.Write(_strings.data() + str.offset, str.length);
   }
 
-  void AddCustomAttribute(const std::string& name, const std::string& val) {
-    std::string val_sanitized = val;
-    SanitizeString(val_sanitized);
-    AddAttribute(new CustomAttribute(name, val_sanitized));
+  const char* GetPooled(const PooledString& str) const {
+    return _strings.c_str() + str.offset;
   }
 
-  virtual void Print(std::ostream& out, const std::string& prefix = "",
-    const std::string& postfix = ", ") {
-    {
-      std::map<AttributeType::e, StandardAttribute*>::iterator it;
-      for (it = _standardAttributes.begin(); it != _standardAttributes.end();
-        it++) {
-        Attribute* at = it->second;
-        out << prefix;
-        at->Print(out);
-
-        if (++it != _standardAttributes.end() || !_customAttributes.empty())
-          out << postfix;
-
-        // HACKFIX: Apparently I can't do it+1 in the above conditional, so I
-        // have to ++it.
-        it--;
-      }
-    }
+  /**
+   * Returns true if str holds the same text as theirs does in other.
+   */
+  bool SamePooled(const PooledString& str, const AttributeSet& other,
+    const PooledString& theirs) const;
 
-    {
-      std::map<std::string, CustomAttribute*>::iterator it;
-      for (it = _customAttributes.begin(); it != _customAttributes.end();
-        it++) {
-        Attribute* at = it->second;
-        out << prefix;
-        at->Print(out);
+public:
+  AttributeSet();
+  AttributeSet(const AttributeSet& other);
+  AttributeSet& operator=(const AttributeSet& other);
+  virtual ~AttributeSet();
 
-        if (++it != _customAttributes.end())
-          out << postfix;
+  bool Empty() const {
+    return _size == 0;
+  }
 
-        it--;
-      }
-    }
+  /**
+   * Number of attributes in this set.
+   */
+  unsigned Size() const {
+    return _size;
   }
 
-protected:
-  void AddAttribute(StandardAttribute* attribute) {
-    AttributeType::e key = attribute->GetType();
-    if (_standardAttributes.find(key) != _standardAttributes.end())
-      delete _standardAttributes[key];
+  /**
+   * Sets name and value to the name and value of the index-th attribute
+   * (index < Size()), as Graphviz reads them from a DOT file: the way they
+   * are printed, but without the quotes. Used to hand attributes to
+   * Graphviz directly (see GraphvizRenderer).
+   */
+  void GetAttributeText(unsigned index, std::string& name,
+    std::string& value) const;
+
+  /**
+   * Bytes of memory the set takes up, including its text.
+   */
+  size_t GetMemoryUsage() const;
 
-    _standardAttributes[key] = attribute;
+  /**
+   * Returns true if every attribute in other is also set here, to any value.
+   */
+  bool SetsAllOf(const AttributeSet& other) const;
+
+  /**
+   * Returns true if other sets the same attributes to the same values.
+   */
+  bool operator==(const AttributeSet& other) const;
+
+  bool operator!=(const AttributeSet& other) const {
+    return !(*this == other);
   }
 
-  void AddAttribute(CustomAttribute* attribute) {
-    std::string key = attribute->GetName();
-    if (_customAttributes.find(key) != _customAttributes.end())
-      delete _customAttributes[key];
+  void AddCustomAttribute(std::string_view name, std::string_view val);
+
+  /**
+   * Sets the attribute called name from the (unescaped) text of its value, the
+   * way it would appear in a DOT file. Standard attributes that apply to
+   * target get the typed value the setters would store, e.g. an enum for
+   * shape=box, or a double for width=1.5. Anything else, including values that
+   * do not parse as the attribute's kind, is kept as a custom attribute with
+   * the text as is. Used by the DOT parser (see RootGraph::Parse).
+   */
+  void SetFromText(AttributeTarget::e target, std::string_view name,
+    std::string_view val);
+
+  /**
+   * Appends the set to out in a flat form without pointers, which Unpack
+   * turns back into the same set. Used by snapshots (see Snapshot). The form
+   * depends on the machine's byte order and struct layout.
+   */
+  void Pack(std::string& out) const;
+
+  /**
+   * Replaces the contents of this set with a set that Pack wrote. Returns
+   * false, leaving the set empty, if packed is not such a set.
+   */
+  bool Unpack(std::string_view packed);
 
-    _customAttributes[attribute->GetName()] = attribute;
+  /**
+   * From now on, listener is told whenever this set changes. Copies of the
+   * set do not inherit the listener, and assigning to the set keeps it.
+   */
+  void SetListener(AttributeListener* listener) {
+    _listener = listener;
   }
 
+  virtual void Print(DotSink& out, const std::string& prefix = "",
+    const std::string& postfix = ", ") const;
+  virtual void Print(std::ostream& out, const std::string& prefix = "",
+    const std::string& postfix = ", ") const;
+
+  /**
+   * Same as Print, but also prints a custom 'label' attribute with the given
+   * text (unless it is empty), as if it were part of this set. Nothing is
+   * added to the set. Used by the graph elements, which keep their label
+   * outside of their attribute set. When compact is set, values are only
+   * quoted if they need to be (see PrintOptions::compact).
+   */
+  void PrintWithLabel(DotSink& out, std::string_view label,
+    const std::string& prefix, const std::string& postfix,
+    bool compact = false) const;
+
+protected:
+  void SetValue(AttributeType::e type, bool val);
+  void SetValue(AttributeType::e type, int val);
+  void SetValue(AttributeType::e type, unsigned val);
+  void SetValue(AttributeType::e type, double val);
+  void SetValue(AttributeType::e type, std::string_view val);
+
+  /**
+   * Stores val escaped for output (see SanitizeString).
+   */
+  void AddStringAttribute(AttributeType::e type, std::string_view val);
+
   void AddBoolAttribute(AttributeType::e type, bool val) {
-    StandardAttribute* attr = new BoolAttribute(type, val);
-    AddAttribute(attr);
+    SetValue(type, val);
   }
 
-  BoolAttribute* GetBoolAttribute(AttributeType::e type) {
-    Attribute* attr = GetAttribute(type);
-    return static_cast<BoolAttribute*>(attr);
+  const bool* GetBoolAttribute(AttributeType::e type) const {
+    const Attribute* attr = GetAttribute(type);
+    if (attr == NULL || attr->kind != AttributeKind::BOOL) return NULL;
+    return &attr->value.boolean;
   }
 
   template<typename T>
   void AddSimpleAttribute(AttributeType::e type, T val) {
-    StandardAttribute* attr = new SimpleAttribute<T>(type, val);
-    AddAttribute(attr);
+    SetValue(type, val);
   }
 
+  /**
+   * Specialized below for int, unsigned and double.
+   */
   template<typename T>
-  SimpleAttribute<T>* GetSimpleAttribute(AttributeType::e type) {
-    Attribute* at = GetAttribute(type);
-    return static_cast< SimpleAttribute<T>* >(at);
+  const T* GetSimpleAttribute(AttributeType::e type) const;
+
+  const char* GetStringAttribute(AttributeType::e type) const {
+    const Attribute* attr = GetAttribute(type);
+    if (attr == NULL || attr->kind != AttributeKind::STRING) return NULL;
+    return GetPooled(attr->value.string);
   }
 
+  /**
+   * Lists are formatted into their colon-separated text form up front.
+   */
   template<typename T>
   void AddSimpleListAttribute(AttributeType::e type,
     const std::vector<T>& vals) {
-    StandardAttribute* attr = new SimpleListAttribute<T>(type, vals);
-    AddAttribute(attr);
+    std::string text;
+    typename std::vector<T>::const_iterator it;
+    for (it = vals.begin(); it != vals.end(); it++) {
+      if (it != vals.begin()) text += ':';
+      AppendDouble(text, *it);
+    }
+    SetValue(type, text);
   }
 
+  void SetEnumValue(AttributeType::e type, int val, std::string_view name);
+
   template<typename T, typename F>
   void AddEnumAttribute(AttributeType::e type, T val) {
-    StandardAttribute* attr = new EnumAttribute<T, F>(type, val);
-    AddAttribute(attr);
+    SetEnumValue(type, val, F::ToStringView(val));
   }
 
-  template<typename T, typename F>
-  EnumAttribute<T,F>* GetEnumAttribute(AttributeType::e type) {
-    Attribute* attr = GetAttribute(type);
-    return static_cast< EnumAttribute<T,F>* >(attr);
+  /**
+   * Returns the enum value stored for type, or defaultVal if there is none.
+   */
+  int GetEnumAttribute(AttributeType::e type, int defaultVal) const {
+    const Attribute* attr = GetAttribute(type);
+    if (attr == NULL || attr->kind != AttributeKind::ENUM) return defaultVal;
+    return attr->value.enumeration.value;
   }
 
   template<typename T, typename F>
-  void AddEnumListAttribute(AttributeType::e type, const std::vector<T>& val) {
-    StandardAttribute* attr = new EnumListAttribute<T, F>(type, val);
-    AddAttribute(attr);
+  void AddEnumListAttribute(AttributeType::e type, const std::vector<T>& vals) {
+    std::string text;
+    typename std::vector<T>::const_iterator it;
+    for (it = vals.begin(); it != vals.end(); it++) {
+      if (it != vals.begin()) text += ':';
+      text += F::ToStringView(*it);
+    }
+    SetValue(type, text);
   }
 
-  template<typename T, typename F>
-  EnumListAttribute<T,F>* GetEnumListAttribute(AttributeType::e type) {
-    Attribute* attr = GetAttribute(type);
-    return static_cast< EnumListAttribute<T,F>* >(attr);
-  }
+  void SetPointValue(AttributeType::e type, AttributeKind::e kind, double x,
+    double y);
 
   void AddPointAttribute(AttributeType::e type, double x, double y) {
-    StandardAttribute* attr = new PointAttribute(type, x, y);
-    AddAttribute(attr);
-  }
-
-  PointAttribute* GetPointAttribute(AttributeType::e type) {
-    Attribute* attr = GetAttribute(type);
-    return static_cast<PointAttribute*>(attr);
+    SetPointValue(type, AttributeKind::POINT, x, y);
   }
 
   void AddAddDoubleAttribute(AttributeType::e type, double val) {
-    StandardAttribute* attr = new AddDoubleAttribute(type, val);
-    AddAttribute(attr);
-  }
-
-  AddDoubleAttribute* GetAddDoubleAttribute(AttributeType::e type) {
-    Attribute* attr = GetAttribute(type);
-    return static_cast<AddDoubleAttribute*>(attr);
+    SetAttribute(type, AttributeKind::ADD_DOUBLE).value.number = val;
   }
 
   void AddAddPointAttribute(AttributeType::e type, double x, double y) {
-    StandardAttribute* attr = new class AddPointAttribute(type, x, y);
-    AddAttribute(attr);
-  }
-
-  class AddPointAttribute* GetAddPointAttribute(AttributeType::e type) {
-    Attribute* attr = GetAttribute(type);
-    return static_cast<class AddPointAttribute*>(attr);
+    SetPointValue(type, AttributeKind::ADD_POINT, x, y);
   }
 };
 
+template<>
+inline const int* AttributeSet::GetSimpleAttribute<int>(
+  AttributeType::e type) const {
+  const Attribute* attr = GetAttribute(type);
+  if (attr == NULL || attr->kind != AttributeKind::INT) return NULL;
+  return &attr->value.integer;
+}
+
+template<>
+inline const unsigned* AttributeSet::GetSimpleAttribute<unsigned>(
+  AttributeType::e type) const {
+  const Attribute* attr = GetAttribute(type);
+  if (attr == NULL || attr->kind != AttributeKind::UNSIGNED) return NULL;
+  return &attr->value.unsignedInteger;
+}
+
+template<>
+inline const double* AttributeSet::GetSimpleAttribute<double>(
+  AttributeType::e type) const {
+  const Attribute* attr = GetAttribute(type);
+  if (attr == NULL || attr->kind != AttributeKind::DOUBLE) return NULL;
+  return &attr->value.number;
+}
+
 class GraphAttributeSet : public AttributeSet {
 public:
+  // What the setters below are checked against (see AttributeInfo).
+  static constexpr AttributeTarget::e target = AttributeTarget::GRAPH;
+
+  virtual void Print(DotSink& out, const std::string& prefix = "",
+    const std::string& postfix = ";\n") const {
+    AttributeSet::Print(out, prefix, postfix);
+  }
   virtual void Print(std::ostream& out, const std::string& prefix = "",
-    const std::string& postfix = ";\n") {
+    const std::string& postfix = ";\n") const {
     AttributeSet::Print(out, prefix, postfix);
   }
 
@@ -1282,9 +1456,16 @@ public:
 
 class SubgraphAttributeSet : public AttributeSet {
 public:
+  // What the setters below are checked against (see AttributeInfo).
+  static constexpr AttributeTarget::e target = AttributeTarget::SUBGRAPH;
+
   SubgraphAttributeSet() { };
+  virtual void Print(DotSink& out, const std::string& prefix = "",
+    const std::string& postfix = ";\n") const {
+    AttributeSet::Print(out, prefix, postfix);
+  }
   virtual void Print(std::ostream& out, const std::string& prefix = "",
-    const std::string& postfix = ";\n") {
+    const std::string& postfix = ";\n") const {
     AttributeSet::Print(out, prefix, postfix);
   }
 
@@ -1293,10 +1474,17 @@ public:
 
 class ClusterAttributeSet : public AttributeSet {
 public:
+  // What the setters below are checked against (see AttributeInfo).
+  static constexpr AttributeTarget::e target = AttributeTarget::CLUSTER;
+
   ClusterAttributeSet() { };
 
+  virtual void Print(DotSink& out, const std::string& prefix = "",
+    const std::string& postfix = ";\n") const {
+    AttributeSet::Print(out, prefix, postfix);
+  }
   virtual void Print(std::ostream& out, const std::string& prefix = "",
-    const std::string& postfix = ";\n") {
+    const std::string& postfix = ";\n") const {
     AttributeSet::Print(out, prefix, postfix);
   }
 
@@ -1613,10 +1801,10 @@ public:
 };
 
 class NodeAttributeSet : public AttributeSet {
-private:
-  std::vector<Attribute*> _attributes;
-
 public:
+  // What the setters below are checked against (see AttributeInfo).
+  static constexpr AttributeTarget::e target = AttributeTarget::NODE;
+
   NodeAttributeSet() { };
 
   /**
@@ -2094,6 +2282,9 @@ public:
 
 class EdgeAttributeSet : public AttributeSet {
 public:
+  // What the setters below are checked against (see AttributeInfo).
+  static constexpr AttributeTarget::e target = AttributeTarget::EDGE;
+
   EdgeAttributeSet() { };
 
   /**
@@ -0,0 +1,62 @@
+#include "BloomFilter.h"
+
+namespace DotWriter {
+
+// ~9.6 bits per element with 7 hashes gives a false positive rate near 1%.
+static const unsigned bitsPerElement = 10;
+static const unsigned numHashes = 7;
+
+/**
+ * 64-bit FNV-1a. The two halves seed the double hashing scheme below.
+ */
+static uint64_t Hash(std::string_view str) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < str.size(); i++) {
+    hash ^= static_cast<unsigned char>(str[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+BloomFilter::BloomFilter(size_t expectedElements) :
+  _numHashes(numHashes) {
+  if (expectedElements == 0) expectedElements = 1;
+  _numBits = static_cast<uint64_t>(expectedElements) * bitsPerElement;
+  _bits.resize((_numBits + 63) / 64, 0);
+  _numBits = _bits.size() * 64;
+}
+
+bool BloomFilter::Insert(std::string_view str) {
+  uint64_t hash = Hash(str);
+  uint64_t h1 = hash & 0xffffffffULL;
+  // Odd, so that successive probes never collapse onto the same bit.
+  uint64_t h2 = (hash >> 32) | 1;
+
+  bool inserted = false;
+  for (unsigned i = 0; i < _numHashes; i++) {
+    uint64_t bit = (h1 + i * h2) % _numBits;
+    uint64_t mask = 1ULL << (bit % 64);
+    uint64_t& word = _bits[bit / 64];
+    if ((word & mask) == 0) {
+      word |= mask;
+      inserted = true;
+    }
+  }
+
+  return inserted;
+}
+
+bool BloomFilter::MayContain(std::string_view str) const {
+  uint64_t hash = Hash(str);
+  uint64_t h1 = hash & 0xffffffffULL;
+  uint64_t h2 = (hash >> 32) | 1;
+
+  for (unsigned i = 0; i < _numHashes; i++) {
+    uint64_t bit = (h1 + i * h2) % _numBits;
+    if ((_bits[bit / 64] & (1ULL << (bit % 64))) == 0) return false;
+  }
+
+  return true;
+}
+
+}  // namespace DotWriter
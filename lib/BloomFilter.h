@@ -0,0 +1,48 @@
+/**
+ * A fixed-size Bloom filter over strings. Used by IdManager to remember ids
+ * in a few bits each, when an exact set of every id would be too large.
+ */
+
+#ifndef DOTWRITER_BLOOMFILTER_H_
+#define DOTWRITER_BLOOMFILTER_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stdint.h>
+
+namespace DotWriter {
+
+class BloomFilter {
+private:
+  std::vector<uint64_t> _bits;
+  uint64_t _numBits;
+  unsigned _numHashes;
+
+public:
+  /**
+   * Sizes the filter for the given number of elements at roughly a 1% false
+   * positive rate.
+   */
+  BloomFilter(size_t expectedElements = 1 << 20);
+
+  /**
+   * Adds str to the filter. Returns false if str may already have been in the
+   * filter, and true if it definitely was not.
+   */
+  bool Insert(std::string_view str);
+
+  /**
+   * Returns true if str may be in the filter, false if it definitely is not.
+   */
+  bool MayContain(std::string_view str) const;
+
+  size_t GetMemoryUsage() const {
+    return _bits.capacity() * sizeof(uint64_t);
+  }
+};
+
+}  // namespace DotWriter
+
+#endif
@@ -2,25 +2,38 @@
 
 namespace DotWriter {
 
-void Cluster::Print(std::ostream& out, unsigned tabDepth) {
-  std::string linePrefix = std::string(tabDepth*_tabIncrement, _tabCharacter);
-  std::string titlePrefix =
-    std::string((tabDepth-1)*_tabIncrement, _tabCharacter);
+void Cluster::PrintHeader(DotSink& out, const PrintOptions& options,
+  unsigned tabDepth) const {
+  if (options.compact) {
+    out.Write("subgraph ");
+    PrintId(out);
+    out.Write("{\n");
+    if (!_attributes.Empty() || !_label.empty()) {
+      _attributes.PrintWithLabel(out, _label, "", "\n", true);
+      out.Put('\n');
+    }
+    return;
+  }
 
-  out << titlePrefix << "subgraph " << GetId() << " {\n";
+  std::string linePrefix = std::string(tabDepth*_tabIncrement, _tabCharacter);
+  unsigned titleIndent = (tabDepth-1)*_tabIncrement;
 
-  if (_label.compare("") != 0) {
-    _attributes.AddCustomAttribute("label", _label);
-  }
+  out.Fill(_tabCharacter, titleIndent);
+  out.Write("subgraph ");
+  PrintId(out);
+  out.Write(" {\n");
 
-  if (!_attributes.Empty()) {
-    _attributes.Print(out, linePrefix);
-    out << ";\n";
+  // The label is printed along with the attributes.
+  if (!_attributes.Empty() || !_label.empty()) {
+    _attributes.PrintWithLabel(out, _label, linePrefix, ";\n");
+    out.Write(";\n");
   }
+}
 
-  PrintNECS(out, tabDepth);
-
-  out << titlePrefix << "}\n";
+void Cluster::PrintFooter(DotSink& out, const PrintOptions& options,
+  unsigned tabDepth) const {
+  if (!options.compact) out.Fill(_tabCharacter, (tabDepth-1)*_tabIncrement);
+  out.Write("}\n");
 }
 
 }  // namespace DotWriter
@@ -11,9 +11,11 @@ private:
   ClusterAttributeSet _attributes;
 
 public:
-  Cluster(const std::string& id, IdManager* idManager, bool isDigraph = false,
-    std::string label = "") : Graph(idManager, isDigraph, label, id),
+  Cluster(IdHandle id, IdManager* idManager, Arena* arena,
+    StylePool* stylePool, bool isDigraph = false, std::string label = "") :
+    Graph(idManager, arena, stylePool, id, isDigraph, std::move(label)),
     _attributes(ClusterAttributeSet()) {
+    _attributes.SetListener(this);
   }
 
   virtual ~Cluster() {};
@@ -23,7 +25,15 @@ public:
     return _attributes;
   }
 
-  virtual void Print(std::ostream& out, unsigned tabDepth);
+  const ClusterAttributeSet& GetAttributes() const {
+    return _attributes;
+  }
+
+protected:
+  virtual void PrintHeader(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth) const;
+  virtual void PrintFooter(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth) const;
 };
 
 }  // namespace DotWriter
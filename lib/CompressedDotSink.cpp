@@ -0,0 +1,326 @@
+#include "CompressedDotSink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace DotWriter {
+
+// Size of the buffer compressed output is collected in before each fwrite.
+static const size_t outputBufferSize = 1 << 16;
+
+/**
+ * Compresses a stream of text into a file.
+ */
+class CompressionCodec {
+private:
+  FILE* _file;
+
+protected:
+  std::vector<char> _output;
+
+  bool WriteToFile(const char* data, size_t length, std::string& error) {
+    if (length != 0 && fwrite(data, 1, length, _file) != length) {
+      error = std::string("fwrite: ") + strerror(errno);
+      return false;
+    }
+    return true;
+  }
+
+public:
+  CompressionCodec(FILE* file) : _file(file), _output(outputBufferSize) {};
+  virtual ~CompressionCodec() {};
+
+  /**
+   * Compresses data, and writes out whatever output is ready. When finish is
+   * set, also ends the stream. Returns false on failure, after filling in
+   * error.
+   */
+  virtual bool Write(const char* data, size_t length, bool finish,
+    std::string& error) = 0;
+};
+
+/**
+ * Compression::NONE; still gets the writing off the printing thread.
+ */
+class PlainCodec : public CompressionCodec {
+public:
+  PlainCodec(FILE* file) : CompressionCodec(file) {};
+
+  virtual bool Write(const char* data, size_t length, bool /*finish*/,
+    std::string& error) {
+    return WriteToFile(data, length, error);
+  }
+};
+
+#ifdef HAVE_ZLIB
+class GzipCodec : public CompressionCodec {
+private:
+  z_stream _stream;
+  bool _initialized;
+
+public:
+  GzipCodec(FILE* file) : CompressionCodec(file), _initialized(false) {
+    memset(&_stream, 0, sizeof(_stream));
+  }
+
+  virtual ~GzipCodec() {
+    if (_initialized) deflateEnd(&_stream);
+  }
+
+  bool Init(int level, std::string& error) {
+    // 15 window bits, plus 16 for a gzip header rather than a zlib one.
+    if (deflateInit2(&_stream, level == 0 ? Z_DEFAULT_COMPRESSION : level,
+      Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+      error = "deflateInit2 failed";
+      return false;
+    }
+    _initialized = true;
+    return true;
+  }
+
+  virtual bool Write(const char* data, size_t length, bool finish,
+    std::string& error) {
+    do {
+      // avail_in is only 32 bits wide.
+      size_t piece = std::min(length, static_cast<size_t>(UINT_MAX));
+      _stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+      _stream.avail_in = piece;
+      data += piece;
+      length -= piece;
+      int flush = (finish && length == 0) ? Z_FINISH : Z_NO_FLUSH;
+
+      int result;
+      do {
+        _stream.next_out = reinterpret_cast<Bytef*>(_output.data());
+        _stream.avail_out = _output.size();
+        result = deflate(&_stream, flush);
+        if (result == Z_STREAM_ERROR) {
+          error = "deflate failed";
+          return false;
+        }
+        if (!WriteToFile(_output.data(), _output.size() - _stream.avail_out,
+          error)) {
+          return false;
+        }
+      } while (_stream.avail_out == 0 ||
+        (flush == Z_FINISH && result != Z_STREAM_END));
+    } while (length > 0);
+
+    return true;
+  }
+};
+#endif
+
+#ifdef HAVE_ZSTD
+class ZstdCodec : public CompressionCodec {
+private:
+  ZSTD_CCtx* _context;
+
+public:
+  ZstdCodec(FILE* file) : CompressionCodec(file), _context(NULL) {};
+
+  virtual ~ZstdCodec() {
+    ZSTD_freeCCtx(_context);
+  }
+
+  bool Init(int level, std::string& error) {
+    _context = ZSTD_createCCtx();
+    if (_context == NULL) {
+      error = "ZSTD_createCCtx failed";
+      return false;
+    }
+    if (level != 0) {
+      size_t result = ZSTD_CCtx_setParameter(_context,
+        ZSTD_c_compressionLevel, level);
+      if (ZSTD_isError(result)) {
+        error = std::string("zstd: ") + ZSTD_getErrorName(result);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  virtual bool Write(const char* data, size_t length, bool finish,
+    std::string& error) {
+    ZSTD_inBuffer in = { data, length, 0 };
+    ZSTD_EndDirective mode = finish ? ZSTD_e_end : ZSTD_e_continue;
+
+    bool done;
+    do {
+      ZSTD_outBuffer out = { _output.data(), _output.size(), 0 };
+      size_t remaining = ZSTD_compressStream2(_context, &out, &in, mode);
+      if (ZSTD_isError(remaining)) {
+        error = std::string("zstd: ") + ZSTD_getErrorName(remaining);
+        return false;
+      }
+      if (!WriteToFile(_output.data(), out.pos, error)) return false;
+      // When finishing, remaining is what is still to be flushed.
+      done = finish ? remaining == 0 : in.pos == in.size;
+    } while (!done);
+
+    return true;
+  }
+};
+#endif
+
+bool CompressedDotSink::IsSupported(Compression::e compression) {
+  switch (compression) {
+    case Compression::NONE:
+      return true;
+#ifdef HAVE_ZLIB
+    case Compression::GZIP:
+      return true;
+#endif
+#ifdef HAVE_ZSTD
+    case Compression::ZSTD:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+CompressionCodec* CompressedDotSink::CreateCodec(Compression::e compression,
+  FILE* file, int level, std::string& error) {
+  switch (compression) {
+    case Compression::NONE:
+      return new PlainCodec(file);
+#ifdef HAVE_ZLIB
+    case Compression::GZIP: {
+      GzipCodec* codec = new GzipCodec(file);
+      if (codec->Init(level, error)) return codec;
+      delete codec;
+      return NULL;
+    }
+#endif
+#ifdef HAVE_ZSTD
+    case Compression::ZSTD: {
+      ZstdCodec* codec = new ZstdCodec(file);
+      if (codec->Init(level, error)) return codec;
+      delete codec;
+      return NULL;
+    }
+#endif
+    default:
+      error = "compression method not supported by this build";
+      return NULL;
+  }
+}
+
+CompressedDotSink::CompressedDotSink(FILE* file, Compression::e compression,
+  int level, size_t bufferSize) :
+  DotSink(bufferSize), _codec(NULL), _closed(false), _finishing(false),
+  _compressFailed(false) {
+  std::string error;
+  _codec = CreateCodec(compression, file, level, error);
+  if (_codec == NULL) {
+    Fail(error);
+    return;
+  }
+
+  _thread = std::thread(&CompressedDotSink::Compress, this);
+}
+
+bool CompressedDotSink::WriteOut(const char* data, size_t length) {
+  if (_closed) {
+    SetError("write after Close");
+    return false;
+  }
+
+  std::string block;
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_compressFailed && _queue.size() >= _maxQueuedBlocks) {
+      _blockDone.wait(lock);
+    }
+    if (_compressFailed) {
+      SetError(_compressError);
+      return false;
+    }
+    if (!_spare.empty()) {
+      block.swap(_spare.back());
+      _spare.pop_back();
+    }
+  }
+
+  block.assign(data, length);
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _queue.push_back(std::string());
+    _queue.back().swap(block);
+  }
+  _blockQueued.notify_one();
+  return true;
+}
+
+/**
+ * Runs on the compression thread.
+ */
+void CompressedDotSink::Compress() {
+  std::string block;
+  std::string error;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      while (_queue.empty() && !_finishing) _blockQueued.wait(lock);
+      if (_queue.empty()) break;
+      block.swap(_queue.front());
+      _queue.pop_front();
+    }
+
+    bool success = _codec->Write(block.data(), block.size(), false, error);
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _spare.push_back(std::string());
+      _spare.back().swap(block);
+      if (!success) {
+        _compressFailed = true;
+        _compressError = error;
+      }
+    }
+    _blockDone.notify_one();
+    if (!success) return;
+  }
+
+  if (!_codec->Write(NULL, 0, true, error)) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _compressFailed = true;
+    _compressError = error;
+  }
+}
+
+bool CompressedDotSink::Close() {
+  if (_closed) return !Failed();
+
+  Flush();
+  _closed = true;
+
+  if (_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _finishing = true;
+    }
+    _blockQueued.notify_one();
+    _thread.join();
+  }
+
+  delete _codec;
+  _codec = NULL;
+
+  if (_compressFailed) Fail(_compressError);
+  return !Failed();
+}
+
+}  // namespace DotWriter
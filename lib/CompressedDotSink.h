@@ -0,0 +1,96 @@
+/**
+ * A DotSink that compresses its output on the way to a file.
+ *
+ * Compression runs on a thread of its own. Each time the sink's buffer
+ * fills up, the text is handed over to that thread, and printing carries on
+ * while the previous block is compressed and written. Only a few blocks are
+ * ever queued, so a slow disk or codec eventually holds printing back rather
+ * than piling up memory.
+ *
+ * Which codecs are available depends on what configure found; see
+ * IsSupported.
+ */
+
+#ifndef DOTWRITER_COMPRESSEDDOTSINK_H_
+#define DOTWRITER_COMPRESSEDDOTSINK_H_
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DotSink.h"
+
+namespace DotWriter {
+
+struct Compression {
+  enum e {
+    NONE,
+    GZIP,  // Needs zlib.
+    ZSTD   // Needs libzstd.
+  };
+};
+
+class CompressionCodec;
+
+class CompressedDotSink : public DotSink {
+private:
+  CompressionCodec* _codec;
+  bool _closed;
+
+  std::thread _thread;
+  std::mutex _mutex;
+  // Signalled when a block is queued, or the sink is closed / when a block
+  // has been compressed.
+  std::condition_variable _blockQueued;
+  std::condition_variable _blockDone;
+  std::deque<std::string> _queue;
+  // Emptied blocks, kept so their memory can be reused.
+  std::vector<std::string> _spare;
+  bool _finishing;
+  // Set by the compression thread.
+  bool _compressFailed;
+  std::string _compressError;
+
+  // Number of blocks that may wait for the compression thread.
+  static const size_t _maxQueuedBlocks = 4;
+
+  static CompressionCodec* CreateCodec(Compression::e compression, FILE* file,
+    int level, std::string& error);
+
+  void Compress();
+
+protected:
+  virtual bool WriteOut(const char* data, size_t length);
+
+public:
+  /**
+   * Compresses into file, which is neither flushed nor closed. level 0 means
+   * the codec's default level.
+   */
+  CompressedDotSink(FILE* file, Compression::e compression, int level = 0,
+    size_t bufferSize = defaultBufferSize);
+
+  virtual ~CompressedDotSink() {
+    Close();
+  }
+
+  /**
+   * Returns true if this build can compress with the given codec.
+   */
+  static bool IsSupported(Compression::e compression);
+
+  /**
+   * Writes out everything buffered so far and ends the compressed stream.
+   * Nothing may be written afterwards. Returns false if anything written to
+   * this sink failed.
+   */
+  bool Close();
+};
+
+}  // namespace DotWriter
+
+#endif
@@ -0,0 +1,378 @@
+#include "DetailReducer.h"
+
+#include <algorithm>
+
+#include "Cluster.h"
+#include "Edge.h"
+#include "GraphView.h"
+#include "Node.h"
+#include "RootGraph.h"
+#include "Subgraph.h"
+#include "Util.h"
+
+namespace DotWriter {
+
+static const size_t none = static_cast<size_t>(-1);
+
+/**
+ * Stores what a TextProvider adds to an element of the original graph in
+ * the element's copy, whose graph has no provider. Only what is kept gets
+ * this far, so there is much less of it.
+ */
+template <typename T>
+class CopyAttributeWriter : public AttributeWriter {
+private:
+  T* _copy;
+  AttributeTarget::e _target;
+
+public:
+  CopyAttributeWriter(T* copy, AttributeTarget::e target) :
+    _copy(copy), _target(target) {};
+
+  virtual void Add(std::string_view name, std::string_view value) {
+    if (name == "label") {
+      _copy->SetLabel(std::string(value));
+    } else {
+      _copy->MutableAttributes().SetFromText(_target, name, value);
+    }
+  }
+};
+
+bool DetailReducer::HeavierVertex::operator()(size_t a, size_t b) const {
+  double aWeight = (*vertices)[a].weight;
+  double bWeight = (*vertices)[b].weight;
+  if (aWeight != bWeight) return aWeight > bWeight;
+  return a < b;
+}
+
+DetailReducer::DetailReducer(const PrintOptions& options, bool isDigraph) :
+  _options(options), _isDigraph(isDigraph) {
+}
+
+size_t DetailReducer::CountNodes(const Graph* graph) {
+  size_t count = graph->_nodes.Size();
+
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = graph->_subgraphs.begin(); sgIt != graph->_subgraphs.end();
+    sgIt++) {
+    count += CountNodes(*sgIt);
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = graph->_clusters.begin(); cIt != graph->_clusters.end(); cIt++) {
+    count += CountNodes(*cIt);
+  }
+
+  _sizes[graph] = count;
+  return count;
+}
+
+void DetailReducer::Collect(const Graph* graph, unsigned depth,
+  size_t collapsed) {
+  size_t first = _vertexOf.size();
+  _firstSlot[graph] = first;
+  _vertexOf.resize(first + graph->_nodes.SlotCount(), none);
+
+  // Weights only matter when choosing which nodes to keep.
+  bool weigh = _options.maxNodes != 0 && _options.nodeWeight != NULL;
+
+  SlotList<Node>::iterator nodeIt;
+  for (nodeIt = graph->_nodes.begin(); nodeIt != graph->_nodes.end();
+    nodeIt++) {
+    const Node* node = *nodeIt;
+    double weight = weigh ? _options.nodeWeight(node, _options.weightContext) :
+      0;
+    size_t vertex = collapsed;
+    if (vertex == none) {
+      Vertex added = { node, NULL, 1, weight, true, NULL };
+      vertex = _vertices.size();
+      _vertices.push_back(added);
+    } else {
+      _vertices[vertex].numNodes++;
+      _vertices[vertex].weight += weight;
+    }
+    _vertexOf[first + node->_slot] = vertex;
+  }
+
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = graph->_subgraphs.begin(); sgIt != graph->_subgraphs.end();
+    sgIt++) {
+    Collect(*sgIt, depth, collapsed);
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = graph->_clusters.begin(); cIt != graph->_clusters.end(); cIt++) {
+    const Cluster* cluster = *cIt;
+    size_t inner = collapsed;
+    if (inner == none &&
+      ((_options.collapseDepth != 0 && depth + 1 >= _options.collapseDepth) ||
+      (_options.collapseSize != 0 &&
+      _sizes[cluster] > _options.collapseSize))) {
+      Vertex added = { NULL, cluster, 0, 0, true, NULL };
+      inner = _vertices.size();
+      _vertices.push_back(added);
+      _collapsed[cluster] = inner;
+    }
+    Collect(cluster, depth + 1, inner);
+  }
+}
+
+size_t DetailReducer::VertexOf(const Node* node) const {
+  std::unordered_map<const Graph*, size_t>::const_iterator it =
+    _firstSlot.find(node->_graph);
+  return _vertexOf[it->second + node->_slot];
+}
+
+bool DetailReducer::GetEnds(const Edge* edge, size_t* src,
+  size_t* dst) const {
+  *src = VertexOf(edge->GetSource());
+  *dst = VertexOf(edge->GetDest());
+  return *src != *dst || _vertices[*src].cluster == NULL;
+}
+
+void DetailReducer::WeighVertices() {
+  if (_options.maxNodes == 0 || _options.nodeWeight != NULL) return;
+
+  // Each edge a vertex is at weighs 1, like Node::OutDegree + InDegree, but
+  // for collapsed clusters only counting edges that leave them.
+  std::unordered_map<const Graph*, size_t>::const_iterator it;
+  for (it = _firstSlot.begin(); it != _firstSlot.end(); it++) {
+    const Graph* graph = it->first;
+    SlotList<Edge>::iterator edgeIt;
+    for (edgeIt = graph->_edges.begin(); edgeIt != graph->_edges.end();
+      edgeIt++) {
+      size_t src, dst;
+      if (!GetEnds(*edgeIt, &src, &dst)) continue;
+      _vertices[src].weight++;
+      _vertices[dst].weight++;
+    }
+  }
+}
+
+void DetailReducer::KeepHeaviest() {
+  size_t maxNodes = _options.maxNodes;
+  if (maxNodes == 0 || _vertices.size() <= maxNodes) return;
+
+  std::vector<size_t> order(_vertices.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+    _vertices[i].kept = false;
+  }
+
+  HeavierVertex heavier = { &_vertices };
+  std::nth_element(order.begin(), order.begin() + maxNodes, order.end(),
+    heavier);
+  for (size_t i = 0; i < maxNodes; i++) {
+    _vertices[order[i]].kept = true;
+  }
+}
+
+bool DetailReducer::IsEmpty(const Graph* graph) {
+  return graph->_nodes.Empty() && graph->_edges.Empty() &&
+    graph->_subgraphs.Empty() && graph->_clusters.Empty();
+}
+
+void DetailReducer::Build(const Graph* from, Graph* into, size_t collapsed) {
+  _graphPairs.push_back(std::make_pair(from, into));
+
+  if (collapsed == none) {
+    SlotList<Node>::iterator nodeIt;
+    for (nodeIt = from->_nodes.begin(); nodeIt != from->_nodes.end();
+      nodeIt++) {
+      const Node* node = *nodeIt;
+      Vertex& vertex = _vertices[VertexOf(node)];
+      if (!vertex.kept) continue;
+
+      _id.clear();
+      node->AppendId(_id);
+      const GraphView::NodeCopy* copy = _options.view != NULL ?
+        _options.view->Find(node) : NULL;
+      if (copy != NULL) {
+        vertex.reduced = into->AddNode(copy->label, _id);
+        vertex.reduced->MutableAttributes() = copy->attributes;
+      } else {
+        vertex.reduced = into->AddNode(node->GetLabel(), _id);
+        vertex.reduced->SetStyle(node->GetStyle());
+      }
+      if (from->_textProvider != NULL) {
+        CopyAttributeWriter<Node> writer(vertex.reduced,
+          AttributeTarget::NODE);
+        from->_textProvider->AddNodeText(*node, writer);
+      }
+    }
+  }
+
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = from->_subgraphs.begin(); sgIt != from->_subgraphs.end();
+    sgIt++) {
+    const Subgraph* sg = *sgIt;
+    if (collapsed != none) {
+      Build(sg, into, collapsed);
+      continue;
+    }
+
+    _id.clear();
+    sg->AppendId(_id);
+    Subgraph* added = into->AddSubgraph(sg->GetLabel(), _id);
+    added->GetAttributes() = sg->GetAttributes();
+    added->GetDefaultNodeAttributes() = sg->_defaultNodeAttributes;
+    added->GetDefaultEdgeAttributes() = sg->_defaultEdgeAttributes;
+    if (!IsEmpty(sg)) _filled.insert(added);
+    Build(sg, added, none);
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = from->_clusters.begin(); cIt != from->_clusters.end(); cIt++) {
+    const Cluster* cluster = *cIt;
+    if (collapsed != none) {
+      Build(cluster, into, collapsed);
+      continue;
+    }
+
+    _id.clear();
+    cluster->AppendId(_id);
+
+    std::unordered_map<const Graph*, size_t>::const_iterator found =
+      _collapsed.find(cluster);
+    if (found != _collapsed.end()) {
+      // The cluster's own id is free, as the cluster is not printed.
+      Vertex& vertex = _vertices[found->second];
+      if (vertex.kept) {
+        std::string label = cluster->GetLabel().empty() ? _id :
+          cluster->GetLabel();
+        label.append(" (");
+        AppendUnsigned(label, vertex.numNodes);
+        label.append(vertex.numNodes == 1 ? " node)" : " nodes)");
+        vertex.reduced = into->AddNode(label, _id);
+        vertex.reduced->MutableAttributes().SetShape(NodeShape::BOX);
+      }
+      Build(cluster, into, found->second);
+      continue;
+    }
+
+    Cluster* added = into->AddCluster(cluster->GetLabel(), _id);
+    added->GetAttributes() = cluster->GetAttributes();
+    added->GetDefaultNodeAttributes() = cluster->_defaultNodeAttributes;
+    added->GetDefaultEdgeAttributes() = cluster->_defaultEdgeAttributes;
+    if (!IsEmpty(cluster)) _filled.insert(added);
+    Build(cluster, added, none);
+  }
+}
+
+Edge* DetailReducer::CopyEdge(const Edge* edge, const Graph* from,
+  Graph* into, Node* src, Node* dst) const {
+  const GraphView::EdgeCopy* copy = _options.view != NULL ?
+    _options.view->Find(edge) : NULL;
+  Edge* added;
+  if (copy != NULL) {
+    added = into->AddEdge(src, dst, copy->label);
+    added->MutableAttributes() = copy->attributes;
+  } else {
+    added = into->AddEdge(src, dst, edge->GetLabel());
+    added->SetStyle(edge->GetStyle());
+  }
+  if (from->_textProvider != NULL) {
+    CopyAttributeWriter<Edge> writer(added, AttributeTarget::EDGE);
+    from->_textProvider->AddEdgeText(*edge, writer);
+  }
+  return added;
+}
+
+void DetailReducer::AddEdges() {
+  size_t maxParallel = _options.maxParallelEdges;
+
+  std::vector<std::pair<const Graph*, Graph*> >::const_iterator it;
+  for (it = _graphPairs.begin(); it != _graphPairs.end(); it++) {
+    const Graph* from = it->first;
+    Graph* into = it->second;
+
+    SlotList<Edge>::iterator edgeIt;
+    for (edgeIt = from->_edges.begin(); edgeIt != from->_edges.end();
+      edgeIt++) {
+      const Edge* edge = *edgeIt;
+      size_t src, dst;
+      if (!GetEnds(edge, &src, &dst)) continue;
+      const Vertex& source = _vertices[src];
+      const Vertex& dest = _vertices[dst];
+      if (!source.kept || !dest.kept) continue;
+
+      bool aggregate = source.cluster != NULL || dest.cluster != NULL;
+      if (aggregate || maxParallel != 0) {
+        uint64_t key = !_isDigraph && dst < src ?
+          (static_cast<uint64_t>(dst) << 32) | src :
+          (static_cast<uint64_t>(src) << 32) | dst;
+        Link& link = _links[key];
+        link.count++;
+        if (aggregate && link.aggregate != NULL) continue;
+        if (!aggregate && link.count > maxParallel) continue;
+
+        Edge* added = CopyEdge(edge, from, into, source.reduced,
+          dest.reduced);
+        if (aggregate) link.aggregate = added;
+        continue;
+      }
+
+      CopyEdge(edge, from, into, source.reduced, dest.reduced);
+    }
+  }
+
+  // Combined edges are labelled with how many edges they stand for.
+  std::unordered_map<uint64_t, Link>::const_iterator linkIt;
+  for (linkIt = _links.begin(); linkIt != _links.end(); linkIt++) {
+    const Link& link = linkIt->second;
+    if (link.aggregate == NULL || link.count == 1) continue;
+    std::string label;
+    AppendUnsigned(label, link.count);
+    link.aggregate->SetLabel(label);
+  }
+}
+
+void DetailReducer::Prune(Graph* graph) {
+  std::vector<Subgraph*> subgraphs;
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = graph->_subgraphs.begin(); sgIt != graph->_subgraphs.end();
+    sgIt++) {
+    Prune(*sgIt);
+    if (IsEmpty(*sgIt) && _filled.count(*sgIt) != 0) {
+      subgraphs.push_back(*sgIt);
+    }
+  }
+
+  std::vector<Cluster*> clusters;
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = graph->_clusters.begin(); cIt != graph->_clusters.end(); cIt++) {
+    Prune(*cIt);
+    if (IsEmpty(*cIt) && _filled.count(*cIt) != 0) clusters.push_back(*cIt);
+  }
+
+  for (size_t i = 0; i < subgraphs.size(); i++) {
+    graph->RemoveSubgraph(subgraphs[i]);
+  }
+  for (size_t i = 0; i < clusters.size(); i++) {
+    graph->RemoveCluster(clusters[i]);
+  }
+}
+
+RootGraph* DetailReducer::Reduce(const RootGraph& graph,
+  const PrintOptions& options) {
+  DetailReducer reducer(options, graph.IsDigraph());
+  if (options.collapseSize != 0) reducer.CountNodes(&graph);
+  reducer.Collect(&graph, 0, none);
+  reducer.WeighVertices();
+  reducer.KeepHeaviest();
+
+  graph.AppendId(reducer._id);
+  RootGraph* reduced = new RootGraph(graph.IsDigraph(), graph.GetLabel(),
+    reducer._id);
+  reduced->GetAttributes() = graph.GetAttributes();
+  reduced->GetDefaultNodeAttributes() = graph._defaultNodeAttributes;
+  reduced->GetDefaultEdgeAttributes() = graph._defaultEdgeAttributes;
+  reduced->SetStyleHoisting(graph._hoistStyles);
+
+  reducer.Build(&graph, reduced, none);
+  reducer.AddEdges();
+  reducer.Prune(reduced);
+  return reduced;
+}
+
+}  // namespace DotWriter
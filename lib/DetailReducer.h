@@ -0,0 +1,146 @@
+/**
+ * Cuts a graph down to an overview that Graphviz can lay out quickly, as set
+ * by the level of detail settings in PrintOptions: clusters collapsed into
+ * single nodes, only the heaviest nodes kept, and parallel edges capped.
+ *
+ * The original graph is left alone. Instead, the reducer builds a separate,
+ * smaller graph holding just what is to be printed, and RootGraph::Print
+ * prints that. Elements keep their ids, labels and styles (which are shared
+ * rather than copied), so the overview can be matched up with the full graph.
+ * What a TextProvider adds is stored in the copies, which have no provider of
+ * their own, as are the changes of PrintOptions::view.
+ * Building it takes time linear in the size of the original graph, which is
+ * small next to what laying out the full graph takes.
+ */
+
+#ifndef DOTWRITER_DETAILREDUCER_H_
+#define DOTWRITER_DETAILREDUCER_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "PrintOptions.h"
+
+namespace DotWriter {
+
+class Cluster;
+class Edge;
+class Graph;
+class Node;
+class RootGraph;
+
+class DetailReducer {
+private:
+  /**
+   * A node of the reduced graph: either a node of the original's, or a
+   * cluster collapsed into a single node.
+   */
+  struct Vertex {
+    const Node* node;
+    const Cluster* cluster;
+    // Number of nodes a collapsed cluster stands for.
+    size_t numNodes;
+    double weight;
+    bool kept;
+    Node* reduced;
+  };
+
+  /**
+   * Edges between one pair of vertices so far. Edges to and from collapsed
+   * clusters are all combined into aggregate.
+   */
+  struct Link {
+    size_t count;
+    Edge* aggregate;
+  };
+
+  /**
+   * Orders vertices by weight, heaviest first, and by position for equal
+   * weights.
+   */
+  struct HeavierVertex {
+    const std::vector<Vertex>* vertices;
+    bool operator()(size_t a, size_t b) const;
+  };
+
+  const PrintOptions& _options;
+  bool _isDigraph;
+  std::vector<Vertex> _vertices;
+  // The vertex of each node is at _vertexOf[_firstSlot[graph] + slot].
+  std::unordered_map<const Graph*, size_t> _firstSlot;
+  std::vector<size_t> _vertexOf;
+  // Nodes in each graph, counting its subgraphs and clusters. Only kept for
+  // collapseSize.
+  std::unordered_map<const Graph*, size_t> _sizes;
+  // The vertex of each collapsed cluster.
+  std::unordered_map<const Graph*, size_t> _collapsed;
+  // Every graph of the original, and the graph of the reduced graph that its
+  // elements go into, in print order.
+  std::vector<std::pair<const Graph*, Graph*> > _graphPairs;
+  // Subgraphs and clusters of the reduced graph whose originals were not
+  // empty, and so should go if they end up empty.
+  std::unordered_set<const Graph*> _filled;
+  std::unordered_map<uint64_t, Link> _links;
+  std::string _id;
+
+  DetailReducer(const PrintOptions& options, bool isDigraph);
+
+  size_t CountNodes(const Graph* graph);
+
+  /**
+   * Makes a vertex for each node of graph and of everything inside of it,
+   * collapsing clusters as needed. depth is the number of clusters that
+   * graph is inside of (counting itself); collapsed is the vertex of the
+   * cluster that graph is collapsed into, if any.
+   */
+  void Collect(const Graph* graph, unsigned depth, size_t collapsed);
+  size_t VertexOf(const Node* node) const;
+
+  /**
+   * Returns true if edge joins two vertices (rather than being inside of a
+   * collapsed cluster), and sets src and dst to them.
+   */
+  bool GetEnds(const Edge* edge, size_t* src, size_t* dst) const;
+
+  void WeighVertices();
+  void KeepHeaviest();
+
+  /**
+   * Copies what is kept of from's nodes, subgraphs and clusters into into,
+   * recursively. Edges come afterwards (see AddEdges), once every node
+   * exists.
+   */
+  void Build(const Graph* from, Graph* into, size_t collapsed);
+  void AddEdges();
+
+  /**
+   * Adds a copy of edge, which is in from, to into, from src to dst.
+   */
+  Edge* CopyEdge(const Edge* edge, const Graph* from, Graph* into,
+    Node* src, Node* dst) const;
+
+  /**
+   * Removes the subgraphs and clusters of graph that nothing was kept of.
+   */
+  void Prune(Graph* graph);
+
+  static bool IsEmpty(const Graph* graph);
+
+public:
+  /**
+   * Returns the reduced copy of graph, which the caller owns. It hoists
+   * styles if graph does (see Graph::SetStyleHoisting), but never caches
+   * its output.
+   */
+  static RootGraph* Reduce(const RootGraph& graph,
+    const PrintOptions& options);
+};
+
+}  // namespace DotWriter
+
+#endif
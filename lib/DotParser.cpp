@@ -0,0 +1,818 @@
+#include "DotParser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+#include <strings.h>
+
+#include "Cluster.h"
+#include "Edge.h"
+#include "Node.h"
+#include "RootGraph.h"
+#include "Subgraph.h"
+#include "Util.h"
+
+namespace DotWriter {
+
+static inline bool IsSpace(char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' ||
+    c == '\v';
+}
+
+/**
+ * Characters of identifiers and numerals. Being lenient here costs nothing:
+ * anything this accepts that DOT does not, DOT would have rejected anyway.
+ */
+static inline bool IsIdChar(char c) {
+  unsigned char u = static_cast<unsigned char>(c);
+  return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') ||
+    (u >= '0' && u <= '9') || u == '_' || u == '.' || u >= 0x80;
+}
+
+DotParser::DotParser(std::string_view text) : _text(text), _pos(0),
+  _peekedFrom(std::string_view::npos), _peekedEnd(0), _root(NULL),
+  _collecting(0) {
+  GrowNodeIndex();
+}
+
+bool DotParser::Fail(size_t offset, const std::string& what) {
+  if (_error.empty()) {
+    offset = std::min(offset, _text.size());
+    _error = "line ";
+    AppendUnsigned(_error, 1 + std::count(_text.begin(),
+      _text.begin() + offset, '\n'));
+    _error += ": ";
+    _error += what;
+  }
+  return false;
+}
+
+bool DotParser::Expected(const Token& token, const char* what) {
+  std::string message = "expected ";
+  message += what;
+  if (token.type == TokenType::END) {
+    message += " at the end of the file";
+  } else {
+    std::string_view text =
+      _text.substr(token.offset, std::max<size_t>(token.text.size(), 1));
+    message += ", found '";
+    message.append(text.substr(0, 32));
+    message += "'";
+  }
+  return Fail(token.offset, message);
+}
+
+size_t DotParser::SkipSpace(size_t pos) const {
+  const char* data = _text.data();
+  size_t size = _text.size();
+
+  while (pos < size) {
+    char c = data[pos];
+    if (IsSpace(c)) {
+      pos++;
+    } else if ((c == '#' && (pos == 0 || data[pos - 1] == '\n')) ||
+        (c == '/' && pos + 1 < size && data[pos + 1] == '/')) {
+      // Preprocessor output lines and line comments.
+      size_t end = _text.find('\n', pos);
+      pos = end == std::string_view::npos ? size : end + 1;
+    } else if (c == '/' && pos + 1 < size && data[pos + 1] == '*') {
+      size_t end = _text.find("*/", pos + 2);
+      pos = end == std::string_view::npos ? size : end + 2;
+    } else {
+      break;
+    }
+  }
+
+  return pos;
+}
+
+bool DotParser::ScanQuoted(Token* token) {
+  const char* data = _text.data();
+  size_t size = _text.size();
+  size_t begin = _pos;
+  bool decode = false;
+
+  // _pos is at an opening quote.
+  for (;;) {
+    size_t pos = _pos + 1;
+    const void* quote = memchr(data + pos, '"', size - pos);
+    size_t end = quote == NULL ? size :
+      static_cast<const char*>(quote) - data;
+
+    if (memchr(data + pos, '\\', end - pos) != NULL) {
+      // The first quote found may be escaped; go through it properly.
+      decode = true;
+      while (pos < size && data[pos] != '"') {
+        if (data[pos] == '\\') pos++;
+        pos++;
+      }
+      end = pos;
+    }
+    if (end >= size) return Fail(begin, "unterminated string");
+    _pos = end + 1;
+
+    // "a" + "b" is one string.
+    size_t next = SkipSpace(_pos);
+    if (next < size && data[next] == '+') {
+      next = SkipSpace(next + 1);
+      if (next < size && data[next] == '"') {
+        decode = true;
+        _pos = next;
+        continue;
+      }
+    }
+    break;
+  }
+
+  token->type = TokenType::QUOTED;
+  token->decode = decode;
+  token->text = decode ? _text.substr(begin, _pos - begin) :
+    _text.substr(begin + 1, _pos - begin - 2);
+  return true;
+}
+
+bool DotParser::ScanHtml(Token* token) {
+  const char* data = _text.data();
+  size_t size = _text.size();
+  size_t begin = _pos;
+  unsigned depth = 0;
+
+  for (size_t pos = begin; pos < size; pos++) {
+    if (data[pos] == '<') {
+      depth++;
+    } else if (data[pos] == '>' && --depth == 0) {
+      _pos = pos + 1;
+      token->type = TokenType::HTML;
+      token->text = _text.substr(begin + 1, pos - begin - 1);
+      return true;
+    }
+  }
+
+  return Fail(begin, "unterminated HTML string");
+}
+
+bool DotParser::Scan(Token* token) {
+  const char* data = _text.data();
+  size_t size = _text.size();
+
+  _pos = SkipSpace(_pos);
+  token->offset = _pos;
+  token->decode = false;
+  if (_pos >= size) {
+    token->type = TokenType::END;
+    token->text = std::string_view();
+    return true;
+  }
+
+  TokenType::e type;
+  switch (data[_pos]) {
+    case '{': type = TokenType::LBRACE; break;
+    case '}': type = TokenType::RBRACE; break;
+    case '[': type = TokenType::LBRACKET; break;
+    case ']': type = TokenType::RBRACKET; break;
+    case '=': type = TokenType::EQUALS; break;
+    case ':': type = TokenType::COLON; break;
+    case ';': type = TokenType::SEMICOLON; break;
+    case ',': type = TokenType::COMMA; break;
+    case '"':
+      return ScanQuoted(token);
+    case '<':
+      return ScanHtml(token);
+    case '-':
+      if (_pos + 1 < size &&
+          (data[_pos + 1] == '>' || data[_pos + 1] == '-')) {
+        token->type = TokenType::EDGEOP;
+        token->text = _text.substr(_pos, 2);
+        _pos += 2;
+        return true;
+      }
+      // A negative number.
+      type = TokenType::ID;
+      break;
+    default:
+      if (!IsIdChar(data[_pos])) {
+        return Fail(_pos, std::string("unexpected character '") +
+          data[_pos] + "'");
+      }
+      type = TokenType::ID;
+      break;
+  }
+
+  size_t begin = _pos++;
+  if (type == TokenType::ID) {
+    while (_pos < size && IsIdChar(data[_pos])) _pos++;
+  }
+  token->type = type;
+  token->text = _text.substr(begin, _pos - begin);
+  return true;
+}
+
+bool DotParser::Next(Token* token) {
+  if (_pos == _peekedFrom) {
+    *token = _peeked;
+    _pos = _peekedEnd;
+    return true;
+  }
+  return Scan(token);
+}
+
+bool DotParser::Peek(Token* token) {
+  if (_pos != _peekedFrom) {
+    size_t pos = _pos;
+    if (!Scan(&_peeked)) return false;
+    _peekedFrom = pos;
+    _peekedEnd = _pos;
+    _pos = pos;
+  }
+  *token = _peeked;
+  return true;
+}
+
+std::string_view DotParser::Decode(const Token& token) {
+  if (!token.decode) return token.text;
+
+  const char* data = _text.data();
+  size_t pos = token.offset;
+  size_t end = token.offset + token.text.size();
+  _scratch.clear();
+
+  while (pos < end) {
+    // At an opening quote.
+    pos++;
+    size_t run = pos;
+    while (data[pos] != '"') {
+      if (data[pos] != '\\') {
+        pos++;
+        continue;
+      }
+
+      // Only \" and line continuations are undone. Every other escape is
+      // kept as written, as Graphviz gives it meaning (\n, \l, \N, ...) only
+      // when it uses the string.
+      char next = data[pos + 1];
+      if (next == '"') {
+        _scratch.append(data + run, pos - run);
+        _scratch += '"';
+        pos += 2;
+        run = pos;
+      } else if (next == '\n') {
+        _scratch.append(data + run, pos - run);
+        pos += 2;
+        run = pos;
+      } else if (next == '\r' && data[pos + 2] == '\n') {
+        _scratch.append(data + run, pos - run);
+        pos += 3;
+        run = pos;
+      } else {
+        pos += 2;
+      }
+    }
+    _scratch.append(data + run, pos - run);
+
+    // Past the closing quote, and the '+' to the next string, if any.
+    pos = SkipSpace(pos + 1);
+    if (pos < end) pos = SkipSpace(pos + 1);
+  }
+
+  return _scratch;
+}
+
+std::string_view DotParser::DecodeStable(const Token& token) {
+  if (!token.decode) return token.text;
+  _decodedIds.push_back(std::string(Decode(token)));
+  return _decodedIds.back();
+}
+
+bool DotParser::IsKeyword(const Token& token, const char* keyword) {
+  size_t length = strlen(keyword);
+  return token.type == TokenType::ID && token.text.size() == length &&
+    strncasecmp(token.text.data(), keyword, length) == 0;
+}
+
+bool DotParser::IsAnyKeyword(const Token& token) {
+  return IsKeyword(token, "node") || IsKeyword(token, "edge") ||
+    IsKeyword(token, "graph") || IsKeyword(token, "digraph") ||
+    IsKeyword(token, "subgraph") || IsKeyword(token, "strict");
+}
+
+bool DotParser::ParseAttributes(AttributeSet& set, AttributeTarget::e target,
+  std::string* label, bool* hasLabel, std::string_view* text) {
+  Token token;
+  size_t begin = 0;
+  size_t end = 0;
+  std::string name;
+  if (hasLabel != NULL) *hasLabel = false;
+
+  for (;;) {
+    if (!Peek(&token)) return false;
+    if (token.type != TokenType::LBRACKET) break;
+    Next(&token);
+    if (end == 0) begin = token.offset;
+
+    for (;;) {
+      if (!Next(&token)) return false;
+      if (token.type == TokenType::RBRACKET) break;
+      if (token.type == TokenType::COMMA ||
+          token.type == TokenType::SEMICOLON) {
+        continue;
+      }
+      if (!IsId(token)) return Expected(token, "an attribute name or ']'");
+      name.assign(Decode(token));
+
+      // [a] is short for [a=true].
+      std::string_view value = "true";
+      if (!Peek(&token)) return false;
+      if (token.type == TokenType::EQUALS) {
+        Next(&token);
+        if (!Next(&token)) return false;
+        if (!IsId(token)) return Expected(token, "an attribute value");
+        value = Decode(token);
+      }
+
+      if (label != NULL && name == "label") {
+        label->assign(value);
+        *hasLabel = true;
+      } else {
+        set.SetFromText(target, name, value);
+      }
+    }
+    end = _pos;
+  }
+
+  if (text != NULL) *text = _text.substr(begin, end - begin);
+  return true;
+}
+
+bool DotParser::ParseGraphAttribute(Scope& scope, const Token& name) {
+  Token token;
+  Next(&token);  // The '='.
+  if (!Next(&token)) return false;
+  if (!IsId(token)) return Expected(token, "an attribute value");
+
+  std::string nameText(Decode(name));
+  std::string_view value = Decode(token);
+  if (nameText == "label") {
+    scope.graph->SetLabel(std::string(value));
+  } else {
+    scope.attributes->SetFromText(scope.target, nameText, value);
+  }
+  return true;
+}
+
+bool DotParser::ParseStatements(Scope& scope) {
+  Token token;
+  Token next;
+
+  for (;;) {
+    if (!Next(&token)) return false;
+
+    switch (token.type) {
+      case TokenType::RBRACE:
+        return true;
+      case TokenType::SEMICOLON:
+        continue;
+      case TokenType::LBRACE:
+        if (!ParseNodeOrEdge(scope, token)) return false;
+        continue;
+      default:
+        break;
+    }
+
+    if (IsKeyword(token, "subgraph")) {
+      if (!ParseNodeOrEdge(scope, token)) return false;
+      continue;
+    }
+
+    if (IsKeyword(token, "graph")) {
+      std::string label;
+      bool hasLabel;
+      if (!ParseAttributes(*scope.attributes, scope.target, &label, &hasLabel,
+          NULL)) {
+        return false;
+      }
+      if (hasLabel) scope.graph->SetLabel(std::move(label));
+      continue;
+    }
+
+    if (IsKeyword(token, "node")) {
+      if (!ParseAttributes(scope.graph->GetDefaultNodeAttributes(),
+          AttributeTarget::NODE, NULL, NULL, NULL)) {
+        return false;
+      }
+      continue;
+    }
+
+    if (IsKeyword(token, "edge")) {
+      if (!ParseAttributes(scope.graph->GetDefaultEdgeAttributes(),
+          AttributeTarget::EDGE, NULL, NULL, NULL)) {
+        return false;
+      }
+      continue;
+    }
+
+    if (!IsNodeId(token)) {
+      return Expected(token, token.type == TokenType::END ? "'}'" :
+        "a statement");
+    }
+
+    if (!Peek(&next)) return false;
+    if (next.type == TokenType::EQUALS) {
+      if (!ParseGraphAttribute(scope, token)) return false;
+    } else if (!ParseNodeOrEdge(scope, token)) {
+      return false;
+    }
+  }
+}
+
+bool DotParser::ParseSubgraph(Scope& scope, const Token& first) {
+  Token token = first;
+  std::string_view id;
+  bool hasId = false;
+
+  if (first.type != TokenType::LBRACE) {
+    // first is the 'subgraph' keyword.
+    if (!Next(&token)) return false;
+    if (IsNodeId(token)) {
+      id = DecodeStable(token);
+      hasId = true;
+      if (!Next(&token)) return false;
+    }
+  }
+  if (token.type != TokenType::LBRACE) return Expected(token, "'{'");
+
+  if (hasId) {
+    std::unordered_map<std::string_view, Scope>::iterator it =
+      _graphsById.find(id);
+    if (it != _graphsById.end()) return ParseStatements(it->second);
+  }
+
+  Scope inner;
+  if (hasId && id.compare(0, 7, "cluster") == 0) {
+    Cluster* cluster = scope.graph->AddCluster("", id);
+    inner.graph = cluster;
+    inner.attributes = &cluster->GetAttributes();
+    inner.target = AttributeTarget::CLUSTER;
+  } else {
+    Subgraph* subgraph = hasId ? scope.graph->AddSubgraph("", id) :
+      scope.graph->AddSubgraph();
+    inner.graph = subgraph;
+    inner.attributes = &subgraph->GetAttributes();
+    inner.target = AttributeTarget::SUBGRAPH;
+  }
+  inner.index = _graphs.size();
+  _graphs.push_back(inner.graph);
+  if (hasId) _graphsById.emplace(id, inner);
+
+  return ParseStatements(inner);
+}
+
+bool DotParser::ParseNodeGroup(Scope& scope, bool isEdgeEnd, bool* isGroup) {
+  size_t start = _pos;
+  Token token;
+  *isGroup = false;
+
+  // Is it just ids?
+  for (;;) {
+    if (!Next(&token)) return false;
+    if (token.type == TokenType::RBRACE) break;
+    if (token.type == TokenType::COMMA ||
+        token.type == TokenType::SEMICOLON || IsNodeId(token)) {
+      continue;
+    }
+    _pos = start;
+    return true;
+  }
+
+  // Is it an endpoint?
+  if (!isEdgeEnd) {
+    if (!Peek(&token)) return false;
+    if (token.type != TokenType::EDGEOP) {
+      _pos = start;
+      return true;
+    }
+  }
+
+  *isGroup = true;
+  _pos = start;
+  for (;;) {
+    Next(&token);
+    if (token.type == TokenType::RBRACE) return true;
+    if (IsId(token)) {
+      Endpoint endpoint = { FindNode(token, scope.index), 0 };
+      _members.push_back(endpoint);
+    }
+  }
+}
+
+bool DotParser::ParseOperand(Scope& scope, const Token& first,
+  bool isEdgeEnd, bool* isNode) {
+  *isNode = false;
+
+  if (first.type == TokenType::LBRACE || IsKeyword(first, "subgraph")) {
+    if (first.type == TokenType::LBRACE) {
+      bool isGroup;
+      if (!ParseNodeGroup(scope, isEdgeEnd, &isGroup)) return false;
+      if (isGroup) return true;
+    }
+
+    // Remember which nodes the subgraph mentions, in case it is an endpoint.
+    size_t mentionStart = _mentioned.size();
+    _collecting++;
+    bool ok = ParseSubgraph(scope, first);
+    _collecting--;
+    if (!ok) return false;
+
+    Token token;
+    if (!isEdgeEnd && !Peek(&token)) return false;
+    if (isEdgeEnd || token.type == TokenType::EDGEOP) {
+      std::unordered_set<unsigned> seen;
+      for (size_t i = mentionStart; i < _mentioned.size(); i++) {
+        if (seen.insert(_mentioned[i]).second) {
+          Endpoint endpoint = { _mentioned[i], 0 };
+          _members.push_back(endpoint);
+        }
+      }
+    }
+    // Enclosing subgraphs that are endpoints still need them.
+    if (_collecting == 0) _mentioned.resize(mentionStart);
+    return true;
+  }
+
+  if (!IsNodeId(first)) return Expected(first, "a node id");
+
+  Endpoint endpoint = { FindNode(first, scope.index), 0 };
+  Token token;
+  if (!Peek(&token)) return false;
+  if (token.type == TokenType::COLON) {
+    // node:port, node:port:compass or node:compass, kept as one string.
+    std::string port;
+    for (unsigned parts = 0; parts < 2 && token.type == TokenType::COLON;
+      parts++) {
+      Next(&token);
+      if (!Next(&token)) return false;
+      if (!IsId(token)) return Expected(token, "a port");
+      if (parts > 0) port += ':';
+      port.append(Decode(token));
+      if (!Peek(&token)) return false;
+    }
+    _ports.push_back(std::move(port));
+    endpoint.port = _ports.size();
+  }
+
+  _members.push_back(endpoint);
+  *isNode = true;
+  return true;
+}
+
+bool DotParser::ParseNodeOrEdge(Scope& scope, const Token& first) {
+  size_t statementStart = _members.size();
+  bool isNode;
+  if (!ParseOperand(scope, first, false, &isNode)) return false;
+
+  Token token;
+  if (!Peek(&token)) return false;
+
+  if (token.type != TokenType::EDGEOP) {
+    if (isNode) {
+      Node* node = DeclareNode(_members[statementStart].node, scope.graph);
+      if (token.type == TokenType::LBRACKET) {
+        // Nodes that already have attributes get the new ones added; the
+        // rest share a style with every node with the same attribute text.
+        bool fresh = node->GetStyle().Empty();
+        NodeAttributeSet attributes;
+        std::string label;
+        bool hasLabel;
+        std::string_view text;
+        if (!ParseAttributes(fresh ? attributes : node->MutableAttributes(),
+            AttributeTarget::NODE, &label, &hasLabel, &text)) {
+          return false;
+        }
+
+        if (hasLabel) node->SetLabel(std::move(label));
+        if (fresh && !hasLabel) {
+          std::unordered_map<std::string_view, SharedNodeStyle>::iterator it =
+            _nodeStyles.find(text);
+          if (it == _nodeStyles.end()) {
+            it = _nodeStyles.emplace(text, SharedNodeStyle(attributes)).first;
+          }
+          if (!it->second.Empty()) node->SetStyle(it->second);
+        } else if (fresh && !attributes.Empty()) {
+          node->SetStyle(SharedNodeStyle(attributes));
+        }
+      }
+    }
+    _members.resize(statementStart);
+    return true;
+  }
+
+  // Every node on the left gets an edge to every node on the right.
+  unsigned statement = _statements.size();
+  _statements.push_back(EdgeStatement());
+  unsigned numEdges = 0;
+  size_t leftBegin = statementStart;
+  size_t leftEnd = _members.size();
+
+  while (token.type == TokenType::EDGEOP) {
+    Next(&token);
+    if (!Next(&token)) return false;
+    size_t rightBegin = _members.size();
+    if (!ParseOperand(scope, token, true, &isNode)) return false;
+    size_t rightEnd = _members.size();
+
+    for (size_t i = leftBegin; i < leftEnd; i++) {
+      for (size_t j = rightBegin; j < rightEnd; j++) {
+        PendingEdge edge = { scope.index, statement, _members[i],
+          _members[j] };
+        _edges.push_back(edge);
+        numEdges++;
+      }
+    }
+
+    leftBegin = rightBegin;
+    leftEnd = rightEnd;
+    if (!Peek(&token)) return false;
+  }
+
+  EdgeAttributeSet attributes;
+  std::string label;
+  bool hasLabel;
+  std::string_view text;
+  if (!ParseAttributes(attributes, AttributeTarget::EDGE, &label, &hasLabel,
+      &text)) {
+    return false;
+  }
+
+  // Subgraphs in the statement may have added statements of their own.
+  EdgeStatement& edges = _statements[statement];
+  edges.numEdges = numEdges;
+  if (!hasLabel && !text.empty()) {
+    std::unordered_map<std::string_view, SharedEdgeStyle>::iterator it =
+      _edgeStyles.find(text);
+    if (it == _edgeStyles.end()) {
+      it = _edgeStyles.emplace(text, SharedEdgeStyle(attributes)).first;
+    }
+    edges.style = it->second;
+  } else if (!attributes.Empty()) {
+    edges.style = SharedEdgeStyle(attributes);
+  }
+  edges.label = std::move(label);
+
+  _members.resize(statementStart);
+  return true;
+}
+
+/**
+ * 32-bit FNV-1a, with a final avalanche: ids in big files tend to differ only
+ * in their last few digits, which plain FNV-1a leaves in the high bits, and the
+ * table is indexed by the low ones.
+ */
+static uint32_t HashId(std::string_view id) {
+  uint32_t hash = 2166136261U;
+  for (size_t i = 0; i < id.size(); i++) {
+    hash ^= static_cast<unsigned char>(id[i]);
+    hash *= 16777619U;
+  }
+  hash ^= hash >> 16;
+  hash *= 0x85EBCA6BU;
+  hash ^= hash >> 13;
+  return hash;
+}
+
+void DotParser::GrowNodeIndex() {
+  std::vector<IdSlot> slots(std::max<size_t>(_nodeSlots.size() * 2, 1024));
+  size_t mask = slots.size() - 1;
+  std::vector<IdSlot>::iterator it;
+  for (it = _nodeSlots.begin(); it != _nodeSlots.end(); it++) {
+    if (it->node == 0) continue;
+    size_t pos = it->hash & mask;
+    while (slots[pos].node != 0) pos = (pos + 1) & mask;
+    slots[pos] = *it;
+  }
+  _nodeSlots.swap(slots);
+}
+
+unsigned DotParser::FindNode(const Token& id, unsigned graph) {
+  std::string_view text = Decode(id);
+  uint32_t hash = HashId(text);
+  size_t mask = _nodeSlots.size() - 1;
+  size_t pos = hash & mask;
+
+  // Linear probing.
+  unsigned index;
+  for (;;) {
+    const IdSlot& slot = _nodeSlots[pos];
+    if (slot.node == 0) {
+      if (id.decode) text = DecodeStable(id);
+      index = _nodes.size();
+      NodeRecord record = { text, NULL, graph };
+      _nodes.push_back(record);
+      _nodeSlots[pos].hash = hash;
+      _nodeSlots[pos].node = index + 1;
+      _nodeSlots[pos].id = text;
+      if (_nodes.size() * 2 > _nodeSlots.size()) GrowNodeIndex();
+      break;
+    }
+    if (slot.hash == hash && slot.id == text) {
+      index = slot.node - 1;
+      break;
+    }
+    pos = (pos + 1) & mask;
+  }
+
+  if (_collecting > 0) _mentioned.push_back(index);
+  return index;
+}
+
+Node* DotParser::DeclareNode(unsigned index, Graph* graph) {
+  NodeRecord& record = _nodes[index];
+  if (record.node == NULL) record.node = graph->AddNode("", record.id);
+  return record.node;
+}
+
+void DotParser::CreateEdges() {
+  // Nodes that only ever appeared in edges go where they first appeared.
+  for (size_t i = 0; i < _nodes.size(); i++) {
+    DeclareNode(i, _graphs[_nodes[i].graph]);
+  }
+
+  std::vector<size_t> counts(_graphs.size(), 0);
+  std::vector<PendingEdge>::iterator it;
+  for (it = _edges.begin(); it != _edges.end(); it++) {
+    counts[it->graph]++;
+  }
+  for (size_t i = 0; i < _graphs.size(); i++) {
+    if (counts[i] > 0) _graphs[i]->Reserve(0, counts[i]);
+  }
+
+  for (it = _edges.begin(); it != _edges.end(); it++) {
+    EdgeStatement& statement = _statements[it->statement];
+    Graph* graph = _graphs[it->graph];
+    Node* src = _nodes[it->src.node].node;
+    Node* dst = _nodes[it->dst.node].node;
+
+    Edge* edge;
+    if (statement.label.empty()) {
+      edge = graph->AddEdge(src, dst);
+    } else if (statement.numEdges == 1) {
+      edge = graph->AddEdge(src, dst, std::move(statement.label));
+    } else {
+      edge = graph->AddEdge(src, dst, statement.label);
+    }
+
+    if (!statement.style.Empty()) edge->SetStyle(statement.style);
+    if (it->src.port != 0) {
+      edge->MutableAttributes().SetFromText(AttributeTarget::EDGE, "tailport",
+        _ports[it->src.port - 1]);
+    }
+    if (it->dst.port != 0) {
+      edge->MutableAttributes().SetFromText(AttributeTarget::EDGE, "headport",
+        _ports[it->dst.port - 1]);
+    }
+  }
+}
+
+RootGraph* DotParser::Parse() {
+  Token token;
+  if (!Next(&token)) return NULL;
+  if (IsKeyword(token, "strict") && !Next(&token)) return NULL;
+
+  bool isDigraph = IsKeyword(token, "digraph");
+  if (!isDigraph && !IsKeyword(token, "graph")) {
+    Expected(token, "'graph' or 'digraph'");
+    return NULL;
+  }
+
+  if (!Next(&token)) return NULL;
+  std::string_view id;
+  bool hasId = false;
+  if (IsNodeId(token)) {
+    id = DecodeStable(token);
+    hasId = true;
+    if (!Next(&token)) return NULL;
+  }
+  if (token.type != TokenType::LBRACE) {
+    Expected(token, "'{'");
+    return NULL;
+  }
+
+  _root = hasId ? new RootGraph(isDigraph, "", id) : new RootGraph(isDigraph);
+  _graphs.push_back(_root);
+  Scope scope = { _root, &_root->GetAttributes(), AttributeTarget::GRAPH, 0 };
+
+  bool ok = ParseStatements(scope) && Next(&token);
+  if (ok && token.type != TokenType::END) {
+    ok = Expected(token, "the end of the file (only one graph is read)");
+  }
+  if (!ok) {
+    delete _root;
+    _root = NULL;
+    return NULL;
+  }
+
+  CreateEdges();
+  RootGraph* root = _root;
+  _root = NULL;
+  return root;
+}
+
+}  // namespace DotWriter
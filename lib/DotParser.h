@@ -0,0 +1,256 @@
+/**
+ * Reads a DOT file back into a RootGraph (see RootGraph::Parse).
+ *
+ * The text is tokenized in place: tokens are views of the input, and only
+ * ids and values that contain escapes are ever copied before being stored.
+ * Attributes go through AttributeSet::SetFromText, so standard attributes
+ * end up with the same typed values their setters would store, and the
+ * rest become custom attributes.
+ *
+ * DotWriter has no notion of a node that belongs to several graphs, so each
+ * node belongs to the first graph with a statement that declares it, or
+ * failing that, the first graph with an edge that mentions it. Edges are
+ * therefore only created once the whole file has been read. Subgraphs and
+ * clusters with the same id are the same graph. An anonymous '{ ... }' that
+ * only lists nodes and is used as an edge endpoint (as compact output
+ * writes a->{b c}) just stands for those nodes; anywhere else it is an
+ * anonymous subgraph.
+ *
+ * Not everything in DOT has a DotWriter equivalent: 'strict' is ignored,
+ * HTML-like labels are kept as plain text, and node / edge / graph defaults
+ * apply to the whole graph, wherever they appear in it. Ports on edge
+ * endpoints become the edge's tailport / headport. Quoted strings lose their
+ * \" escapes and line continuations (DotWriter puts the \" back when
+ * printing); any other escape, such as \\, \n or \l, is kept as written, so
+ * printing what was parsed gives back the same strings.
+ */
+
+#ifndef DOTWRITER_DOTPARSER_H_
+#define DOTWRITER_DOTPARSER_H_
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+#include "AttributeSet.h"
+#include "Style.h"
+
+namespace DotWriter {
+
+class Graph;
+class Node;
+class RootGraph;
+
+class DotParser {
+private:
+  struct TokenType {
+    enum e {
+      END,
+      ID,        // Identifier or numeral.
+      QUOTED,    // Double-quoted string.
+      HTML,      // <...>
+      LBRACE,
+      RBRACE,
+      LBRACKET,
+      RBRACKET,
+      EQUALS,
+      COLON,
+      SEMICOLON,
+      COMMA,
+      EDGEOP     // -> or --
+    };
+  };
+
+  struct Token {
+    TokenType::e type;
+    // The text of the id, without quotes. If decode is set, the raw text
+    // instead, quotes and all, which Decode turns into the id.
+    std::string_view text;
+    bool decode;
+    size_t offset;
+  };
+
+  /**
+   * A graph being parsed, and the attribute set its 'graph [...]' statements
+   * go into.
+   */
+  struct Scope {
+    Graph* graph;
+    AttributeSet* attributes;
+    AttributeTarget::e target;
+    unsigned index;  // In _graphs.
+  };
+
+  struct NodeRecord {
+    std::string_view id;
+    Node* node;  // NULL until declared, or until edges are created.
+    unsigned graph;  // First graph to mention the node, in _graphs.
+  };
+
+  /**
+   * A slot of the node index. node is one past the node's index in _nodes;
+   * zero means the slot is empty. The id is repeated here so that a lookup
+   * does not have to go through _nodes.
+   */
+  struct IdSlot {
+    uint32_t hash;
+    uint32_t node;
+    std::string_view id;
+  };
+
+  /**
+   * One end of an edge: a node, and its port (in _ports, plus one), if any.
+   */
+  struct Endpoint {
+    unsigned node;
+    unsigned port;
+  };
+
+  /**
+   * What every edge of an edge statement is given.
+   */
+  struct EdgeStatement {
+    SharedEdgeStyle style;
+    std::string label;
+    unsigned numEdges;
+  };
+
+  struct PendingEdge {
+    unsigned graph;
+    unsigned statement;
+    Endpoint src;
+    Endpoint dst;
+  };
+
+  std::string_view _text;
+  size_t _pos;
+  // The token last returned by Peek, which was at _peekedFrom, and ends at
+  // _peekedEnd. Saves scanning it twice.
+  Token _peeked;
+  size_t _peekedFrom;
+  size_t _peekedEnd;
+  std::string _error;
+  std::string _scratch;
+
+  RootGraph* _root;
+  std::vector<Graph*> _graphs;
+  std::unordered_map<std::string_view, Scope> _graphsById;
+  std::vector<NodeRecord> _nodes;
+  // Open-addressing index of _nodes by id, like IdManager's. Size is always
+  // a power of two, and at most half full.
+  std::vector<IdSlot> _nodeSlots;
+  // Backing text for ids that had to be decoded.
+  std::deque<std::string> _decodedIds;
+  std::vector<std::string> _ports;
+  // Node ids, as ranges of an edge statement's endpoints, and the nodes
+  // mentioned inside subgraphs used as endpoints (see ParseOperand).
+  std::vector<Endpoint> _members;
+  std::vector<unsigned> _mentioned;
+  unsigned _collecting;
+  std::vector<EdgeStatement> _statements;
+  std::vector<PendingEdge> _edges;
+  // Styles of attribute lists without labels, by their text.
+  std::unordered_map<std::string_view, SharedNodeStyle> _nodeStyles;
+  std::unordered_map<std::string_view, SharedEdgeStyle> _edgeStyles;
+
+  bool Fail(size_t offset, const std::string& what);
+  bool Expected(const Token& token, const char* what);
+
+  /**
+   * Returns the position of the first thing after pos that is not white
+   * space or a comment.
+   */
+  size_t SkipSpace(size_t pos) const;
+  bool Scan(Token* token);
+  bool Next(Token* token);
+  bool Peek(Token* token);
+  bool ScanQuoted(Token* token);
+  bool ScanHtml(Token* token);
+
+  /**
+   * The text of an ID, QUOTED or HTML token. May point into _scratch, so
+   * only valid until the next call.
+   */
+  std::string_view Decode(const Token& token);
+
+  /**
+   * Same as Decode, but valid for as long as the parser.
+   */
+  std::string_view DecodeStable(const Token& token);
+
+  static bool IsId(const Token& token) {
+    return token.type == TokenType::ID || token.type == TokenType::QUOTED ||
+      token.type == TokenType::HTML;
+  }
+
+  static bool IsKeyword(const Token& token, const char* keyword);
+  static bool IsAnyKeyword(const Token& token);
+
+  /**
+   * True for a token that can be used as an id: not a keyword.
+   */
+  static bool IsNodeId(const Token& token) {
+    return IsId(token) && !IsAnyKeyword(token);
+  }
+
+  /**
+   * Parses any number of [...] lists into set. If label is given, label
+   * attributes go there instead. Returns the raw text of the lists in text.
+   */
+  bool ParseAttributes(AttributeSet& set, AttributeTarget::e target,
+    std::string* label, bool* hasLabel, std::string_view* text);
+
+  bool ParseGraphAttribute(Scope& scope, const Token& name);
+  bool ParseStatements(Scope& scope);
+  bool ParseSubgraph(Scope& scope, const Token& first);
+
+  /**
+   * If the '{' just read starts a list of plain node ids that is an edge
+   * endpoint, adds the nodes to _members and skips past the '}'. Otherwise
+   * leaves the position alone, and sets isGroup to false.
+   */
+  bool ParseNodeGroup(Scope& scope, bool isEdgeEnd, bool* isGroup);
+
+  /**
+   * Parses a node id, with its port if it has one, or a subgraph, and adds
+   * the nodes it stands for to _members. isNode tells which one it was.
+   */
+  bool ParseOperand(Scope& scope, const Token& first, bool isEdgeEnd,
+    bool* isNode);
+  bool ParseNodeOrEdge(Scope& scope, const Token& first);
+
+  /**
+   * Returns the index in _nodes of the node with the given id, adding a
+   * record for it if this is its first mention.
+   */
+  unsigned FindNode(const Token& id, unsigned graph);
+  void GrowNodeIndex();
+  Node* DeclareNode(unsigned index, Graph* graph);
+  void CreateEdges();
+
+public:
+  /**
+   * text must stay valid until Parse returns.
+   */
+  DotParser(std::string_view text);
+
+  /**
+   * Parses the text into a new graph, which the caller owns. Returns NULL
+   * on failure.
+   */
+  RootGraph* Parse();
+
+  /**
+   * Describes why Parse failed, e.g. "line 3: expected ']'".
+   */
+  const std::string& GetError() const {
+    return _error;
+  }
+};
+
+}  // namespace DotWriter
+
+#endif
@@ -0,0 +1,94 @@
+#include "DotSink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <unistd.h>
+
+namespace DotWriter {
+
+const size_t DotSink::defaultBufferSize = 1 << 16;
+
+// Every number must fit in the buffer in one piece.
+static const size_t minBufferSize = 64;
+
+DotSink::DotSink(size_t bufferSize) :
+  _size(0), _flushed(0), _failed(false) {
+  _capacity = bufferSize < minBufferSize ? minBufferSize : bufferSize;
+  _buffer = new char[_capacity];
+}
+
+DotSink::~DotSink() {
+  delete[] _buffer;
+}
+
+void DotSink::SetError(const std::string& error) {
+  if (_error.empty()) _error = error;
+}
+
+void DotSink::Fill(char c, size_t count) {
+  while (count > 0) {
+    if (_size == _capacity) Flush();
+    size_t length = std::min(count, _capacity - _size);
+    memset(_buffer + _size, c, length);
+    _size += length;
+    count -= length;
+  }
+}
+
+void DotSink::WriteEscaped(const char* data, size_t length) {
+  size_t pos = 0;
+  while (true) {
+    size_t next = FindEscapedCharacter(data, pos, length);
+    Write(data + pos, next - pos);
+    if (EndsInOddBackslashes(data, next)) Put('\\');
+    if (next == length) break;
+
+    Put('\\');
+    Put(data[next] == '\n' ? 'n' : data[next]);
+    pos = next + 1;
+  }
+}
+
+bool DotSink::Flush() {
+  if (_size != 0 && !_failed) {
+    _failed = !WriteOut(_buffer, _size);
+  }
+
+  // On failure, the rest of the output is dropped.
+  _flushed += _size;
+  _size = 0;
+  return !_failed;
+}
+
+bool FdDotSink::WriteOut(const char* data, size_t length) {
+  while (length > 0) {
+    ssize_t written = write(_fd, data, length);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      SetError(std::string("write: ") + strerror(errno));
+      return false;
+    }
+    data += written;
+    length -= written;
+  }
+  return true;
+}
+
+bool FileDotSink::WriteOut(const char* data, size_t length) {
+  if (fwrite(data, 1, length, _file) != length) {
+    SetError(std::string("fwrite: ") + strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+bool OstreamDotSink::WriteOut(const char* data, size_t length) {
+  _out.write(data, length);
+  if (_out.fail()) {
+    SetError("stream write failed");
+    return false;
+  }
+  return true;
+}
+
+}  // namespace DotWriter
@@ -0,0 +1,256 @@
+/**
+ * Buffered destinations for DOT output.
+ *
+ * Printing a graph produces a great many tiny fragments (ids, brackets,
+ * attribute names). Sending each one through std::ostream costs a sentry
+ * and a locale lookup apiece, so everything is printed into a DotSink
+ * instead: fragments are copied into one large buffer, which is handed to the
+ * destination in bulk when it fills up. Numbers are formatted without
+ * consulting the locale.
+ *
+ * Errors do not interrupt printing. Once writing fails, the sink drops
+ * further output and remembers what went wrong; check Failed() after the
+ * last Flush().
+ */
+
+#ifndef DOTWRITER_DOTSINK_H_
+#define DOTWRITER_DOTSINK_H_
+
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+#include "Util.h"
+
+namespace DotWriter {
+
+class DotSink {
+private:
+  char* _buffer;
+  size_t _size;
+  size_t _capacity;
+  // Bytes that have left the buffer, whether or not they made it out.
+  size_t _flushed;
+  bool _failed;
+  std::string _error;
+
+  // Room needed by FormatUnsigned / FormatDouble.
+  static const size_t _maxUnsignedLength = 20;
+  static const size_t _maxDoubleLength = 32;
+
+  /**
+   * Makes room for at least length more characters, flushing if needed.
+   * Returns false if there is no room (i.e. length exceeds the capacity).
+   */
+  bool Reserve(size_t length) {
+    if (_capacity - _size >= length) return true;
+    Flush();
+    return _capacity >= length;
+  }
+
+  // Not copyable.
+  DotSink(const DotSink&);
+  DotSink& operator=(const DotSink&);
+
+protected:
+  /**
+   * Hands data to the destination. Returns false on failure, after calling
+   * SetError.
+   */
+  virtual bool WriteOut(const char* data, size_t length) = 0;
+
+  void SetError(const std::string& error);
+
+  /**
+   * Marks the sink as failed, for failures that happen outside of WriteOut.
+   */
+  void Fail(const std::string& error) {
+    SetError(error);
+    _failed = true;
+  }
+
+public:
+  // Default buffer size, in bytes.
+  static const size_t defaultBufferSize;
+
+  DotSink(size_t bufferSize = defaultBufferSize);
+
+  /**
+   * Subclasses must Flush() in their own destructors; by the time this runs,
+   * WriteOut is no longer available.
+   */
+  virtual ~DotSink();
+
+  void Write(const char* data, size_t length) {
+    if (Reserve(length)) {
+      memcpy(_buffer + _size, data, length);
+      _size += length;
+    } else {
+      // Too big to buffer; send it along directly.
+      if (!_failed && length != 0) _failed = !WriteOut(data, length);
+      _flushed += length;
+    }
+  }
+
+  void Write(const char* str) {
+    Write(str, strlen(str));
+  }
+
+  void Write(const std::string& str) {
+    Write(str.data(), str.size());
+  }
+
+  void Put(char c) {
+    if (_size == _capacity) Flush();
+    _buffer[_size++] = c;
+  }
+
+  /**
+   * Writes count copies of c.
+   */
+  void Fill(char c, size_t count);
+
+  /**
+   * Writes data escaped for use inside a quoted DOT string, without building
+   * the escaped text anywhere else first (see AppendEscaped).
+   */
+  void WriteEscaped(const char* data, size_t length);
+
+  void WriteEscaped(const std::string& str) {
+    WriteEscaped(str.data(), str.size());
+  }
+
+  void WriteUnsigned(unsigned long value) {
+    if (Reserve(_maxUnsignedLength)) {
+      _size += FormatUnsigned(value, _buffer + _size);
+    }
+  }
+
+  void WriteInteger(long value) {
+    if (value < 0) {
+      Put('-');
+      WriteUnsigned(0UL - static_cast<unsigned long>(value));
+    } else {
+      WriteUnsigned(value);
+    }
+  }
+
+  /**
+   * Writes the shortest text that reads back as exactly value.
+   */
+  void WriteDouble(double value) {
+    if (Reserve(_maxDoubleLength)) {
+      _size += FormatDouble(value, _buffer + _size);
+    }
+  }
+
+  /**
+   * Sends everything buffered so far to the destination. Returns false if
+   * anything written to this sink has failed.
+   */
+  bool Flush();
+
+  bool Failed() const {
+    return _failed;
+  }
+
+  /**
+   * Number of bytes written to this sink so far, including any that are
+   * still buffered.
+   */
+  size_t GetBytesWritten() const {
+    return _flushed + _size;
+  }
+
+  /**
+   * Describes the first failure, if any.
+   */
+  const std::string& GetError() const {
+    return _error;
+  }
+};
+
+/**
+ * Writes to a file descriptor. The descriptor is not closed.
+ */
+class FdDotSink : public DotSink {
+private:
+  int _fd;
+
+protected:
+  virtual bool WriteOut(const char* data, size_t length);
+
+public:
+  FdDotSink(int fd, size_t bufferSize = defaultBufferSize) :
+    DotSink(bufferSize), _fd(fd) {};
+
+  virtual ~FdDotSink() {
+    Flush();
+  }
+};
+
+/**
+ * Writes to a stdio stream. The stream is neither flushed nor closed.
+ */
+class FileDotSink : public DotSink {
+private:
+  FILE* _file;
+
+protected:
+  virtual bool WriteOut(const char* data, size_t length);
+
+public:
+  FileDotSink(FILE* file, size_t bufferSize = defaultBufferSize) :
+    DotSink(bufferSize), _file(file) {};
+
+  virtual ~FileDotSink() {
+    Flush();
+  }
+};
+
+/**
+ * Appends to a string.
+ */
+class StringDotSink : public DotSink {
+private:
+  std::string& _str;
+
+protected:
+  virtual bool WriteOut(const char* data, size_t length) {
+    _str.append(data, length);
+    return true;
+  }
+
+public:
+  StringDotSink(std::string& str, size_t bufferSize = defaultBufferSize) :
+    DotSink(bufferSize), _str(str) {};
+
+  virtual ~StringDotSink() {
+    Flush();
+  }
+};
+
+/**
+ * Writes to a std::ostream. Used by the std::ostream versions of the Print
+ * functions.
+ */
+class OstreamDotSink : public DotSink {
+private:
+  std::ostream& _out;
+
+protected:
+  virtual bool WriteOut(const char* data, size_t length);
+
+public:
+  OstreamDotSink(std::ostream& out, size_t bufferSize = defaultBufferSize) :
+    DotSink(bufferSize), _out(out) {};
+
+  virtual ~OstreamDotSink() {
+    Flush();
+  }
+};
+
+}  // namespace DotWriter
+
+#endif
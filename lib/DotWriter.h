@@ -8,13 +8,25 @@
 
 #include "Enums.h"
 #include "Graph.h"
+#include "GraphBuilder.h"
+#include "GraphStats.h"
+#include "GraphView.h"
+#include "GraphvizRenderer.h"
 #include "Edge.h"
 #include "Node.h"
+#include "PrintOptions.h"
 #include "RootGraph.h"
+#include "Snapshot.h"
+#include "StreamingGraphWriter.h"
+#include "Style.h"
 #include "Subgraph.h"
+#include "TextProvider.h"
 #include "Cluster.h"
 #include "AttributeSet.h"
 #include "Attribute.h"
 #include "Idable.h"
+#include "DotSink.h"
+#include "CompressedDotSink.h"
+#include "DetailReducer.h"
 
 #endif
@@ -1,25 +1,115 @@
 #include "Edge.h"
 #include "Node.h"
 #include "Graph.h"
+#include "GraphView.h"
 
 #include <ostream>
 
 namespace DotWriter {
 
-Edge::Edge(Node * src, Node * dst, std::string label) : _src(src),
-  _dst(dst), _label(label) {
+Edge::Edge(Node * src, Node * dst, Graph * graph, std::string label) :
+  _src(src), _dst(dst), _graph(graph), _label(std::move(label)),
+  _prevOut(NULL), _nextOut(NULL), _prevIn(NULL), _nextIn(NULL), _slot(0) {
 }
 
-void Edge::Print(bool isDirected, std::ostream& out) {
-  out << _src->GetId() << (isDirected ? "->" : "--") << _dst->GetId();
+void Edge::MarkDirty() {
+  _graph->EdgeChanged(this);
+}
+
+EdgeAttributeSet& Edge::MutableAttributes() {
+  return _style.Mutable(this, _graph->_stylePool);
+}
+
+void Edge::Link() {
+  _prevOut = NULL;
+  _nextOut = _src->_firstOutEdge;
+  if (_nextOut != NULL) _nextOut->_prevOut = this;
+  _src->_firstOutEdge = this;
+  _src->_outDegree++;
+
+  _prevIn = NULL;
+  _nextIn = _dst->_firstInEdge;
+  if (_nextIn != NULL) _nextIn->_prevIn = this;
+  _dst->_firstInEdge = this;
+  _dst->_inDegree++;
+}
+
+void Edge::Unlink() {
+  if (_prevOut != NULL) {
+    _prevOut->_nextOut = _nextOut;
+  } else {
+    _src->_firstOutEdge = _nextOut;
+  }
+  if (_nextOut != NULL) _nextOut->_prevOut = _prevOut;
+  _src->_outDegree--;
+
+  if (_prevIn != NULL) {
+    _prevIn->_nextIn = _nextIn;
+  } else {
+    _dst->_firstInEdge = _nextIn;
+  }
+  if (_nextIn != NULL) _nextIn->_prevIn = _prevIn;
+  _dst->_inDegree--;
+
+  _prevOut = _nextOut = _prevIn = _nextIn = NULL;
+}
+
+void Edge::PrintAttributes(DotSink& out, const PrintOptions& options,
+  const EdgeAttributeSet* hoisted) const {
+  const EdgeAttributeSet* attributes = &_style.Get();
+  const std::string* label = &_label;
+  if (options.view != NULL) {
+    const GraphView::EdgeCopy* copy = options.view->Find(this);
+    if (copy != NULL) {
+      attributes = &copy->attributes;
+      label = &copy->label;
+    }
+  }
+  if (attributes == hoisted) attributes = &SharedEdgeStyle::EmptySet();
+  bool open = !attributes->Empty() || !label->empty();
+  if (open) {
+    if (options.compact) {
+      out.Put('[');
+      attributes->PrintWithLabel(out, *label, "", ",", true);
+    } else {
+      out.Write(" [", 2);
+      attributes->PrintWithLabel(out, *label, "", ", ");
+    }
+  }
 
-  if (!_attributes.Empty()) {
-    out << " [";
-    _attributes.Print(out);
-    out << "]";
+  // Provided attributes come last, so that they win.
+  const TextProvider* provider = _graph->_textProvider;
+  if (provider != NULL) {
+    SinkAttributeWriter writer(out, options.compact, open);
+    provider->AddEdgeText(*this, writer);
+    open = writer.IsOpen();
   }
+  if (open) out.Put(']');
+}
+
+void Edge::Print(bool isDirected, DotSink& out) const {
+  Print(isDirected, out, PrintOptions());
+}
+
+void Edge::Print(bool isDirected, DotSink& out, const PrintOptions& options,
+  const EdgeAttributeSet* hoisted) const {
+  // Both ends are under the same root, so they share its IdManager.
+  const IdManager& ids = *_graph->_idManager;
+  ids.PrintId(out, _src->GetIdHandle());
+  out.Write(isDirected ? "->" : "--", 2);
+  ids.PrintId(out, _dst->GetIdHandle());
+  PrintAttributes(out, options, hoisted);
+
+  if (options.compact) {
+    out.Put('\n');
+  } else {
+    out.Write(";\n", 2);
+  }
+}
 
-  out << ";\n";
+void Edge::Print(bool isDirected, std::ostream& out) const {
+  OstreamDotSink sink(out);
+  Print(isDirected, sink);
 }
 
 }  // namespace DotWriter
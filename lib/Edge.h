@@ -1,25 +1,72 @@
 #ifndef DOTWRITER_EDGE_H_
 #define DOTWRITER_EDGE_H_
 
+#include <string>
+#include <utility>
+
 #include "AttributeSet.h"
 #include "Idable.h"
+#include "PrintOptions.h"
+#include "Style.h"
 
 namespace DotWriter {
 
 class Graph;
+class Node;
 
 /**
  * Represents an edge in a graph.
+ *
+ * Every edge is also threaded onto two lists: the out edges of its source and
+ * the in edges of its destination (see Node::GetFirstOutEdge). Graph keeps
+ * these lists up to date, so that a node's edges can be found without
+ * scanning the graph.
  */
-class Edge {
+class Edge : public AttributeListener {
 private:
   Node * _src;
   Node * _dst;
+  Graph * _graph;  // The graph that owns this edge.
   std::string _label;
-  EdgeAttributeSet _attributes;
+  // Usually shared with other edges; see SetStyle.
+  SharedEdgeStyle _style;
+  // Neighbours in the source's out edge list and the destination's in edge
+  // list.
+  Edge * _prevOut;
+  Edge * _nextOut;
+  Edge * _prevIn;
+  Edge * _nextIn;
+  unsigned _slot;  // Position in the graph's edge list.
+
+  friend class Graph;
+  friend class Snapshot;
+  template <typename T> friend class SlotList;
+
+  /**
+   * Adds / removes this edge to / from the lists of its endpoints.
+   */
+  void Link();
+  void Unlink();
+
+  /**
+   * Prints the attribute list, including the '[' and ']', if the edge has
+   * anything to put in it. Attributes at the address hoisted are left out
+   * (see Node::Print).
+   */
+  void PrintAttributes(DotSink& out, const PrintOptions& options,
+    const EdgeAttributeSet* hoisted) const;
+
+  /**
+   * Lets the graph know that this edge's output has changed.
+   */
+  void MarkDirty();
+
+  virtual void AttributesChanged() {
+    MarkDirty();
+  }
 
 public:
-  Edge(Node * src, Node * dst, std::string label = "");
+  Edge(Node * src, Node * dst, Graph * graph, std::string label = "");
 
   virtual ~Edge() {};
 
@@ -27,27 +74,93 @@ public:
     return _src;
   }
 
+  const Node * GetSource() const {
+    return _src;
+  }
+
   Node * GetDest() {
     return _dst;
   }
 
-  const std::string& GetLabel() {
+  const Node * GetDest() const {
+    return _dst;
+  }
+
+  Graph * GetGraph() {
+    return _graph;
+  }
+
+  const Graph * GetGraph() const {
+    return _graph;
+  }
+
+  /**
+   * The next edge leaving this edge's source, or NULL.
+   */
+  Edge * GetNextOutEdge() {
+    return _nextOut;
+  }
+
+  /**
+   * The next edge entering this edge's destination, or NULL.
+   */
+  Edge * GetNextInEdge() {
+    return _nextIn;
+  }
+
+  const std::string& GetLabel() const {
     return _label;
   }
 
-  void SetLabel(const std::string& label) {
-    _label = label;
+  void SetLabel(std::string label) {
+    _label = std::move(label);
+    MarkDirty();
   }
 
   /**
    * Returns the set of attributes for this edge.
-   * Manipulate this object to change the style of this edge.
+   * Manipulate this object to change the style of this edge. If the edge
+   * shares its style, it gets a private copy first, so only call this to
+   * change it.
+   */
+  EdgeAttributeSet& MutableAttributes();
+
+  /**
+   * Same as MutableAttributes (see Node::GetAttributes).
    */
   EdgeAttributeSet& GetAttributes() {
-    return _attributes;
+    return MutableAttributes();
+  }
+
+  const EdgeAttributeSet& GetAttributes() const {
+    return _style.Get();
   }
 
-  void Print(bool isDirected, std::ostream& out);
+  /**
+   * Makes the edge share the given style, replacing its attributes (see
+   * Node::SetStyle).
+   */
+  void SetStyle(const SharedEdgeStyle& style) {
+    _style = style;
+    MarkDirty();
+  }
+
+  const SharedEdgeStyle& GetStyle() const {
+    return _style;
+  }
+
+  /**
+   * Prints the edge's line of a DOT file. Does not change the edge.
+   */
+  void Print(bool isDirected, DotSink& out) const;
+  void Print(bool isDirected, std::ostream& out) const;
+
+  /**
+   * Same as Print, but formatted according to options, and leaving the
+   * attributes out if they are the hoisted ones (see Node::Print).
+   */
+  void Print(bool isDirected, DotSink& out, const PrintOptions& options,
+    const EdgeAttributeSet* hoisted = NULL) const;
 };
 
 }  // namespace DotWriter
@@ -2,7 +2,7 @@
  * Stores all of the support enums used in the graph library.
  *
  * DO NOT CHANGE THE ORDER OF THE ENUMS WITHOUT CHANGING THE STRINGS STORED IN
- * GEnums.cpp.
+ * Enums.cpp.
  *
  * All enums have a DEFAULT value. This is interpreted to mean, "Do not
  * explicitly specify in the DOT file."
@@ -10,12 +10,19 @@
  * All enums also have a COUNT value which is used for bounds checking. This
  * must be the last item in the enum.
  *
+ * Every enum converts both ways: ToString / ToStringView give the DOT text of a
+ * value (the view saves a strlen when writing it out), and FromString looks the
+ * text up again, returning false if it names no value. FromString is exact, so
+ * "Box" is not "box", and DEFAULT is never matched.
+ *
  * Author: John Vilk
  */
 
 #ifndef DOTWRITER_ENUMS_H_
 #define DOTWRITER_ENUMS_H_
 
+#include <string_view>
+
 namespace DotWriter {
 
 /** We encapsulate each enum inside a struct to prevent name collisions. **/
@@ -46,10 +53,12 @@ struct EdgeArrowTypeName {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
-  static const char* ToString(EdgeArrowTypeName::e);
+  static const char* ToString(EdgeArrowTypeName::e val);
+  static std::string_view ToStringView(EdgeArrowTypeName::e val);
+  static bool FromString(std::string_view text, EdgeArrowTypeName::e* val);
 };
 
 struct EdgeStyle {
@@ -65,10 +74,12 @@ struct EdgeStyle {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(EdgeStyle::e val);
+  static std::string_view ToStringView(EdgeStyle::e val);
+  static bool FromString(std::string_view text, EdgeStyle::e* val);
 };
 
 struct DirType {
@@ -82,10 +93,12 @@ struct DirType {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(DirType::e val);
+  static std::string_view ToStringView(DirType::e val);
+  static bool FromString(std::string_view text, DirType::e* val);
 };
 
 struct NodeStyle {
@@ -104,10 +117,12 @@ struct NodeStyle {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(NodeStyle::e val);
+  static std::string_view ToStringView(NodeStyle::e val);
+  static bool FromString(std::string_view text, NodeStyle::e* val);
 };
 
 struct NodeShape {
@@ -152,10 +167,12 @@ struct NodeShape {
   };
 
 private:
-    static const char* strings[];
+    static const std::string_view strings[];
 
 public:
   static const char* ToString(NodeShape::e val);
+  static std::string_view ToStringView(NodeShape::e val);
+  static bool FromString(std::string_view text, NodeShape::e* val);
 };
 
 struct Charset {
@@ -167,10 +184,12 @@ struct Charset {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(Charset::e val);
+  static std::string_view ToStringView(Charset::e val);
+  static bool FromString(std::string_view text, Charset::e* val);
 };
 
 struct OutputMode {
@@ -183,10 +202,12 @@ struct OutputMode {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(OutputMode::e val);
+  static std::string_view ToStringView(OutputMode::e val);
+  static bool FromString(std::string_view text, OutputMode::e* val);
 };
 
 struct ClusterMode {
@@ -199,10 +220,12 @@ struct ClusterMode {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(ClusterMode::e val);
+  static std::string_view ToStringView(ClusterMode::e val);
+  static bool FromString(std::string_view text, ClusterMode::e* val);
 };
 
 struct LabelLoc {
@@ -215,10 +238,12 @@ struct LabelLoc {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(LabelLoc::e val);
+  static std::string_view ToStringView(LabelLoc::e val);
+  static bool FromString(std::string_view text, LabelLoc::e* val);
 };
 
 struct PageDir {
@@ -236,10 +261,12 @@ struct PageDir {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(PageDir::e val);
+  static std::string_view ToStringView(PageDir::e val);
+  static bool FromString(std::string_view text, PageDir::e* val);
 };
 
 struct QuadType {
@@ -252,10 +279,12 @@ struct QuadType {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(QuadType::e val);
+  static std::string_view ToStringView(QuadType::e val);
+  static bool FromString(std::string_view text, QuadType::e* val);
 };
 
 struct RankType {
@@ -270,10 +299,12 @@ struct RankType {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(RankType::e val);
+  static std::string_view ToStringView(RankType::e val);
+  static bool FromString(std::string_view text, RankType::e* val);
 };
 
 struct RankDir {
@@ -287,10 +318,12 @@ struct RankDir {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(RankDir::e val);
+  static std::string_view ToStringView(RankDir::e val);
+  static bool FromString(std::string_view text, RankDir::e* val);
 };
 
 struct DirEdgeConstraints {
@@ -302,10 +335,12 @@ struct DirEdgeConstraints {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(DirEdgeConstraints::e val);
+  static std::string_view ToStringView(DirEdgeConstraints::e val);
+  static bool FromString(std::string_view text, DirEdgeConstraints::e* val);
 };
 
 struct CompassPoint {
@@ -324,10 +359,12 @@ struct CompassPoint {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(CompassPoint::e val);
+  static std::string_view ToStringView(CompassPoint::e val);
+  static bool FromString(std::string_view text, CompassPoint::e* val);
 };
 
 struct Model {
@@ -340,10 +377,12 @@ struct Model {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(Model::e val);
+  static std::string_view ToStringView(Model::e val);
+  static bool FromString(std::string_view text, Model::e* val);
 };
 
 struct Ordering {
@@ -355,10 +394,12 @@ struct Ordering {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(Ordering::e val);
+  static std::string_view ToStringView(Ordering::e val);
+  static bool FromString(std::string_view text, Ordering::e* val);
 };
 
 struct Mode {
@@ -372,10 +413,12 @@ struct Mode {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(Mode::e val);
+  static std::string_view ToStringView(Mode::e val);
+  static bool FromString(std::string_view text, Mode::e* val);
 };
 
 struct Justification {
@@ -387,10 +430,12 @@ struct Justification {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(Justification::e val);
+  static std::string_view ToStringView(Justification::e val);
+  static bool FromString(std::string_view text, Justification::e* val);
 };
 
 struct Ratio {
@@ -404,10 +449,12 @@ struct Ratio {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(Ratio::e val);
+  static std::string_view ToStringView(Ratio::e val);
+  static bool FromString(std::string_view text, Ratio::e* val);
 };
 
 struct SmoothType {
@@ -424,10 +471,12 @@ struct SmoothType {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(SmoothType::e val);
+  static std::string_view ToStringView(SmoothType::e val);
+  static bool FromString(std::string_view text, SmoothType::e* val);
 };
 
 struct SplineType {
@@ -442,10 +491,12 @@ struct SplineType {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(SplineType::e val);
+  static std::string_view ToStringView(SplineType::e val);
+  static bool FromString(std::string_view text, SplineType::e* val);
 };
 
 struct ImageScaleType {
@@ -458,10 +509,12 @@ struct ImageScaleType {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(ImageScaleType::e val);
+  static std::string_view ToStringView(ImageScaleType::e val);
+  static bool FromString(std::string_view text, ImageScaleType::e* val);
 };
 
 /**
@@ -1133,10 +1186,12 @@ struct Color {
   };
 
 private:
-  static const char* strings[];
+  static const std::string_view strings[];
 
 public:
   static const char* ToString(Color::e val);
+  static std::string_view ToStringView(Color::e val);
+  static bool FromString(std::string_view text, Color::e* val);
 };
 
 struct AttributeType {
@@ -1303,11 +1358,9 @@ struct AttributeType {
     COUNT
   };
 
-private:
-  static const char* strings[];
-
-public:
   static const char* ToString(AttributeType::e val);
+  static std::string_view ToStringView(AttributeType::e val);
+  static bool FromString(std::string_view text, AttributeType::e* val);
 };
 
 }  // namespace DotWriter
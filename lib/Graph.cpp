@@ -8,6 +8,13 @@
 #include "Cluster.h"
 #include "Node.h"
 #include "Edge.h"
+#include "GraphView.h"
+#include "RootGraph.h"
+
+#include <algorithm>
+#include <new>
+#include <unordered_map>
+#include <utility>
 
 namespace DotWriter {
 
@@ -16,169 +23,782 @@ const char Graph::_tabCharacter = ' ';
 const unsigned Graph::_tabIncrement = 2;
 
 Graph::~Graph() {
-  std::vector<Node *>::iterator nodeIt;
+  DestroyContents();
+  delete _cache;
+}
+
+void Graph::DestroyContents() {
+  SlotList<Node>::iterator nodeIt;
   for (nodeIt = _nodes.begin(); nodeIt != _nodes.end(); nodeIt++) {
-    delete *nodeIt;
+    _arena->Destroy(*nodeIt);
   }
+  _nodes.Clear();
 
-  std::vector<Edge *>::iterator edgeIt;
+  SlotList<Edge>::iterator edgeIt;
   for (edgeIt = _edges.begin(); edgeIt != _edges.end(); edgeIt++) {
-    delete *edgeIt;
+    _arena->Destroy(*edgeIt);
   }
+  _edges.Clear();
 
-  std::vector<Subgraph *>::iterator sgIt;
+  SlotList<Subgraph>::iterator sgIt;
   for (sgIt = _subgraphs.begin(); sgIt != _subgraphs.end(); sgIt++) {
-    delete *sgIt;
+    _arena->Destroy(*sgIt);
   }
+  _subgraphs.Clear();
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = _clusters.begin(); cIt != _clusters.end(); cIt++) {
+    _arena->Destroy(*cIt);
+  }
+  _clusters.Clear();
 }
 
-Subgraph* Graph::AddSubgraph(const std::string& label) {
-  Subgraph* sg = new Subgraph(_idManager->GetSubgraphId(), _idManager,
-    IsDigraph(), label);
-  _subgraphs.push_back(sg);
+void Graph::Reserve(size_t nodes, size_t edges, size_t customIds) {
+  _nodes.ReserveMore(nodes);
+  _edges.ReserveMore(edges);
+  _idManager->Reserve(customIds);
+}
+
+Subgraph* Graph::AddSubgraph(std::string label) {
+  Subgraph* sg = new (_arena->Allocate(sizeof(Subgraph)))
+    Subgraph(_idManager->CreateSubgraphId(), _idManager, _arena, _stylePool,
+      IsDigraph(), std::move(label));
+  _subgraphs.PushBack(sg);
+  if (_cache != NULL) sg->SetOutputCaching(true);
+  if (_hoistStyles) sg->SetStyleHoisting(true);
+  if (_textProvider != NULL) sg->SetTextProvider(_textProvider);
   return sg;
 }
 
-Subgraph* Graph::AddSubgraph(const std::string& label, const std::string& id) {
-  std::string sanitizedId = _idManager->ValidateCustomId(id);
-  Subgraph* sg = new Subgraph(sanitizedId, _idManager, IsDigraph(), label);
-  _subgraphs.push_back(sg);
+Subgraph* Graph::AddSubgraph(std::string label, std::string_view id) {
+  IdHandle sanitizedId = _idManager->CreateCustomId(id);
+  Subgraph* sg = new (_arena->Allocate(sizeof(Subgraph)))
+    Subgraph(sanitizedId, _idManager, _arena, _stylePool,
+      IsDigraph(), std::move(label));
+  _subgraphs.PushBack(sg);
+  if (_cache != NULL) sg->SetOutputCaching(true);
+  if (_hoistStyles) sg->SetStyleHoisting(true);
+  if (_textProvider != NULL) sg->SetTextProvider(_textProvider);
   return sg;
 }
 
-void Graph::RemoveSubgraph(Subgraph* subgraph) {
-  std::vector<Subgraph*>::iterator it = std::find(_subgraphs.begin(),
-    _subgraphs.end(), subgraph);
+void Graph::UnlinkContents() {
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = _subgraphs.begin(); sgIt != _subgraphs.end(); sgIt++) {
+    (*sgIt)->UnlinkContents();
+  }
 
-  if (it != _subgraphs.end())
-    _subgraphs.erase(it);
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = _clusters.begin(); cIt != _clusters.end(); cIt++) {
+    (*cIt)->UnlinkContents();
+  }
 
-  delete subgraph;
+  SlotList<Edge>::iterator edgeIt;
+  for (edgeIt = _edges.begin(); edgeIt != _edges.end(); edgeIt++) {
+    (*edgeIt)->Unlink();
+  }
+
+  // What is left are edges from other graphs.
+  SlotList<Node>::iterator nodeIt;
+  for (nodeIt = _nodes.begin(); nodeIt != _nodes.end(); nodeIt++) {
+    RemoveIncidentEdges(*nodeIt);
+  }
+}
+
+void Graph::RemoveIncidentEdges(Node* node) {
+  Edge* edge;
+  while ((edge = node->GetFirstOutEdge()) != NULL) {
+    edge->GetGraph()->RemoveEdge(edge);
+  }
+  while ((edge = node->GetFirstInEdge()) != NULL) {
+    edge->GetGraph()->RemoveEdge(edge);
+  }
+}
+
+void Graph::RemoveSubgraph(Subgraph* subgraph) {
+  _subgraphs.Remove(subgraph);
+  subgraph->UnlinkContents();
+  _arena->Destroy(subgraph);
 }
 
-Cluster* Graph::AddCluster(const std::string& label) {
-  Cluster* cluster = new Cluster(_idManager->GetClusterId(), _idManager,
-    IsDigraph(), label);
-  _clusters.push_back(cluster);
+Cluster* Graph::AddCluster(std::string label) {
+  Cluster* cluster = new (_arena->Allocate(sizeof(Cluster)))
+    Cluster(_idManager->CreateClusterId(), _idManager, _arena, _stylePool,
+      IsDigraph(), std::move(label));
+  _clusters.PushBack(cluster);
+  if (_cache != NULL) cluster->SetOutputCaching(true);
+  if (_hoistStyles) cluster->SetStyleHoisting(true);
+  if (_textProvider != NULL) cluster->SetTextProvider(_textProvider);
   return cluster;
 }
 
-Cluster* Graph::AddCluster(const std::string& label, const std::string& id) {
-  std::string sanitizedId = _idManager->ValidateCustomClusterId(id);
-  Cluster* cluster = new Cluster(sanitizedId, _idManager, IsDigraph(), label);
-  _clusters.push_back(cluster);
+Cluster* Graph::AddCluster(std::string label, std::string_view id) {
+  IdHandle sanitizedId = _idManager->CreateCustomClusterId(id);
+  Cluster* cluster = new (_arena->Allocate(sizeof(Cluster)))
+    Cluster(sanitizedId, _idManager, _arena, _stylePool,
+      IsDigraph(), std::move(label));
+  _clusters.PushBack(cluster);
+  if (_cache != NULL) cluster->SetOutputCaching(true);
+  if (_hoistStyles) cluster->SetStyleHoisting(true);
+  if (_textProvider != NULL) cluster->SetTextProvider(_textProvider);
   return cluster;
 }
 
 void Graph::RemoveCluster(Cluster* cluster) {
-  std::vector<Cluster*>::iterator it = std::find(_clusters.begin(),
-    _clusters.end(), cluster);
-
-  if (it != _clusters.end())
-    _clusters.erase(it);
-
-  delete cluster;
+  _clusters.Remove(cluster);
+  cluster->UnlinkContents();
+  _arena->Destroy(cluster);
 }
 
 Node* Graph::AddNode() {
-  Node* node = new Node(_idManager->GetNodeId());
-  _nodes.push_back(node);
+  Node* node = new (_arena->Allocate(sizeof(Node)))
+    Node(this, _idManager->CreateNodeId());
+  _nodes.PushBack(node);
+  NodeChanged(node);
   return node;
 }
 
-Node* Graph::AddNode(const std::string& label) {
-  Node* node = new Node(_idManager->GetNodeId(), label);
-  _nodes.push_back(node);
+Node* Graph::AddNode(std::string label) {
+  Node* node = new (_arena->Allocate(sizeof(Node)))
+    Node(this, _idManager->CreateNodeId(), std::move(label));
+  _nodes.PushBack(node);
+  NodeChanged(node);
   return node;
 }
 
-Node* Graph::AddNode(const std::string& label, const std::string& id) {
-  Node* node = new Node(_idManager->ValidateCustomId(id), label);
-  _nodes.push_back(node);
+Node* Graph::AddNode(std::string label, std::string_view id) {
+  Node* node = new (_arena->Allocate(sizeof(Node)))
+    Node(this, _idManager->CreateCustomId(id), std::move(label));
+  _nodes.PushBack(node);
+  NodeChanged(node);
   return node;
 }
 
-void Graph::RemoveNode(Node* node) {
-  std::vector<Node*>::iterator it = std::find(_nodes.begin(), _nodes.end(),
-    node);
+Graph::NodeRange Graph::AddNodes(size_t count) {
+  size_t first = _nodes.SlotCount();
+  _nodes.ReserveMore(count);
 
-  if (it != _nodes.end()) {
-    _nodes.erase(it);
+  for (size_t i = 0; i < count; i++) {
+    Node* node = new (_arena->Allocate(sizeof(Node)))
+      Node(this, _idManager->CreateNodeId());
+    _nodes.PushBack(node);
+    NodeChanged(node);
   }
 
-  delete node;
+  return _nodes.RangeAt(first, first + count);
+}
+
+void Graph::RemoveNode(Node* node) {
+  // The node may belong to another graph under the same root.
+  Graph* owner = node->_graph;
+  owner->NodeChanged(node);
+  size_t numSlots = owner->_nodes.SlotCount();
+  owner->_nodes.Remove(node);
+  // The list may have compacted itself, moving everything.
+  if (owner->_cache != NULL && owner->_nodes.SlotCount() != numSlots) {
+    owner->_cache->MarkNodesDirty();
+  }
+  RemoveIncidentEdges(node);
+  _arena->Destroy(node);
 }
 
 Edge* Graph::AddEdge(Node* src, Node* dst) {
-  Edge* edge = new Edge(src, dst);
-  _edges.push_back(edge);
+  Edge* edge = new (_arena->Allocate(sizeof(Edge))) Edge(src, dst, this);
+  edge->Link();
+  _edges.PushBack(edge);
+  EdgeChanged(edge);
   return edge;
 }
 
-Edge* Graph::AddEdge(Node* src, Node* dst, const std::string& label) {
-  Edge* edge = new Edge(src, dst, label);
-  _edges.push_back(edge);
+Edge* Graph::AddEdge(Node* src, Node* dst, std::string label) {
+  Edge* edge = new (_arena->Allocate(sizeof(Edge)))
+    Edge(src, dst, this, std::move(label));
+  edge->Link();
+  _edges.PushBack(edge);
+  EdgeChanged(edge);
   return edge;
 }
 
+Graph::EdgeRange Graph::AddEdges(const std::pair<Node*, Node*>* pairs,
+  size_t count, const EdgeAttributeSet* attributes) {
+  SharedEdgeStyle style;
+  if (attributes != NULL) style = SharedEdgeStyle(*attributes);
+  return AddEdges(pairs, count, style);
+}
+
+Graph::EdgeRange Graph::AddEdges(const std::pair<Node*, Node*>* pairs,
+  size_t count, const SharedEdgeStyle& style) {
+  size_t first = _edges.SlotCount();
+  _edges.ReserveMore(count);
+
+  for (size_t i = 0; i < count; i++) {
+    Edge* edge = new (_arena->Allocate(sizeof(Edge)))
+      Edge(pairs[i].first, pairs[i].second, this);
+    edge->Link();
+    _edges.PushBack(edge);
+    edge->_style = style;
+    EdgeChanged(edge);
+  }
+
+  return _edges.RangeAt(first, first + count);
+}
+
+Graph::EdgeRange Graph::AddEdges(
+  const std::vector<std::pair<Node*, Node*> >& pairs,
+  const EdgeAttributeSet* attributes) {
+  return AddEdges(pairs.data(), pairs.size(), attributes);
+}
+
 void Graph::RemoveEdge(Edge* edge) {
-  std::vector<Edge*>::iterator it = std::find(_edges.begin(), _edges.end(),
-    edge);
+  // The edge may belong to one of our subgraphs.
+  Graph* owner = edge->GetGraph();
+  owner->EdgeChanged(edge);
+  size_t numSlots = owner->_edges.SlotCount();
+  owner->_edges.Remove(edge);
+  if (owner->_cache != NULL && owner->_edges.SlotCount() != numSlots) {
+    owner->_cache->MarkEdgesDirty();
+  }
+  edge->Unlink();
+  _arena->Destroy(edge);
+}
+
+void Graph::RemoveEdge(Node* src, Node* dst) {
+  Edge* edge = src->GetFirstOutEdge();
+  while (edge != NULL) {
+    Edge* next = edge->GetNextOutEdge();
+    if (edge->GetDest() == dst && edge->GetGraph() == this) RemoveEdge(edge);
+    edge = next;
+  }
 
-  if (it != _edges.end())
-    _edges.erase(it);
+  if (IsDigraph()) return;
 
-  delete edge;
+  edge = dst->GetFirstOutEdge();
+  while (edge != NULL) {
+    Edge* next = edge->GetNextOutEdge();
+    if (edge->GetDest() == src && edge->GetGraph() == this) RemoveEdge(edge);
+    edge = next;
+  }
 }
 
-void Graph::PrintNECS(std::ostream& out, unsigned tabDepth) {
-  std::string linePrefix = std::string(tabDepth*_tabIncrement, _tabCharacter);
+void Graph::Merge(const RootGraph& other, MergePolicy::e policy) {
+  GraphMatcher::Merge(*this, std::vector<const RootGraph*>(1, &other),
+    policy);
+}
 
-  // Default styles.
-  if (!_defaultNodeAttributes.Empty()) {
-    out << linePrefix;
-    out << "node [";
-    _defaultNodeAttributes.Print(out);
-    out << "];\n";
+void Graph::Compact() {
+  size_t numNodeSlots = _nodes.SlotCount();
+  size_t numEdgeSlots = _edges.SlotCount();
+  _nodes.Compact();
+  _edges.Compact();
+  if (_cache != NULL) {
+    if (_nodes.SlotCount() != numNodeSlots) _cache->MarkNodesDirty();
+    if (_edges.SlotCount() != numEdgeSlots) _cache->MarkEdgesDirty();
   }
+  _subgraphs.Compact();
+  _clusters.Compact();
 
-  if (!_defaultEdgeAttributes.Empty()) {
-    out << linePrefix;
-    out << "edge [";
-    _defaultEdgeAttributes.Print(out);
-    out << "];\n";
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = _subgraphs.begin(); sgIt != _subgraphs.end(); sgIt++) {
+    (*sgIt)->Compact();
   }
 
-  // Output nodes
-  std::vector<Node*>::iterator nodeIt;
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = _clusters.begin(); cIt != _clusters.end(); cIt++) {
+    (*cIt)->Compact();
+  }
+}
+
+size_t Graph::EstimateOutputSize(unsigned tabDepth) const {
+  // Guesses for an id with its punctuation, and for an attribute.
+  const size_t nodeSize = 12;
+  const size_t edgeSize = 28;
+  const size_t attributeSize = 20;
+  size_t indent = tabDepth*_tabIncrement;
+
+  size_t size = 64 + indent + (_defaultNodeAttributes.Size() +
+    _defaultEdgeAttributes.Size())*attributeSize;
+
+  SlotList<Node>::iterator nodeIt;
+  for (nodeIt = _nodes.begin(); nodeIt != _nodes.end(); nodeIt++) {
+    const Node* node = *nodeIt;
+    size += indent + nodeSize + node->GetLabel().size() +
+      node->GetAttributes().Size()*attributeSize;
+  }
+
+  SlotList<Edge>::iterator edgeIt;
+  for (edgeIt = _edges.begin(); edgeIt != _edges.end(); edgeIt++) {
+    const Edge* edge = *edgeIt;
+    size += indent + edgeSize + edge->GetLabel().size() +
+      edge->GetAttributes().Size()*attributeSize;
+  }
+
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = _subgraphs.begin(); sgIt != _subgraphs.end(); sgIt++) {
+    size += (*sgIt)->EstimateOutputSize(tabDepth+1);
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = _clusters.begin(); cIt != _clusters.end(); cIt++) {
+    size += (*cIt)->EstimateOutputSize(tabDepth+1);
+  }
+
+  return size;
+}
+
+void Graph::SetOutputCaching(bool enabled) {
+  if (enabled && _cache == NULL) {
+    _cache = new OutputCache();
+  } else if (!enabled) {
+    delete _cache;
+    _cache = NULL;
+  }
+
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = _subgraphs.begin(); sgIt != _subgraphs.end(); sgIt++) {
+    (*sgIt)->SetOutputCaching(enabled);
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = _clusters.begin(); cIt != _clusters.end(); cIt++) {
+    (*cIt)->SetOutputCaching(enabled);
+  }
+}
+
+void Graph::SetStyleHoisting(bool enabled) {
+  _hoistStyles = enabled;
+
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = _subgraphs.begin(); sgIt != _subgraphs.end(); sgIt++) {
+    (*sgIt)->SetStyleHoisting(enabled);
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = _clusters.begin(); cIt != _clusters.end(); cIt++) {
+    (*cIt)->SetStyleHoisting(enabled);
+  }
+}
+
+void Graph::SetTextProvider(const TextProvider* provider) {
+  _textProvider = provider;
+  if (_cache != NULL) {
+    _cache->MarkNodesDirty();
+    _cache->MarkEdgesDirty();
+  }
+
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = _subgraphs.begin(); sgIt != _subgraphs.end(); sgIt++) {
+    (*sgIt)->SetTextProvider(provider);
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = _clusters.begin(); cIt != _clusters.end(); cIt++) {
+    (*cIt)->SetTextProvider(provider);
+  }
+}
+
+/**
+ * Returns the attributes of the style shared by the most elements in list,
+ * or NULL if no style is shared by at least two.
+ */
+template <typename T, typename A>
+static const A* DominantStyle(const SlotList<T>& list) {
+  std::unordered_map<const A*, size_t> counts;
+  const A* dominant = NULL;
+  size_t dominantCount = 1;
+
+  typename SlotList<T>::iterator it;
+  for (it = list.begin(); it != list.end(); it++) {
+    const T* element = *it;
+    const A& attributes = element->GetAttributes();
+    if (attributes.Empty()) continue;
+
+    size_t count = ++counts[&attributes];
+    if (count > dominantCount) {
+      dominant = &attributes;
+      dominantCount = count;
+    }
+  }
+
+  return dominant;
+}
+
+Graph::HoistedStyles Graph::ChooseHoistedStyles() const {
+  HoistedStyles hoisted = { NULL, NULL };
+  if (!_hoistStyles) return hoisted;
+
+  if (_defaultNodeAttributes.Empty()) {
+    hoisted.node = DominantStyle<Node, NodeAttributeSet>(_nodes);
+    if (hoisted.node != NULL && !NodesOverride(*hoisted.node, false)) {
+      hoisted.node = NULL;
+    }
+  }
+  if (_defaultEdgeAttributes.Empty()) {
+    hoisted.edge = DominantStyle<Edge, EdgeAttributeSet>(_edges);
+    if (hoisted.edge != NULL && !EdgesOverride(*hoisted.edge, false)) {
+      hoisted.edge = NULL;
+    }
+  }
+  return hoisted;
+}
+
+static void CountAttributes(GraphStats& stats,
+  std::unordered_set<const AttributeSet*>& seen, const AttributeSet& set) {
+  if (seen.insert(&set).second) {
+    stats.numAttributeSets++;
+    stats.attributeBytes += set.GetMemoryUsage();
+  }
+}
+
+void Graph::AddStats(GraphStats& stats,
+  std::unordered_set<const AttributeSet*>& seen) const {
+  stats.numNodes += _nodes.Size();
+  stats.numEdges += _edges.Size();
+  CountAttributes(stats, seen, _defaultNodeAttributes);
+  CountAttributes(stats, seen, _defaultEdgeAttributes);
+
+  // Nodes and edges that share a style share its attribute set. Read it
+  // through a const pointer, which leaves the style shared.
+  SlotList<Node>::iterator nodeIt;
   for (nodeIt = _nodes.begin(); nodeIt != _nodes.end(); nodeIt++) {
-    out << linePrefix;
+    const Node* node = *nodeIt;
+    CountAttributes(stats, seen, node->GetAttributes());
+  }
+
+  SlotList<Edge>::iterator edgeIt;
+  for (edgeIt = _edges.begin(); edgeIt != _edges.end(); edgeIt++) {
+    const Edge* edge = *edgeIt;
+    CountAttributes(stats, seen, edge->GetAttributes());
+  }
+
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = _subgraphs.begin(); sgIt != _subgraphs.end(); sgIt++) {
+    stats.numSubgraphs++;
+    CountAttributes(stats, seen, (*sgIt)->GetAttributes());
+    (*sgIt)->AddStats(stats, seen);
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = _clusters.begin(); cIt != _clusters.end(); cIt++) {
+    stats.numClusters++;
+    CountAttributes(stats, seen, (*cIt)->GetAttributes());
+    (*cIt)->AddStats(stats, seen);
+  }
+}
+
+bool Graph::NodesOverride(const NodeAttributeSet& defaults,
+  bool covered) const {
+  covered = covered || _defaultNodeAttributes.SetsAllOf(defaults);
+
+  if (!covered) {
+    SlotList<Node>::iterator nodeIt;
+    for (nodeIt = _nodes.begin(); nodeIt != _nodes.end(); nodeIt++) {
+      const Node* node = *nodeIt;
+      if (!node->GetAttributes().SetsAllOf(defaults)) return false;
+    }
+  }
+
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = _subgraphs.begin(); sgIt != _subgraphs.end(); sgIt++) {
+    if (!(*sgIt)->NodesOverride(defaults, covered)) return false;
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = _clusters.begin(); cIt != _clusters.end(); cIt++) {
+    if (!(*cIt)->NodesOverride(defaults, covered)) return false;
+  }
+
+  return true;
+}
+
+bool Graph::EdgesOverride(const EdgeAttributeSet& defaults,
+  bool covered) const {
+  covered = covered || _defaultEdgeAttributes.SetsAllOf(defaults);
+
+  if (!covered) {
+    SlotList<Edge>::iterator edgeIt;
+    for (edgeIt = _edges.begin(); edgeIt != _edges.end(); edgeIt++) {
+      const Edge* edge = *edgeIt;
+      if (!edge->GetAttributes().SetsAllOf(defaults)) return false;
+    }
+  }
+
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = _subgraphs.begin(); sgIt != _subgraphs.end(); sgIt++) {
+    if (!(*sgIt)->EdgesOverride(defaults, covered)) return false;
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = _clusters.begin(); cIt != _clusters.end(); cIt++) {
+    if (!(*cIt)->EdgesOverride(defaults, covered)) return false;
+  }
+
+  return true;
+}
+
+void Graph::NodeChanged(const Node* node) {
+  if (_cache != NULL) _cache->MarkNodeDirty(node->_slot);
+}
+
+void Graph::EdgeChanged(const Edge* edge) {
+  if (_cache != NULL) _cache->MarkEdgeDirty(edge->_slot);
+}
+
+void Graph::AttributesChanged() {
+  if (_cache != NULL) _cache->MarkHeaderDirty();
+}
+
+void Graph::Print(std::ostream& out, const PrintOptions& options,
+  unsigned tabDepth) const {
+  OstreamDotSink sink(out);
+  Print(sink, options, tabDepth);
+}
+
+void Graph::Print(DotSink& out, const PrintOptions& options,
+  unsigned tabDepth) const {
+  HoistedStyles hoisted = ChooseHoistedStyles();
+
+  PrintStats* stats = options.stats;
+  PrintStats::Phase::e phase = PrintStats::Phase::HEADER;
+  if (stats != NULL) phase = stats->BeginGraph(out);
+
+  // The cache holds what the graph itself looks like, not what a view makes
+  // of it.
+  if (_cache != NULL && options.view == NULL) {
+    PrintCached(out, options, tabDepth, hoisted);
+  } else {
+    PrintHeader(out, options, tabDepth);
+    PrintNECS(out, options, tabDepth, hoisted);
+  }
+
+  if (stats != NULL) stats->Enter(phase, out);
+  PrintFooter(out, options, tabDepth);
+  if (stats != NULL) stats->EndGraph(out);
+}
+
+void Graph::PrintCached(DotSink& out, const PrintOptions& options,
+  unsigned tabDepth, const HoistedStyles& hoisted) const {
+  _cache->Prepare(tabDepth, options, _nodes.SlotCount(), _edges.SlotCount());
+  _cache->SetHoistedStyles(_hoistStyles, hoisted.node, hoisted.edge);
+
+  OutputCache::Fragment& header = _cache->GetHeader();
+  if (header.dirty) {
+    header.text.clear();
+    StringDotSink sink(header.text);
+    PrintHeader(sink, options, tabDepth);
+    PrintDefaults(sink, options, tabDepth, hoisted);
+    sink.Flush();
+    header.dirty = false;
+  }
+  out.Write(header.text);
+
+  EnterPhase(options, PrintStats::Phase::NODES, out);
+  PrintCachedChunks(out, options, tabDepth, hoisted, false);
+
+  // Subgraphs and clusters use their own caches.
+  EnterPhase(options, PrintStats::Phase::SUBGRAPHS, out);
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = _subgraphs.begin(); sgIt != _subgraphs.end(); sgIt++) {
+    (*sgIt)->Print(out, options, tabDepth+1);
+  }
+
+  EnterPhase(options, PrintStats::Phase::CLUSTERS, out);
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = _clusters.begin(); cIt != _clusters.end(); cIt++) {
+    (*cIt)->Print(out, options, tabDepth+1);
+  }
+
+  EnterPhase(options, PrintStats::Phase::EDGES, out);
+  PrintCachedChunks(out, options, tabDepth, hoisted, true);
+}
+
+void Graph::PrintCachedChunks(DotSink& out, const PrintOptions& options,
+  unsigned tabDepth, const HoistedStyles& hoisted, bool edges) const {
+  std::vector<OutputCache::Fragment>& chunks =
+    edges ? _cache->GetEdgeChunks() : _cache->GetNodeChunks();
+  size_t numSlots = edges ? _edges.SlotCount() : _nodes.SlotCount();
+
+  for (size_t i = 0; i < chunks.size(); i++) {
+    OutputCache::Fragment& chunk = chunks[i];
+    if (chunk.dirty) {
+      size_t begin = i * OutputCache::chunkSize;
+      size_t end = std::min(begin + OutputCache::chunkSize, numSlots);
+
+      chunk.text.clear();
+      StringDotSink sink(chunk.text);
+      if (edges) {
+        PrintEdges(sink, options, tabDepth, hoisted, begin, end);
+      } else {
+        PrintNodes(sink, options, tabDepth, hoisted, begin, end);
+      }
+      sink.Flush();
+      chunk.dirty = false;
+    }
+    out.Write(chunk.text);
+  }
+}
+
+void Graph::PrintDefaults(DotSink& out, const PrintOptions& options,
+  unsigned tabDepth, const HoistedStyles& hoisted) const {
+  unsigned indent = options.compact ? 0 : tabDepth*_tabIncrement;
+  const char* postfix = options.compact ? "]\n" : "];\n";
+
+  // Default styles. Hoisting only happens while there are none.
+  const NodeAttributeSet* nodeDefaults = hoisted.node != NULL ?
+    hoisted.node : &_defaultNodeAttributes;
+  if (!nodeDefaults->Empty()) {
+    out.Fill(_tabCharacter, indent);
+    out.Write(options.compact ? "node[" : "node [");
+    nodeDefaults->PrintWithLabel(out, "", "", options.compact ? "," : ", ",
+      options.compact);
+    out.Write(postfix);
+  }
+
+  const EdgeAttributeSet* edgeDefaults = hoisted.edge != NULL ?
+    hoisted.edge : &_defaultEdgeAttributes;
+  if (!edgeDefaults->Empty()) {
+    out.Fill(_tabCharacter, indent);
+    out.Write(options.compact ? "edge[" : "edge [");
+    edgeDefaults->PrintWithLabel(out, "", "", options.compact ? "," : ", ",
+      options.compact);
+    out.Write(postfix);
+  }
+}
+
+void Graph::PrintNodes(DotSink& out, const PrintOptions& options,
+  unsigned tabDepth, const HoistedStyles& hoisted, size_t begin,
+  size_t end) const {
+  unsigned indent = options.compact ? 0 : tabDepth*_tabIncrement;
+
+  SlotList<Node>::iterator nodeIt = _nodes.IteratorAt(begin);
+  SlotList<Node>::iterator nodeEnd = _nodes.IteratorAt(end);
+  for (; nodeIt != nodeEnd; nodeIt++) {
+    out.Fill(_tabCharacter, indent);
     Node* node = *nodeIt;
-    node->Print(out);
+    node->Print(out, options, hoisted.node);
+  }
+}
+
+void Graph::PrintEdges(DotSink& out, const PrintOptions& options,
+  unsigned tabDepth, const HoistedStyles& hoisted, size_t begin,
+  size_t end) const {
+  if (options.compact) {
+    PrintEdgeRuns(out, options, hoisted, begin, end);
+    return;
+  }
+
+  unsigned indent = tabDepth*_tabIncrement;
+
+  SlotList<Edge>::iterator edgeIt = _edges.IteratorAt(begin);
+  SlotList<Edge>::iterator edgeEnd = _edges.IteratorAt(end);
+  for (; edgeIt != edgeEnd; edgeIt++) {
+    out.Fill(_tabCharacter, indent);
+    Edge* edge = *edgeIt;
+    edge->Print(IsDigraph(), out, options, hoisted.edge);
+  }
+}
+
+/**
+ * Edges look the same if they share their attributes (or have none), and
+ * their labels match. Edges that view changes never do.
+ */
+static bool LookTheSame(const Edge* a, const Edge* b, const GraphView* view) {
+  if (view != NULL && (view->Changes(a) || view->Changes(b))) return false;
+  return &a->GetAttributes() == &b->GetAttributes() &&
+    a->GetLabel() == b->GetLabel();
+}
+
+void Graph::PrintEdgeRuns(DotSink& out, const PrintOptions& options,
+  const HoistedStyles& hoisted, size_t begin, size_t end) const {
+  const char* arrow = IsDigraph() ? "->" : "--";
+  // The current run: edges from first->_src to each of targets, either one
+  // after the other (a chain) or all from the same source (a fan-out).
+  const Edge* first = NULL;
+  std::vector<const Node*> targets;
+  bool fanOut = false;
+
+  SlotList<Edge>::iterator edgeIt = _edges.IteratorAt(begin);
+  SlotList<Edge>::iterator edgeEnd = _edges.IteratorAt(end);
+  for (;; edgeIt++) {
+    const Edge* edge = edgeIt != edgeEnd ? *edgeIt : NULL;
+
+    // Runs never cross a cache chunk boundary, so that the output does not
+    // depend on how the slots were split between PrintEdges calls (see
+    // PrintCachedChunks and ParallelPrinter).
+    if (edge != NULL && first != NULL &&
+      edge->_slot / OutputCache::chunkSize ==
+      first->_slot / OutputCache::chunkSize && _textProvider == NULL &&
+      LookTheSame(edge, first, options.view)) {
+      bool single = targets.size() == 1;
+      if ((single || !fanOut) && edge->_src == targets.back()) {
+        fanOut = false;
+        targets.push_back(edge->_dst);
+        continue;
+      }
+      if ((single || fanOut) && edge->_src == first->_src) {
+        fanOut = true;
+        targets.push_back(edge->_dst);
+        continue;
+      }
+    }
+
+    if (first != NULL) {
+      _idManager->PrintId(out, first->_src->GetIdHandle());
+      out.Write(arrow, 2);
+      if (fanOut) {
+        out.Put('{');
+        std::vector<const Node*>::iterator it;
+        for (it = targets.begin(); it != targets.end(); it++) {
+          if (it != targets.begin()) out.Put(' ');
+          _idManager->PrintId(out, (*it)->GetIdHandle());
+        }
+        out.Put('}');
+      } else {
+        std::vector<const Node*>::iterator it;
+        for (it = targets.begin(); it != targets.end(); it++) {
+          if (it != targets.begin()) out.Write(arrow, 2);
+          _idManager->PrintId(out, (*it)->GetIdHandle());
+        }
+      }
+      first->PrintAttributes(out, options, hoisted.edge);
+      out.Put('\n');
+    }
+
+    if (edge == NULL) break;
+    first = edge;
+    targets.assign(1, edge->_dst);
+    fanOut = false;
   }
+}
+
+void Graph::PrintNECS(DotSink& out, const PrintOptions& options,
+  unsigned tabDepth, const HoistedStyles& hoisted) const {
+  EnterPhase(options, PrintStats::Phase::DEFAULTS, out);
+  PrintDefaults(out, options, tabDepth, hoisted);
+
+  // Output nodes
+  EnterPhase(options, PrintStats::Phase::NODES, out);
+  PrintNodes(out, options, tabDepth, hoisted, 0, _nodes.SlotCount());
 
   // Output subgraphs.
-  std::vector<Subgraph*>::iterator sgIt;
+  EnterPhase(options, PrintStats::Phase::SUBGRAPHS, out);
+  SlotList<Subgraph>::iterator sgIt;
   for (sgIt = _subgraphs.begin(); sgIt != _subgraphs.end(); sgIt++) {
     Subgraph* sg = *sgIt;
-    sg->Print(out, tabDepth+1);
+    sg->Print(out, options, tabDepth+1);
   }
 
   // Output cluster subgraphs.
-  std::vector<Cluster*>::iterator cIt;
+  EnterPhase(options, PrintStats::Phase::CLUSTERS, out);
+  SlotList<Cluster>::iterator cIt;
   for (cIt = _clusters.begin(); cIt != _clusters.end(); cIt++) {
     Cluster* cluster = *cIt;
-    cluster->Print(out, tabDepth+1);
+    cluster->Print(out, options, tabDepth+1);
   }
 
   // Output edges. We do this *after* subgraphs and clusters, since edges
   // can connect subgraphs.
-  std::vector<Edge*>::iterator edgeIt;
-  for (edgeIt = _edges.begin(); edgeIt != _edges.end(); edgeIt++) {
-    out << linePrefix;
-    Edge* edge = *edgeIt;
-    edge->Print(IsDigraph(), out);
-  }
+  EnterPhase(options, PrintStats::Phase::EDGES, out);
+  PrintEdges(out, options, tabDepth, hoisted, 0, _edges.SlotCount());
 }
 
 }  // namespace DotWriter
@@ -9,61 +9,136 @@
 #define DOTWRITER_GRAPH_H_
 
 #include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "Arena.h"
+#include "DotSink.h"
 #include "Enums.h"
 #include "AttributeSet.h"
+#include "GraphMatcher.h"
+#include "GraphStats.h"
 #include "IdManager.h"
 #include "Idable.h"
+#include "OutputCache.h"
+#include "PrintOptions.h"
+#include "SlotList.h"
+#include "StylePool.h"
+#include "Style.h"
+#include "TextProvider.h"
 
 namespace DotWriter {
 
 class Subgraph;
 class Cluster;
+class RootGraph;
 class Edge;
 class Node;
 
 /**
  * Represents a graph. It's a bag of nodes and edges, basically.
  */
-class Graph : public Idable  {
+class Graph : public Idable<Graph>, public AttributeListener  {
 protected:
   bool _isDigraph;
   IdManager* _idManager;   // Managed by root graph.
-  // I use vector since output order matters.
+  Arena* _arena;           // Managed by root graph.
+  StylePool* _stylePool;   // Managed by root graph.
   std::string _label;
-  std::vector<Node *> _nodes;
-  std::vector<Edge *> _edges;
-  std::vector<Subgraph *> _subgraphs;
-  std::vector<Cluster *> _clusters;
+  // I use SlotList since output order matters, and removal should be cheap.
+  SlotList<Node> _nodes;
+  SlotList<Edge> _edges;
+  SlotList<Subgraph> _subgraphs;
+  SlotList<Cluster> _clusters;
+  unsigned _slot;  // Position in the parent graph's subgraph / cluster list.
   NodeAttributeSet _defaultNodeAttributes;
   EdgeAttributeSet _defaultEdgeAttributes;
+  // What this graph printed last time. NULL unless output caching is on.
+  OutputCache* _cache;
+  bool _hoistStyles;
+  // Not owned. See SetTextProvider.
+  const TextProvider* _textProvider;
   // Used as 'tab' in output DOT files.
   static const char _tabCharacter;
   // Used to determine how many _tabCharacters are printed per tab level.
   static const unsigned _tabIncrement;
 
+  /**
+   * Styles that one Print hoists into a graph's defaults (see
+   * ChooseHoistedStyles). NULL where there are none.
+   */
+  struct HoistedStyles {
+    const NodeAttributeSet* node;
+    const EdgeAttributeSet* edge;
+  };
+
+  template <typename T> friend class SlotList;
+  friend class Idable<Graph>;
+  friend class Node;
+  friend class Edge;
+
+  const IdManager& GetIdManager() const {
+    return *_idManager;
+  }
+
 public:
+  /**
+   * Elements added in one go by AddNodes / AddEdges. Only valid until the
+   * graph's nodes (or edges) next change.
+   */
+  typedef SlotRange<Node> NodeRange;
+  typedef SlotRange<Edge> EdgeRange;
+
   /**
    * Constructs a new Graph object.
+   * - idManager, arena, stylePool: Shared by every graph under the same root
+   *   graph.
    * - isDigraph: Set to 'true' if this is a directed graph.
    * - label: Text that is printed somewhere adjacent to the graph.
    * - id: Custom id (optional)
    */
-  Graph(IdManager* idManager, bool isDigraph = false, std::string label = "",
-    std::string id = "somegraph") :
-    Idable(idManager->ValidateCustomId(id)),
-    _isDigraph(isDigraph), _idManager(idManager),
-    _label(label),
+  Graph(IdManager* idManager, Arena* arena, StylePool* stylePool,
+    bool isDigraph = false, std::string label = "",
+    std::string_view id = "somegraph") :
+    Idable(idManager->CreateCustomId(id)),
+    _isDigraph(isDigraph), _idManager(idManager), _arena(arena),
+    _stylePool(stylePool), _label(std::move(label)), _slot(0),
+    _defaultNodeAttributes(NodeAttributeSet()),
+    _defaultEdgeAttributes(EdgeAttributeSet()), _cache(NULL),
+    _hoistStyles(false), _textProvider(NULL) {
+    _defaultNodeAttributes.SetListener(this);
+    _defaultEdgeAttributes.SetListener(this);
+  }
+
+  /**
+   * Same as above, but takes an id that was already created by idManager.
+   */
+  Graph(IdManager* idManager, Arena* arena, StylePool* stylePool, IdHandle id,
+    bool isDigraph, std::string label) :
+    Idable(id),
+    _isDigraph(isDigraph), _idManager(idManager), _arena(arena),
+    _stylePool(stylePool), _label(std::move(label)), _slot(0),
     _defaultNodeAttributes(NodeAttributeSet()),
-    _defaultEdgeAttributes(EdgeAttributeSet()) {
+    _defaultEdgeAttributes(EdgeAttributeSet()), _cache(NULL),
+    _hoistStyles(false), _textProvider(NULL) {
+    _defaultNodeAttributes.SetListener(this);
+    _defaultEdgeAttributes.SetListener(this);
   }
 
   virtual ~Graph();
 
+  /**
+   * Makes room for the given number of additional nodes and edges (and nodes,
+   * subgraphs or clusters with custom ids), so that adding them does not have
+   * to grow any lists along the way.
+   */
+  void Reserve(size_t nodes, size_t edges, size_t customIds = 0);
+
   /** Simple getters and setters **/
 
-  bool IsDigraph() {
+  bool IsDigraph() const {
     return _isDigraph;
   }
 
@@ -75,11 +150,20 @@ public:
     return _defaultNodeAttributes;
   }
 
+  const std::string& GetLabel() const {
+    return _label;
+  }
+
+  void SetLabel(std::string label) {
+    _label = std::move(label);
+    AttributesChanged();
+  }
+
   /**
    * Create a new subgraph on this graph.
    */
-  Subgraph* AddSubgraph(const std::string& label = "");
-  Subgraph* AddSubgraph(const std::string& label, const std::string& id);
+  Subgraph* AddSubgraph(std::string label = "");
+  Subgraph* AddSubgraph(std::string label, std::string_view id);
 
   /**
    * Remove the given subgraph from this graph.
@@ -89,8 +173,8 @@ public:
   /**
    * Create a new cluster on this graph.
    */
-  Cluster* AddCluster(const std::string& label = "");
-  Cluster* AddCluster(const std::string& label, const std::string& id);
+  Cluster* AddCluster(std::string label = "");
+  Cluster* AddCluster(std::string label, std::string_view id);
 
   /**
    * Remove the given cluster from this graph.
@@ -106,16 +190,20 @@ public:
    * Constructs a Node object with the given label, adds it to the graph, and
    * returns it.
    */
-  Node* AddNode(const std::string& label);
-  Node* AddNode(const std::string& label, const std::string& id);
+  Node* AddNode(std::string label);
+  Node* AddNode(std::string label, std::string_view id);
+
+  /**
+   * Adds count unlabelled nodes, and returns them as an array.
+   */
+  NodeRange AddNodes(size_t count);
 
   /**
-   * Removes the node from the graph.
+   * Removes the node from the graph it was added to, which may be this one
+   * or any other graph under the same root.
    *
    * Note that this function deletes the node object, and removes all edges
-   * to/from it. Also, note that it is currently more expensive than you may
-   * expect -- O(|E|).
-   * TODO(jvilk): Actually delete those edges...
+   * to/from it, whichever graph they were added to.
    */
   void RemoveNode(Node* node);
 
@@ -124,31 +212,248 @@ public:
    * manipulated to change edge properties.
    */
   Edge* AddEdge(Node* src, Node* dst);
-  Edge* AddEdge(Node* src, Node* dst, const std::string& label);
+  Edge* AddEdge(Node* src, Node* dst, std::string label);
 
   /**
-   * Removes the edge from the graph. Note that this also deletes the GEdge
-   * object.
+   * Adds an edge for each (source, destination) pair, and returns them as an
+   * array. If attributes (or style) is given, every new edge shares a style
+   * with those attributes.
+   */
+  EdgeRange AddEdges(const std::pair<Node*, Node*>* pairs, size_t count,
+    const EdgeAttributeSet* attributes = NULL);
+  EdgeRange AddEdges(const std::vector<std::pair<Node*, Node*> >& pairs,
+    const EdgeAttributeSet* attributes = NULL);
+  EdgeRange AddEdges(const std::pair<Node*, Node*>* pairs, size_t count,
+    const SharedEdgeStyle& style);
+
+  /**
+   * Removes the edge from the graph it was added to. Note that this also
+   * deletes the GEdge object.
    */
   void RemoveEdge(Edge* edge);
 
   /**
-   * Removes any edges from src to dst from the graph. Note that this version
-   * of the function is currently O(|E|).
+   * Removes any edges from src to dst from the graph. This only looks at the
+   * edges leaving src (and, for undirected graphs, those leaving dst).
    *
    * If this is not a digraph, then removeEdge(src, dst) has the same semantics
    * as removeEdge(dst, src).
-   * TODO(jvilk): Implement.
    */
-  //void RemoveEdge(Node* src, Node* dst);
+  void RemoveEdge(Node* src, Node* dst);
+
+  /**
+   * Adds everything in other to this graph: its nodes, edges, subgraphs and
+   * clusters, with their labels and attributes. Styles are shared with
+   * other rather than copied (see Node::SetStyle). This graph's own label,
+   * attributes and defaults stay as they are.
+   *
+   * Elements with generated ids get new ids of their own, as the numbers
+   * mean nothing outside of other. policy decides what happens to custom
+   * ids that are already in use under this graph's root; only elements
+   * inside this graph are unified with. Edges are always added, even if the
+   * same edge is already here. Merging a graph into itself, or into one of
+   * its subgraphs, does nothing.
+   */
+  void Merge(const RootGraph& other,
+    MergePolicy::e policy = MergePolicy::UNIFY);
+
+  /**
+   * Removing elements leaves holes behind that are only reclaimed once they
+   * outnumber the remaining elements. Call this after removing many elements
+   * to give the space back right away. Covers subgraphs and clusters too.
+   */
+  void Compact();
+
+  /**
+   * Roughly how many bytes Print(out, tabDepth) will produce, judging by the
+   * number of elements, attributes and label lengths. Used to reserve space
+   * for output files.
+   */
+  size_t EstimateOutputSize(unsigned tabDepth) const;
+
+  /**
+   * When enabled, the graph keeps what it printed last time, and the next
+   * Print (or WriteToFile) only re-renders the pieces affected by changes
+   * made since: nodes and edges in runs of OutputCache::chunkSize, plus each
+   * graph's own attributes. This costs about as much memory as the output.
+   * Covers subgraphs and clusters too, including ones added later. Off by
+   * default.
+   *
+   * A graph with caching on must not be printed from several threads at
+   * once. PrintParallel ignores the cache.
+   */
+  void SetOutputCaching(bool enabled);
+
+  /**
+   * When enabled, Print looks for the style (see Node::SetStyle) shared by
+   * the most nodes of this graph, and prints it once as the graph's
+   * 'node [...]' defaults instead of on every one of those nodes. Edges get
+   * the same treatment. A style is only hoisted if the graph has no defaults
+   * of its own, and if every other node (or edge) in the graph and its
+   * subgraphs sets all of the style's attributes itself, so that the output
+   * still describes the same graph. Covers subgraphs and clusters too,
+   * including ones added later. Off by default.
+   *
+   * The styles are chosen afresh by every Print, and nothing about them is
+   * kept in the graph, so a graph that hoists can still be printed from
+   * several threads at once (as long as it does not cache its output).
+   */
+  void SetStyleHoisting(bool enabled);
+
+  /**
+   * From now on, provider adds to the attributes of this graph's nodes and
+   * edges whenever they are printed (see TextProvider). NULL (the default)
+   * turns this back off. The provider is not owned by the graph, and must
+   * live until it is replaced or the graph is destroyed. Covers subgraphs
+   * and clusters too, including ones added later.
+   *
+   * Output caching keeps what the provider said; setting the provider again
+   * makes the next Print ask it for everything anew. Combining edges into
+   * chains (see PrintOptions::compact) is off while there is a provider, as
+   * it cannot tell what the edges will look like.
+   */
+  void SetTextProvider(const TextProvider* provider);
+
+  const TextProvider* GetTextProvider() const {
+    return _textProvider;
+  }
+
+  /**
+   * Prints the graph in the DOT format. Printing does not change the graph,
+   * so the same graph can be printed any number of times.
+   */
+  virtual void Print(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth) const;
+  void Print(std::ostream& out, const PrintOptions& options,
+    unsigned tabDepth) const;
 
-  virtual void Print(std::ostream& out, unsigned tabDepth) = 0;
+  /**
+   * Same as above, with the default options.
+   */
+  void Print(DotSink& out, unsigned tabDepth) const {
+    Print(out, PrintOptions(), tabDepth);
+  }
+  void Print(std::ostream& out, unsigned tabDepth) const {
+    Print(out, PrintOptions(), tabDepth);
+  }
 
 protected:
+  /**
+   * Destructs every node, edge, subgraph and cluster in this graph. Their
+   * memory goes back to the arena.
+   */
+  void DestroyContents();
+
+  /**
+   * Takes every edge in this graph and its subgraphs off the edge lists of
+   * its endpoints, and removes edges in other graphs that touch nodes in this
+   * one. Afterwards the graph can be destroyed without leaving dangling edges
+   * behind.
+   */
+  void UnlinkContents();
+
+  /**
+   * Removes every edge to/from the node.
+   */
+  static void RemoveIncidentEdges(Node* node);
+
+  /**
+   * Mark the cached output of an element of this graph, or of the graph's own
+   * attributes, as stale.
+   */
+  void NodeChanged(const Node* node);
+  void EdgeChanged(const Edge* edge);
+  virtual void AttributesChanged();
+
+  /**
+   * Adds up what this graph and everything inside of it holds (see
+   * GraphStats). Attribute sets are only counted the first time they are
+   * seen.
+   */
+  void AddStats(GraphStats& stats,
+    std::unordered_set<const AttributeSet*>& seen) const;
+
+  /**
+   * Returns the styles, if any, that a Print would hoist into this graph's
+   * defaults right now (see SetStyleHoisting).
+   */
+  HoistedStyles ChooseHoistedStyles() const;
+
+  /**
+   * Returns true if every node (edge) in this graph and its subgraphs sets
+   * all of the attributes in defaults, or is in a graph whose own defaults
+   * do. covered says whether an enclosing graph's defaults already do.
+   */
+  bool NodesOverride(const NodeAttributeSet& defaults, bool covered) const;
+  bool EdgesOverride(const EdgeAttributeSet& defaults, bool covered) const;
+
+  /**
+   * Same as PrintHeader followed by PrintNECS, but reuses what is in _cache
+   * where it is still valid.
+   */
+  void PrintCached(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth, const HoistedStyles& hoisted) const;
+
+  /**
+   * Prints nodes (or edges, when edges is true) one cached chunk at a time,
+   * re-rendering dirty chunks first.
+   */
+  void PrintCachedChunks(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth, const HoistedStyles& hoisted, bool edges) const;
+
+  /**
+   * Prints the line that opens the graph, followed by the graph's own
+   * attributes.
+   */
+  virtual void PrintHeader(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth) const = 0;
+
+  /**
+   * Prints the closing brace.
+   */
+  virtual void PrintFooter(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth) const = 0;
+
+  /**
+   * Tells options.stats, if any, that printing has moved on to phase.
+   */
+  static void EnterPhase(const PrintOptions& options,
+    PrintStats::Phase::e phase, const DotSink& out) {
+    if (options.stats != NULL) options.stats->Enter(phase, out);
+  }
+
   /**
    * Prints nodes, edges, cluster subgraphs, and subgraphs.
    */
-  void PrintNECS(std::ostream& out, unsigned tabDepth);
+  void PrintNECS(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth, const HoistedStyles& hoisted) const;
+
+  /**
+   * The pieces of PrintNECS, with hoisted from ChooseHoistedStyles.
+   * PrintNodes and PrintEdges only print the elements in slots [begin, end)
+   * (see SlotList::IteratorAt).
+   */
+  void PrintDefaults(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth, const HoistedStyles& hoisted) const;
+  void PrintNodes(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth, const HoistedStyles& hoisted, size_t begin,
+    size_t end) const;
+  void PrintEdges(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth, const HoistedStyles& hoisted, size_t begin,
+    size_t end) const;
+
+  /**
+   * PrintEdges for compact output: runs of consecutive edges that look the
+   * same become one chain (a->b->c) or fan-out (a->{b c}) statement.
+   */
+  void PrintEdgeRuns(DotSink& out, const PrintOptions& options,
+    const HoistedStyles& hoisted, size_t begin, size_t end) const;
+
+  friend class DetailReducer;
+  friend class GraphMatcher;
+  friend class GraphvizRenderer;
+  friend class ParallelPrinter;
+  friend class Snapshot;
 };
 
 
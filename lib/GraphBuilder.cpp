@@ -0,0 +1,102 @@
+#include "GraphBuilder.h"
+
+#include "Cluster.h"
+#include "Node.h"
+#include "RootGraph.h"
+#include "Subgraph.h"
+
+namespace DotWriter {
+
+GraphBuilder::GraphBuilder(unsigned index, bool isDigraph,
+  IdRegistry* registry) :
+  _index(index), _isDigraph(isDigraph), _registry(registry),
+  _graph(new RootGraph(isDigraph)), _idArena(new Arena()), _numShared(0) {
+}
+
+GraphBuilder::~GraphBuilder() {
+  delete _graph;
+  delete _idArena;
+}
+
+template <typename T>
+void GraphBuilder::Register(const Idable<T>& element) {
+  _id.clear();
+  element.AppendId(_id);
+  if (_registry->Register(_id, _index, *_idArena) != _index) _numShared++;
+}
+
+void GraphBuilder::Reset() {
+  delete _graph;
+  delete _idArena;
+  _graph = new RootGraph(_isDigraph);
+  _idArena = new Arena();
+  _numShared = 0;
+}
+
+Node* GraphBuilder::AddNode(Graph& graph, std::string label,
+  std::string_view id) {
+  Node* node = graph.AddNode(std::move(label), id);
+  Register(*node);
+  return node;
+}
+
+Subgraph* GraphBuilder::AddSubgraph(Graph& graph, std::string label,
+  std::string_view id) {
+  Subgraph* sg = graph.AddSubgraph(std::move(label), id);
+  Register(*sg);
+  return sg;
+}
+
+Cluster* GraphBuilder::AddCluster(Graph& graph, std::string label,
+  std::string_view id) {
+  Cluster* cluster = graph.AddCluster(std::move(label), id);
+  Register(*cluster);
+  return cluster;
+}
+
+unsigned GraphBuilder::GetOwner(std::string_view id) const {
+  return _registry->Find(id);
+}
+
+ShardedGraphBuilder::ShardedGraphBuilder(unsigned numShards, bool isDigraph,
+  size_t expectedIds) :
+  _registry(expectedIds) {
+  for (unsigned i = 0; i < numShards; i++) {
+    _shards.push_back(new GraphBuilder(i, isDigraph, &_registry));
+  }
+}
+
+ShardedGraphBuilder::~ShardedGraphBuilder() {
+  std::vector<GraphBuilder*>::iterator it;
+  for (it = _shards.begin(); it != _shards.end(); it++) {
+    delete *it;
+  }
+}
+
+size_t ShardedGraphBuilder::NumSharedIds() const {
+  size_t numShared = 0;
+  std::vector<GraphBuilder*>::const_iterator it;
+  for (it = _shards.begin(); it != _shards.end(); it++) {
+    numShared += (*it)->NumSharedIds();
+  }
+  return numShared;
+}
+
+void ShardedGraphBuilder::MergeInto(Graph& target, MergePolicy::e policy) {
+  // One merge for all of the shards, so that unifying ids only indexes the
+  // target once.
+  std::vector<const RootGraph*> graphs;
+  std::vector<GraphBuilder*>::iterator it;
+  for (it = _shards.begin(); it != _shards.end(); it++) {
+    graphs.push_back(&(*it)->GetGraph());
+  }
+  GraphMatcher::Merge(target, graphs, policy);
+
+  // The registry's records live in the shards' arenas.
+  _registry.Clear();
+  for (it = _shards.begin(); it != _shards.end(); it++) {
+    (*it)->Reset();
+  }
+}
+
+}  // namespace DotWriter
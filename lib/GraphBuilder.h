@@ -0,0 +1,162 @@
+/**
+ * Builds one graph on many threads at once.
+ *
+ * A graph must only be changed by one thread at a time. Instead of sharing
+ * one, each thread builds its part of the graph in a shard of its own: a
+ * GraphBuilder, with its own RootGraph, and so its own ids and arena. When
+ * every thread is done, ShardedGraphBuilder::MergeInto merges the shards
+ * into the real graph, one after the other in shard order, so the result
+ * does not depend on how the threads happened to be scheduled.
+ *
+ * Custom ids are what ties the shards together. Each shard registers the
+ * custom ids it uses in a registry that all shards share (see IdRegistry),
+ * which finds ids that several shards use as they are added, without
+ * locking. When merging with MergePolicy::UNIFY, such an id means the same
+ * node in every shard, so a shard can make edges to another shard's nodes
+ * by creating a node with the same id. The lowest-numbered shard's copy is
+ * the one that keeps its label, attributes and graph. With
+ * MergePolicy::RENAME, every shard but that one has its copy renamed.
+ */
+
+#ifndef DOTWRITER_GRAPHBUILDER_H_
+#define DOTWRITER_GRAPHBUILDER_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Arena.h"
+#include "GraphMatcher.h"
+#include "IdRegistry.h"
+
+namespace DotWriter {
+
+class Cluster;
+class Graph;
+template <typename T> class Idable;
+class Node;
+class RootGraph;
+class Subgraph;
+
+class GraphBuilder {
+private:
+  unsigned _index;
+  bool _isDigraph;
+  IdRegistry* _registry;
+  RootGraph* _graph;
+  // Holds this shard's records in _registry.
+  Arena* _idArena;
+  size_t _numShared;
+  std::string _id;
+
+  friend class ShardedGraphBuilder;
+
+  GraphBuilder(unsigned index, bool isDigraph, IdRegistry* registry);
+
+  /**
+   * Registers the id that element ended up with.
+   */
+  template <typename T>
+  void Register(const Idable<T>& element);
+
+  /**
+   * Starts over with an empty graph. The registry must be cleared too.
+   */
+  void Reset();
+
+  // Not copyable.
+  GraphBuilder(const GraphBuilder&);
+  GraphBuilder& operator=(const GraphBuilder&);
+
+public:
+  virtual ~GraphBuilder();
+
+  /**
+   * Position of this shard among the shards of its ShardedGraphBuilder.
+   */
+  unsigned GetIndex() const {
+    return _index;
+  }
+
+  /**
+   * The shard's own graph. Anything can be added to it directly, except for
+   * elements with custom ids, which must be added through the functions
+   * below for the other shards to know about them. Generated ids are only
+   * unique within the shard, and are replaced when merging.
+   */
+  RootGraph& GetGraph() {
+    return *_graph;
+  }
+
+  /**
+   * Same as Graph::AddNode, AddSubgraph and AddCluster with a custom id.
+   * graph must be the shard's graph, or inside of it.
+   */
+  Node* AddNode(Graph& graph, std::string label, std::string_view id);
+  Subgraph* AddSubgraph(Graph& graph, std::string label,
+    std::string_view id);
+  Cluster* AddCluster(Graph& graph, std::string label, std::string_view id);
+
+  /**
+   * Returns the shard that registered id first, or IdRegistry::none. When
+   * several shards add the same id at once, which one comes first depends
+   * on timing.
+   */
+  unsigned GetOwner(std::string_view id) const;
+
+  /**
+   * Number of custom ids this shard added that another shard (or this one)
+   * had already registered.
+   */
+  size_t NumSharedIds() const {
+    return _numShared;
+  }
+};
+
+class ShardedGraphBuilder {
+private:
+  IdRegistry _registry;
+  std::vector<GraphBuilder*> _shards;
+
+  // Not copyable.
+  ShardedGraphBuilder(const ShardedGraphBuilder&);
+  ShardedGraphBuilder& operator=(const ShardedGraphBuilder&);
+
+public:
+  /**
+   * - numShards: Typically one per thread.
+   * - expectedIds: Roughly how many custom ids all of the shards will add
+   *   between them; sizes the registry.
+   */
+  ShardedGraphBuilder(unsigned numShards, bool isDigraph = false,
+    size_t expectedIds = 1 << 16);
+  virtual ~ShardedGraphBuilder();
+
+  unsigned NumShards() const {
+    return _shards.size();
+  }
+
+  /**
+   * Each shard must only be used by one thread at a time. Different shards
+   * can be used by different threads at the same time.
+   */
+  GraphBuilder& GetShard(unsigned index) {
+    return *_shards[index];
+  }
+
+  /**
+   * Total of GraphBuilder::NumSharedIds over every shard.
+   */
+  size_t NumSharedIds() const;
+
+  /**
+   * Merges every shard into target in shard order (see Graph::Merge), and
+   * then empties the shards, so they can be used for more. Must not run
+   * while any shard is in use.
+   */
+  void MergeInto(Graph& target, MergePolicy::e policy = MergePolicy::UNIFY);
+};
+
+}  // namespace DotWriter
+
+#endif
@@ -0,0 +1,363 @@
+#include "GraphMatcher.h"
+
+#include <functional>
+
+#include "Cluster.h"
+#include "Edge.h"
+#include "Node.h"
+#include "RootGraph.h"
+#include "Subgraph.h"
+
+namespace DotWriter {
+
+static const size_t none = static_cast<size_t>(-1);
+
+/**
+ * The endpoints of an edge, in a fixed order for undirected graphs.
+ */
+typedef std::pair<const Node*, const Node*> NodePair;
+
+struct NodePairHash {
+  size_t operator()(const NodePair& pair) const {
+    std::hash<const Node*> hash;
+    return hash(pair.first) * 31 + hash(pair.second);
+  }
+};
+
+static NodePair MakeNodePair(const Node* src, const Node* dst,
+  bool isDigraph) {
+  if (!isDigraph && std::less<const Node*>()(dst, src)) {
+    return NodePair(dst, src);
+  }
+  return NodePair(src, dst);
+}
+
+GraphMatcher::GraphMatcher(const IdManager* intoIds, MergePolicy::e policy) :
+  _policy(policy), _fromIds(NULL), _intoIds(intoIds) {
+}
+
+void GraphMatcher::IndexGraph(Graph* graph) {
+  SlotList<Node>::iterator nodeIt;
+  for (nodeIt = graph->_nodes.begin(); nodeIt != graph->_nodes.end();
+    nodeIt++) {
+    IdHandle id = (*nodeIt)->GetIdHandle();
+    if (!IdManager::IsGeneratedId(id)) _nodes[id] = *nodeIt;
+  }
+
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = graph->_subgraphs.begin(); sgIt != graph->_subgraphs.end();
+    sgIt++) {
+    IdHandle id = (*sgIt)->GetIdHandle();
+    ChildGraph child = { *sgIt, graph };
+    if (!IdManager::IsGeneratedId(id)) _subgraphs[id] = child;
+    IndexGraph(*sgIt);
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = graph->_clusters.begin(); cIt != graph->_clusters.end(); cIt++) {
+    IdHandle id = (*cIt)->GetIdHandle();
+    ChildGraph child = { *cIt, graph };
+    if (!IdManager::IsGeneratedId(id)) _clusters[id] = child;
+    IndexGraph(*cIt);
+  }
+}
+
+Node* GraphMatcher::FindNode(IdHandle id) {
+  _id.clear();
+  _fromIds->AppendId(_id, id);
+  if (_policy != MergePolicy::UNIFY) return NULL;
+
+  IdHandle intoId;
+  if (!_intoIds->FindId(_id, &intoId)) return NULL;
+  std::unordered_map<IdHandle, Node*>::const_iterator it =
+    _nodes.find(intoId);
+  return it != _nodes.end() ? it->second : NULL;
+}
+
+Graph* GraphMatcher::FindChild(
+  const std::unordered_map<IdHandle, ChildGraph>& children, IdHandle id,
+  const Graph* parent) {
+  _id.clear();
+  _fromIds->AppendId(_id, id);
+  if (_policy != MergePolicy::UNIFY) return NULL;
+
+  IdHandle intoId;
+  if (!_intoIds->FindId(_id, &intoId)) return NULL;
+  std::unordered_map<IdHandle, ChildGraph>::const_iterator it =
+    children.find(intoId);
+  if (it == children.end() || it->second.parent != parent) return NULL;
+  return it->second.graph;
+}
+
+void GraphMatcher::MergeContents(const Graph* from, Graph* into) {
+  _graphPairs.push_back(std::make_pair(from, into));
+  into->Reserve(from->_nodes.Size(), from->_edges.Size(),
+    from->_nodes.Size());
+
+  SlotList<Node>::iterator nodeIt;
+  for (nodeIt = from->_nodes.begin(); nodeIt != from->_nodes.end();
+    nodeIt++) {
+    const Node* node = *nodeIt;
+    IdHandle id = node->GetIdHandle();
+    Node* merged;
+    if (IdManager::IsGeneratedId(id)) {
+      merged = into->AddNode(node->GetLabel());
+      merged->SetStyle(node->GetStyle());
+    } else {
+      merged = FindNode(id);
+      if (merged == NULL) {
+        merged = into->AddNode(node->GetLabel(), _id);
+        merged->SetStyle(node->GetStyle());
+        if (_policy == MergePolicy::UNIFY) {
+          _nodes[merged->GetIdHandle()] = merged;
+        }
+      }
+    }
+    _mergedNodes[node] = merged;
+  }
+
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = from->_subgraphs.begin(); sgIt != from->_subgraphs.end();
+    sgIt++) {
+    const Subgraph* sg = *sgIt;
+    IdHandle id = sg->GetIdHandle();
+    Graph* merged = NULL;
+    if (!IdManager::IsGeneratedId(id)) {
+      merged = FindChild(_subgraphs, id, into);
+    }
+    if (merged == NULL) {
+      Subgraph* added = IdManager::IsGeneratedId(id) ?
+        into->AddSubgraph(sg->GetLabel()) :
+        into->AddSubgraph(sg->GetLabel(), _id);
+      added->GetAttributes() = sg->GetAttributes();
+      added->GetDefaultNodeAttributes() = sg->_defaultNodeAttributes;
+      added->GetDefaultEdgeAttributes() = sg->_defaultEdgeAttributes;
+      if (_policy == MergePolicy::UNIFY) {
+        ChildGraph child = { added, into };
+        _subgraphs[added->GetIdHandle()] = child;
+      }
+      merged = added;
+    }
+    MergeContents(sg, merged);
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = from->_clusters.begin(); cIt != from->_clusters.end(); cIt++) {
+    const Cluster* cluster = *cIt;
+    IdHandle id = cluster->GetIdHandle();
+    Graph* merged = NULL;
+    if (!IdManager::IsGeneratedId(id)) {
+      merged = FindChild(_clusters, id, into);
+    }
+    if (merged == NULL) {
+      Cluster* added = IdManager::IsGeneratedId(id) ?
+        into->AddCluster(cluster->GetLabel()) :
+        into->AddCluster(cluster->GetLabel(), _id);
+      added->GetAttributes() = cluster->GetAttributes();
+      added->GetDefaultNodeAttributes() = cluster->_defaultNodeAttributes;
+      added->GetDefaultEdgeAttributes() = cluster->_defaultEdgeAttributes;
+      if (_policy == MergePolicy::UNIFY) {
+        ChildGraph child = { added, into };
+        _clusters[added->GetIdHandle()] = child;
+      }
+      merged = added;
+    }
+    MergeContents(cluster, merged);
+  }
+}
+
+void GraphMatcher::MergeEdges() {
+  GraphPairs::const_iterator it;
+  for (it = _graphPairs.begin(); it != _graphPairs.end(); it++) {
+    const Graph* from = it->first;
+    Graph* into = it->second;
+
+    SlotList<Edge>::iterator edgeIt;
+    for (edgeIt = from->_edges.begin(); edgeIt != from->_edges.end();
+      edgeIt++) {
+      const Edge* edge = *edgeIt;
+      Edge* merged = into->AddEdge(_mergedNodes[edge->GetSource()],
+        _mergedNodes[edge->GetDest()], edge->GetLabel());
+      merged->SetStyle(edge->GetStyle());
+    }
+  }
+}
+
+void GraphMatcher::MergeGraph(const RootGraph& from, Graph& into) {
+  // Merging a graph into itself would never run out of elements to copy.
+  // Graphs under the same root share their IdManager.
+  if (into._idManager == from._idManager) return;
+
+  _fromIds = from._idManager;
+  _mergedNodes.clear();
+  _mergedNodes.reserve(from._nodes.Size());
+  _graphPairs.clear();
+  MergeContents(&from, &into);
+  MergeEdges();
+}
+
+void GraphMatcher::Merge(Graph& into,
+  const std::vector<const RootGraph*>& from, MergePolicy::e policy) {
+  GraphMatcher matcher(into._idManager, policy);
+  if (policy == MergePolicy::UNIFY) matcher.IndexGraph(&into);
+
+  std::vector<const RootGraph*>::const_iterator it;
+  for (it = from.begin(); it != from.end(); it++) {
+    matcher.MergeGraph(**it, into);
+  }
+}
+
+void GraphMatcher::ListGraphs(const Graph* graph, bool isRoot,
+  std::vector<const Graph*>& graphs, std::vector<std::string>& ids) {
+  graphs.push_back(graph);
+  ids.push_back(std::string());
+  if (!isRoot) graph->_idManager->AppendId(ids.back(), graph->GetIdHandle());
+
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = graph->_subgraphs.begin(); sgIt != graph->_subgraphs.end();
+    sgIt++) {
+    ListGraphs(*sgIt, false, graphs, ids);
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = graph->_clusters.begin(); cIt != graph->_clusters.end(); cIt++) {
+    ListGraphs(*cIt, false, graphs, ids);
+  }
+}
+
+GraphDiff GraphMatcher::Diff(const RootGraph& a, const RootGraph& b) {
+  GraphDiff diff;
+
+  std::vector<const Graph*> aGraphs, bGraphs;
+  std::vector<std::string> aGraphIds, bGraphIds;
+  ListGraphs(&a, true, aGraphs, aGraphIds);
+  ListGraphs(&b, true, bGraphs, bGraphIds);
+
+  // a's nodes, in order, and an index of them by id.
+  struct NodeEntry {
+    const Node* node;
+    unsigned graph;
+    bool matched;
+  };
+  std::vector<NodeEntry> aNodes;
+  std::unordered_map<IdHandle, size_t> aNodeIndex;
+  for (unsigned i = 0; i < aGraphs.size(); i++) {
+    SlotList<Node>::iterator nodeIt;
+    for (nodeIt = aGraphs[i]->_nodes.begin();
+      nodeIt != aGraphs[i]->_nodes.end(); nodeIt++) {
+      NodeEntry entry = { *nodeIt, i, false };
+      aNodeIndex[entry.node->GetIdHandle()] = aNodes.size();
+      aNodes.push_back(entry);
+    }
+  }
+
+  // b's nodes, matched up with a's through a's ids.
+  std::unordered_map<const Node*, const Node*> matchedNodes;
+  matchedNodes.reserve(aNodes.size());
+  std::string id;
+  for (unsigned i = 0; i < bGraphs.size(); i++) {
+    SlotList<Node>::iterator nodeIt;
+    for (nodeIt = bGraphs[i]->_nodes.begin();
+      nodeIt != bGraphs[i]->_nodes.end(); nodeIt++) {
+      const Node* node = *nodeIt;
+      id.clear();
+      b._idManager->AppendId(id, node->GetIdHandle());
+
+      IdHandle aId;
+      std::unordered_map<IdHandle, size_t>::const_iterator found;
+      if (!a._idManager->FindId(id, &aId) ||
+        (found = aNodeIndex.find(aId)) == aNodeIndex.end()) {
+        diff.addedNodes.push_back(node);
+        continue;
+      }
+
+      NodeEntry& entry = aNodes[found->second];
+      entry.matched = true;
+      matchedNodes[node] = entry.node;
+      if (entry.node->GetLabel() != node->GetLabel() ||
+        entry.node->GetAttributes() != node->GetAttributes() ||
+        aGraphIds[entry.graph] != bGraphIds[i]) {
+        diff.changedNodes.push_back(std::make_pair(entry.node, node));
+      }
+    }
+  }
+
+  std::vector<NodeEntry>::const_iterator entryIt;
+  for (entryIt = aNodes.begin(); entryIt != aNodes.end(); entryIt++) {
+    if (!entryIt->matched) diff.removedNodes.push_back(entryIt->node);
+  }
+
+  // a's edges, in order, chained together by endpoints, so that parallel
+  // edges are matched in order.
+  struct EdgeEntry {
+    const Edge* edge;
+    unsigned graph;
+    size_t next;
+    bool matched;
+  };
+  // The first and last edge of a chain that have not been matched yet.
+  struct Chain {
+    size_t head;
+    size_t tail;
+  };
+  bool isDigraph = a.IsDigraph();
+  std::vector<EdgeEntry> aEdges;
+  std::unordered_map<NodePair, Chain, NodePairHash> chains;
+  for (unsigned i = 0; i < aGraphs.size(); i++) {
+    SlotList<Edge>::iterator edgeIt;
+    for (edgeIt = aGraphs[i]->_edges.begin();
+      edgeIt != aGraphs[i]->_edges.end(); edgeIt++) {
+      const Edge* edge = *edgeIt;
+      EdgeEntry entry = { edge, i, none, false };
+      NodePair key = MakeNodePair(edge->GetSource(), edge->GetDest(),
+        isDigraph);
+      std::pair<std::unordered_map<NodePair, Chain, NodePairHash>::iterator,
+        bool> inserted = chains.insert(std::make_pair(key, Chain()));
+      if (inserted.second) {
+        inserted.first->second.head = aEdges.size();
+      } else {
+        aEdges[inserted.first->second.tail].next = aEdges.size();
+      }
+      inserted.first->second.tail = aEdges.size();
+      aEdges.push_back(entry);
+    }
+  }
+
+  for (unsigned i = 0; i < bGraphs.size(); i++) {
+    SlotList<Edge>::iterator edgeIt;
+    for (edgeIt = bGraphs[i]->_edges.begin();
+      edgeIt != bGraphs[i]->_edges.end(); edgeIt++) {
+      const Edge* edge = *edgeIt;
+      std::unordered_map<const Node*, const Node*>::const_iterator src =
+        matchedNodes.find(edge->GetSource());
+      std::unordered_map<const Node*, const Node*>::const_iterator dst =
+        matchedNodes.find(edge->GetDest());
+      std::unordered_map<NodePair, Chain, NodePairHash>::iterator chain;
+      if (src == matchedNodes.end() || dst == matchedNodes.end() ||
+        (chain = chains.find(MakeNodePair(src->second, dst->second,
+        isDigraph))) == chains.end() || chain->second.head == none) {
+        diff.addedEdges.push_back(edge);
+        continue;
+      }
+
+      EdgeEntry& entry = aEdges[chain->second.head];
+      chain->second.head = entry.next;
+      entry.matched = true;
+      if (entry.edge->GetLabel() != edge->GetLabel() ||
+        entry.edge->GetAttributes() != edge->GetAttributes() ||
+        aGraphIds[entry.graph] != bGraphIds[i]) {
+        diff.changedEdges.push_back(std::make_pair(entry.edge, edge));
+      }
+    }
+  }
+
+  std::vector<EdgeEntry>::const_iterator edgeEntryIt;
+  for (edgeEntryIt = aEdges.begin(); edgeEntryIt != aEdges.end();
+    edgeEntryIt++) {
+    if (!edgeEntryIt->matched) diff.removedEdges.push_back(edgeEntryIt->edge);
+  }
+
+  return diff;
+}
+
+}  // namespace DotWriter
@@ -0,0 +1,140 @@
+/**
+ * Matches up the elements of two graphs by id, to merge one graph into
+ * another or to compare them (see Graph::Merge and RootGraph::Diff).
+ *
+ * Ids are looked up through the IdManager's hash table (see
+ * IdManager::FindId), and elements through hash maps keyed by id handle or
+ * by pointer, so both take time linear in the size of the graphs.
+ */
+
+#ifndef DOTWRITER_GRAPHMATCHER_H_
+#define DOTWRITER_GRAPHMATCHER_H_
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "IdManager.h"
+
+namespace DotWriter {
+
+class Cluster;
+class Edge;
+class Graph;
+class Node;
+class RootGraph;
+class Subgraph;
+
+/**
+ * What Graph::Merge does with a custom id that the graph being merged
+ * into already has.
+ */
+struct MergePolicy {
+  enum e {
+    // A node with the id, or a subgraph or cluster with the id in the same
+    // parent graph, is the same element: it keeps its label and attributes,
+    // and picks up the merged graph's edges and contents.
+    UNIFY,
+    // Every element is added as a new one, and ids already in use get a
+    // number appended, as IdManager::ValidateCustomId does.
+    RENAME
+  };
+};
+
+/**
+ * What changed from one graph (a) to another (b). Nodes are matched by id;
+ * edges by the ids of their endpoints (in either order, for undirected
+ * graphs), and parallel edges in the order they were added.
+ *
+ * An element has changed if its label, attributes or the id of its graph
+ * differ; the root graph counts as the same graph whatever its id. Styles
+ * that are shared do not count as changes if their attributes are equal.
+ *
+ * Points into both graphs, so only valid while neither of them changes.
+ */
+struct GraphDiff {
+  std::vector<const Node*> addedNodes;    // Only in b.
+  std::vector<const Node*> removedNodes;  // Only in a.
+  // Pairs of (a's node, b's node) with the same id.
+  std::vector<std::pair<const Node*, const Node*> > changedNodes;
+
+  std::vector<const Edge*> addedEdges;
+  std::vector<const Edge*> removedEdges;
+  std::vector<std::pair<const Edge*, const Edge*> > changedEdges;
+
+  bool Empty() const {
+    return addedNodes.empty() && removedNodes.empty() &&
+      changedNodes.empty() && addedEdges.empty() && removedEdges.empty() &&
+      changedEdges.empty();
+  }
+};
+
+class GraphMatcher {
+private:
+  // A graph of the graph being merged, and the graph its contents go into.
+  typedef std::vector<std::pair<const Graph*, Graph*> > GraphPairs;
+
+  /**
+   * A subgraph or cluster of the graph being merged into, and the graph it
+   * is directly inside of.
+   */
+  struct ChildGraph {
+    Graph* graph;
+    const Graph* parent;
+  };
+
+  MergePolicy::e _policy;
+  const IdManager* _fromIds;
+  const IdManager* _intoIds;
+  // The elements with custom ids of the graph being merged into, for UNIFY,
+  // including the ones merged into it so far.
+  std::unordered_map<IdHandle, Node*> _nodes;
+  std::unordered_map<IdHandle, ChildGraph> _subgraphs;
+  std::unordered_map<IdHandle, ChildGraph> _clusters;
+  // Where each node of the graph being merged ended up.
+  std::unordered_map<const Node*, Node*> _mergedNodes;
+  GraphPairs _graphPairs;
+  std::string _id;
+
+  GraphMatcher(const IdManager* intoIds, MergePolicy::e policy);
+
+  void IndexGraph(Graph* graph);
+  void MergeGraph(const RootGraph& from, Graph& into);
+
+  /**
+   * Returns the element of the graph being merged into that the element
+   * with the given id unifies with, or NULL. The id's text is left in _id.
+   */
+  Node* FindNode(IdHandle id);
+  Graph* FindChild(const std::unordered_map<IdHandle, ChildGraph>& children,
+    IdHandle id, const Graph* parent);
+
+  /**
+   * Adds the nodes, subgraphs and clusters of from to into, recursively.
+   * Edges come afterwards (see MergeEdges), once every node exists.
+   */
+  void MergeContents(const Graph* from, Graph* into);
+  void MergeEdges();
+
+  /**
+   * Lists graph and everything inside of it, in print order, along with the
+   * id of each (empty for the root graph).
+   */
+  static void ListGraphs(const Graph* graph, bool isRoot,
+    std::vector<const Graph*>& graphs, std::vector<std::string>& ids);
+
+public:
+  /**
+   * Adds everything in each graph of from to into, in order (see
+   * Graph::Merge). Later graphs unify with what earlier ones added.
+   */
+  static void Merge(Graph& into, const std::vector<const RootGraph*>& from,
+    MergePolicy::e policy);
+
+  static GraphDiff Diff(const RootGraph& a, const RootGraph& b);
+};
+
+}  // namespace DotWriter
+
+#endif
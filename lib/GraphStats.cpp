@@ -0,0 +1,84 @@
+#include "GraphStats.h"
+
+#include <chrono>
+
+#include "DotSink.h"
+
+namespace DotWriter {
+
+static const char* phaseNames[] = {
+  "header", "defaults", "nodes", "subgraphs", "clusters", "edges"
+};
+
+static double Now() {
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+PrintStats::PrintStats() {
+  Reset();
+}
+
+void PrintStats::Reset() {
+  for (unsigned i = 0; i < Phase::COUNT; i++) {
+    _seconds[i] = 0;
+    _bytes[i] = 0;
+  }
+  _phase = Phase::HEADER;
+  _depth = 0;
+  _markTime = 0;
+  _markBytes = 0;
+}
+
+const char* PrintStats::GetPhaseName(Phase::e phase) {
+  return phase < Phase::COUNT ? phaseNames[phase] : "";
+}
+
+double PrintStats::GetTotalSeconds() const {
+  double total = 0;
+  for (unsigned i = 0; i < Phase::COUNT; i++) {
+    total += _seconds[i];
+  }
+  return total;
+}
+
+size_t PrintStats::GetTotalBytes() const {
+  size_t total = 0;
+  for (unsigned i = 0; i < Phase::COUNT; i++) {
+    total += _bytes[i];
+  }
+  return total;
+}
+
+void PrintStats::Charge(const DotSink& out) {
+  double now = Now();
+  size_t bytes = out.GetBytesWritten();
+  _seconds[_phase] += now - _markTime;
+  _bytes[_phase] += bytes - _markBytes;
+  _markTime = now;
+  _markBytes = bytes;
+}
+
+PrintStats::Phase::e PrintStats::BeginGraph(const DotSink& out) {
+  if (_depth++ == 0) {
+    // Nothing since the last Print counts.
+    _phase = Phase::HEADER;
+    _markTime = Now();
+    _markBytes = out.GetBytesWritten();
+  } else {
+    Charge(out);
+  }
+  return _phase;
+}
+
+void PrintStats::Enter(Phase::e phase, const DotSink& out) {
+  Charge(out);
+  _phase = phase;
+}
+
+void PrintStats::EndGraph(const DotSink& out) {
+  Charge(out);
+  _depth--;
+}
+
+}  // namespace DotWriter
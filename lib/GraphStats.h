@@ -0,0 +1,132 @@
+/**
+ * Numbers that show what a graph holds and where printing it spends its
+ * time, e.g. to feed into a metrics system. See RootGraph::GetStats,
+ * PrintOptions::stats and RootGraph::SetStatsCallback.
+ *
+ * None of this costs anything unless asked for: GetStats walks the graph
+ * when called, and Print only looks at the clock when given a PrintStats.
+ */
+
+#ifndef DOTWRITER_GRAPHSTATS_H_
+#define DOTWRITER_GRAPHSTATS_H_
+
+#include <cstddef>
+
+namespace DotWriter {
+
+class DotSink;
+
+/**
+ * What a graph holds, counting everything in its subgraphs and clusters.
+ */
+struct GraphStats {
+  size_t numNodes;
+  size_t numEdges;
+  size_t numSubgraphs;
+  size_t numClusters;
+
+  // Distinct attribute sets: node and edge styles, counting shared ones
+  // once, plus every graph's own attributes and defaults. Bytes include
+  // their text and attribute arrays.
+  size_t numAttributeSets;
+  size_t attributeBytes;
+
+  // Custom ids in the id table, and the memory the table takes up.
+  size_t numCustomIds;
+  size_t idTableBytes;
+
+  // Custom ids that were taken already, and so got a number appended (see
+  // IdManager::ValidateCustomId).
+  size_t numIdCollisions;
+
+  // Memory reserved for the graph's elements and their attribute sets (see
+  // Arena and StylePool).
+  size_t arenaBytes;
+
+  GraphStats() :
+    numNodes(0), numEdges(0), numSubgraphs(0), numClusters(0),
+    numAttributeSets(0), attributeBytes(0), numCustomIds(0),
+    idTableBytes(0), numIdCollisions(0), arenaBytes(0) {}
+};
+
+/**
+ * Time and bytes spent printing, per phase. Every byte of output is put
+ * down to exactly one phase, so the phases add up to the whole:
+ * - HEADER: The root graph's opening line, attributes and closing brace.
+ * - DEFAULTS: Every graph's node [...] and edge [...] defaults.
+ * - NODES, EDGES: Every graph's nodes and edges.
+ * - SUBGRAPHS, CLUSTERS: The opening lines, attributes and closing braces
+ *   of subgraphs and clusters. Their contents go to the phases above.
+ *
+ * Printing with output caching (see Graph::SetOutputCaching) puts each
+ * graph's defaults down to its header, as they are cached together.
+ * Totals add up over every Print given the same PrintStats. PrintParallel
+ * does not collect any.
+ */
+class PrintStats {
+public:
+  struct Phase {
+    enum e {
+      HEADER,
+      DEFAULTS,
+      NODES,
+      SUBGRAPHS,
+      CLUSTERS,
+      EDGES,
+      COUNT
+    };
+  };
+
+private:
+  double _seconds[Phase::COUNT];
+  size_t _bytes[Phase::COUNT];
+  Phase::e _phase;
+  // Number of graphs being printed, one inside the other.
+  unsigned _depth;
+  // When, and after how many bytes, the current phase last began.
+  double _markTime;
+  size_t _markBytes;
+
+  /**
+   * Puts the time and bytes since the last mark down to the current phase.
+   */
+  void Charge(const DotSink& out);
+
+public:
+  PrintStats();
+
+  void Reset();
+
+  static const char* GetPhaseName(Phase::e phase);
+
+  double GetSeconds(Phase::e phase) const {
+    return _seconds[phase];
+  }
+
+  size_t GetBytes(Phase::e phase) const {
+    return _bytes[phase];
+  }
+
+  double GetTotalSeconds() const;
+  size_t GetTotalBytes() const;
+
+  /**
+   * Used by Graph::Print. BeginGraph returns the phase that the graph's own
+   * header and footer belong to. Enter switches to another phase.
+   */
+  Phase::e BeginGraph(const DotSink& out);
+  void Enter(Phase::e phase, const DotSink& out);
+  void EndGraph(const DotSink& out);
+};
+
+/**
+ * Called after each Print of a graph (see RootGraph::SetStatsCallback), with
+ * the graph's stats and those of the Print. context is whatever was given
+ * along with the callback.
+ */
+typedef void (*StatsCallback)(const GraphStats& graph,
+  const PrintStats& print, void* context);
+
+}  // namespace DotWriter
+
+#endif
@@ -0,0 +1,68 @@
+#include "GraphView.h"
+
+#include "Edge.h"
+#include "Node.h"
+#include "RootGraph.h"
+
+namespace DotWriter {
+
+GraphView::GraphView(const RootGraph& base) : _base(base) {
+}
+
+GraphView::NodeCopy& GraphView::CopyOf(const Node* node) {
+  std::unordered_map<const Node*, NodeCopy>::iterator it = _nodes.find(node);
+  if (it != _nodes.end()) return it->second;
+
+  NodeCopy& copy = _nodes[node];
+  copy.attributes = node->GetAttributes();
+  copy.label = node->GetLabel();
+  return copy;
+}
+
+GraphView::EdgeCopy& GraphView::CopyOf(const Edge* edge) {
+  std::unordered_map<const Edge*, EdgeCopy>::iterator it = _edges.find(edge);
+  if (it != _edges.end()) return it->second;
+
+  EdgeCopy& copy = _edges[edge];
+  copy.attributes = edge->GetAttributes();
+  copy.label = edge->GetLabel();
+  return copy;
+}
+
+const GraphView::NodeCopy* GraphView::Find(const Node* node) const {
+  std::unordered_map<const Node*, NodeCopy>::const_iterator it =
+    _nodes.find(node);
+  return it != _nodes.end() ? &it->second : NULL;
+}
+
+const GraphView::EdgeCopy* GraphView::Find(const Edge* edge) const {
+  std::unordered_map<const Edge*, EdgeCopy>::const_iterator it =
+    _edges.find(edge);
+  return it != _edges.end() ? &it->second : NULL;
+}
+
+void GraphView::RevertAll() {
+  _nodes.clear();
+  _edges.clear();
+}
+
+void GraphView::Print(DotSink& out, const PrintOptions& options) const {
+  PrintOptions withView = options;
+  withView.view = this;
+  _base.Print(out, withView);
+}
+
+void GraphView::Print(std::ostream& out, const PrintOptions& options) const {
+  OstreamDotSink sink(out);
+  Print(sink, options);
+}
+
+bool GraphView::WriteToFile(const std::string& filename,
+  const PrintOptions& options, Compression::e compression, int level,
+  std::string* error) const {
+  PrintOptions withView = options;
+  withView.view = this;
+  return _base.WriteToFile(filename, withView, compression, level, error);
+}
+
+}  // namespace DotWriter
@@ -0,0 +1,156 @@
+/**
+ * A variant of a graph that differs from it in the attributes and labels of
+ * a few nodes and edges, e.g. the same topology with different elements
+ * highlighted, one file per variant.
+ *
+ * The view never copies or changes the graph it is based on. The first time
+ * an element is changed through the view, the view takes a copy of the
+ * element's attributes and label, and from then on prints that instead of
+ * the element's own. Everything else is printed straight from the base, so
+ * a view costs next to nothing beyond what it changes.
+ *
+ * The base must stay frozen while it has views: nothing may be added to it,
+ * removed from it or changed. Printing a view leaves the base alone, so any
+ * number of views of the same base can be printed at the same time, on
+ * different threads.
+ */
+
+#ifndef DOTWRITER_GRAPHVIEW_H_
+#define DOTWRITER_GRAPHVIEW_H_
+
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "AttributeSet.h"
+#include "CompressedDotSink.h"
+#include "PrintOptions.h"
+
+namespace DotWriter {
+
+class DotSink;
+class Edge;
+class Node;
+class RootGraph;
+
+class GraphView {
+private:
+  /**
+   * The view's copy of an element's attributes and label.
+   */
+  template <typename S>
+  struct Copy {
+    S attributes;
+    std::string label;
+  };
+
+  typedef Copy<NodeAttributeSet> NodeCopy;
+  typedef Copy<EdgeAttributeSet> EdgeCopy;
+
+  const RootGraph& _base;
+  std::unordered_map<const Node*, NodeCopy> _nodes;
+  std::unordered_map<const Edge*, EdgeCopy> _edges;
+
+  NodeCopy& CopyOf(const Node* node);
+  EdgeCopy& CopyOf(const Edge* edge);
+
+  /**
+   * Returns the view's copy of the element, or NULL if it has none.
+   */
+  const NodeCopy* Find(const Node* node) const;
+  const EdgeCopy* Find(const Edge* edge) const;
+
+  friend class DetailReducer;
+  friend class Edge;
+  friend class GraphvizRenderer;
+  friend class Node;
+
+public:
+  /**
+   * base: The graph this is a view of, which must outlive the view.
+   */
+  GraphView(const RootGraph& base);
+
+  const RootGraph& GetBase() const {
+    return _base;
+  }
+
+  /**
+   * Returns the attributes that the view prints for node (or edge), which
+   * start out as a copy of the element's own. Changing them leaves the
+   * element alone.
+   */
+  NodeAttributeSet& GetAttributes(const Node* node) {
+    return CopyOf(node).attributes;
+  }
+
+  EdgeAttributeSet& GetAttributes(const Edge* edge) {
+    return CopyOf(edge).attributes;
+  }
+
+  /**
+   * Sets the label that the view prints for node (or edge).
+   */
+  void SetLabel(const Node* node, std::string label) {
+    CopyOf(node).label = std::move(label);
+  }
+
+  void SetLabel(const Edge* edge, std::string label) {
+    CopyOf(edge).label = std::move(label);
+  }
+
+  /**
+   * Returns true if the view has changed node (or edge), in that it has a
+   * copy of its own, even if it is the same.
+   */
+  bool Changes(const Node* node) const {
+    return Find(node) != NULL;
+  }
+
+  bool Changes(const Edge* edge) const {
+    return Find(edge) != NULL;
+  }
+
+  /**
+   * Undoes all changes to node (or edge), or to everything.
+   */
+  void Revert(const Node* node) {
+    _nodes.erase(node);
+  }
+
+  void Revert(const Edge* edge) {
+    _edges.erase(edge);
+  }
+
+  void RevertAll();
+
+  /**
+   * Number of nodes and edges the view has changed.
+   */
+  size_t NumChanged() const {
+    return _nodes.size() + _edges.size();
+  }
+
+  /**
+   * Prints the base as changed by this view. Anything that options call for
+   * applies, including the level of detail settings. The base's output
+   * cache, if any, is not used, as it holds what the base itself looks like.
+   */
+  void Print(DotSink& out, const PrintOptions& options = PrintOptions()) const;
+  void Print(std::ostream& out,
+    const PrintOptions& options = PrintOptions()) const;
+
+  /**
+   * Same as RootGraph::WriteToFile, but writes the base as changed by this
+   * view.
+   */
+  bool WriteToFile(const std::string& filename,
+    const PrintOptions& options = PrintOptions(),
+    Compression::e compression = Compression::NONE, int level = 0,
+    std::string* error = NULL) const;
+};
+
+}  // namespace DotWriter
+
+#endif
@@ -0,0 +1,306 @@
+#include "GraphvizRenderer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+#ifdef HAVE_GRAPHVIZ
+#include <graphviz/gvc.h>
+#endif
+
+#include "Cluster.h"
+#include "DetailReducer.h"
+#include "Edge.h"
+#include "GraphView.h"
+#include "Node.h"
+#include "OutputFile.h"
+#include "RootGraph.h"
+#include "Subgraph.h"
+#include "Util.h"
+
+namespace DotWriter {
+
+#ifdef HAVE_GRAPHVIZ
+// What Graphviz reported while a graph was being rendered. Graphviz only
+// takes a plain function for this, and is not thread safe anyway.
+static std::string graphvizMessages;
+
+static int CollectMessage(char* message) {
+  graphvizMessages += message;
+  return 0;
+}
+
+// Older versions of Graphviz take char* where they mean const char*.
+static char* Text(const std::string& str) {
+  return const_cast<char*>(str.c_str());
+}
+
+static char emptyText[] = "";
+static char labelName[] = "label";
+
+/**
+ * Sets the attribute called name on obj to text, escaped the way it would be
+ * printed, minus the escaped quotes (see AttributeSet::GetAttributeText).
+ */
+static void SetText(void* obj, char* name, std::string_view text,
+  std::string& scratch) {
+  scratch.clear();
+  AppendEscaped(scratch, text.data(), text.size());
+  ReplaceAll(scratch, "\\\"", "\"");
+  agsafeset(obj, name, Text(scratch), emptyText);
+}
+
+/**
+ * Hands what a TextProvider adds to Graphviz.
+ */
+class GraphvizAttributeWriter : public AttributeWriter {
+private:
+  void* _obj;
+  std::string _name;
+  std::string _value;
+
+public:
+  GraphvizAttributeWriter(void* obj) : _obj(obj) {};
+
+  virtual void Add(std::string_view name, std::string_view value) {
+    _name.assign(name);
+    SetText(_obj, Text(_name), value, _value);
+  }
+};
+#endif
+
+GraphvizRenderer::GraphvizRenderer(std::string layout) :
+  _context(NULL), _layout(std::move(layout)) {
+#ifdef HAVE_GRAPHVIZ
+  _context = gvContext();
+#endif
+}
+
+GraphvizRenderer::~GraphvizRenderer() {
+#ifdef HAVE_GRAPHVIZ
+  if (_context != NULL) gvFreeContext(_context);
+#endif
+}
+
+bool GraphvizRenderer::IsSupported() {
+#ifdef HAVE_GRAPHVIZ
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool GraphvizRenderer::Fail(const std::string& what) {
+  _error = what;
+#ifdef HAVE_GRAPHVIZ
+  size_t end = graphvizMessages.find_last_not_of("\n");
+  if (end != std::string::npos) {
+    _error += ": ";
+    _error.append(graphvizMessages, 0, end + 1);
+  }
+  graphvizMessages.clear();
+#endif
+  return false;
+}
+
+#ifdef HAVE_GRAPHVIZ
+void GraphvizRenderer::SetAttributes(void* obj,
+  const AttributeSet& attributes, const std::string& label) {
+  for (unsigned i = 0; i < attributes.Size(); i++) {
+    attributes.GetAttributeText(i, _name, _value);
+    // The element's own label replaces any label attribute.
+    if (!label.empty() && _name == labelName) continue;
+    agsafeset(obj, Text(_name), Text(_value), emptyText);
+  }
+
+  if (!label.empty()) SetText(obj, labelName, label, _value);
+}
+
+void GraphvizRenderer::SetDefaults(Agraph_s* graph, int kind,
+  const AttributeSet& defaults) {
+  Agraph_t* root = agroot(graph);
+  for (unsigned i = 0; i < defaults.Size(); i++) {
+    defaults.GetAttributeText(i, _name, _value);
+    // Like the DOT parser, declare the attribute on the root graph first, so
+    // that a subgraph's defaults do not become everyone's.
+    if (graph != root && agattr(root, kind, Text(_name), NULL) == NULL) {
+      agattr(root, kind, Text(_name), emptyText);
+    }
+    agattr(graph, kind, Text(_name), Text(_value));
+  }
+}
+
+void GraphvizRenderer::AddContents(Agraph_s* into, const Graph* graph,
+  const GraphView* view) {
+  SetDefaults(into, AGNODE, graph->_defaultNodeAttributes);
+  SetDefaults(into, AGEDGE, graph->_defaultEdgeAttributes);
+
+  SlotList<Node>::iterator nodeIt;
+  for (nodeIt = graph->_nodes.begin(); nodeIt != graph->_nodes.end();
+    nodeIt++) {
+    const Node* node = *nodeIt;
+    _id.clear();
+    node->AppendId(_id);
+    Agnode_t* added = agnode(into, Text(_id), 1);
+    const GraphView::NodeCopy* copy = view != NULL ? view->Find(node) : NULL;
+    if (copy != NULL) {
+      SetAttributes(added, copy->attributes, copy->label);
+    } else {
+      SetAttributes(added, node->GetAttributes(), node->GetLabel());
+    }
+    if (graph->_textProvider != NULL) {
+      GraphvizAttributeWriter writer(added);
+      graph->_textProvider->AddNodeText(*node, writer);
+    }
+  }
+
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = graph->_subgraphs.begin(); sgIt != graph->_subgraphs.end();
+    sgIt++) {
+    const Subgraph* sg = *sgIt;
+    _id.clear();
+    sg->AppendId(_id);
+    Agraph_t* added = agsubg(into, Text(_id), 1);
+    SetAttributes(added, sg->GetAttributes(), sg->GetLabel());
+    AddContents(added, sg, view);
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = graph->_clusters.begin(); cIt != graph->_clusters.end(); cIt++) {
+    const Cluster* cluster = *cIt;
+    _id.clear();
+    cluster->AppendId(_id);
+    Agraph_t* added = agsubg(into, Text(_id), 1);
+    SetAttributes(added, cluster->GetAttributes(), cluster->GetLabel());
+    AddContents(added, cluster, view);
+  }
+
+  // As in DOT, an edge adds its nodes to the graph it is in.
+  SlotList<Edge>::iterator edgeIt;
+  for (edgeIt = graph->_edges.begin(); edgeIt != graph->_edges.end();
+    edgeIt++) {
+    const Edge* edge = *edgeIt;
+    _id.clear();
+    edge->GetSource()->AppendId(_id);
+    Agnode_t* tail = agnode(into, Text(_id), 1);
+    _id.clear();
+    edge->GetDest()->AppendId(_id);
+    Agnode_t* head = agnode(into, Text(_id), 1);
+
+    // Anonymous, so that parallel edges stay apart.
+    Agedge_t* added = agedge(into, tail, head, NULL, 1);
+    const GraphView::EdgeCopy* copy = view != NULL ? view->Find(edge) : NULL;
+    if (copy != NULL) {
+      SetAttributes(added, copy->attributes, copy->label);
+    } else {
+      SetAttributes(added, edge->GetAttributes(), edge->GetLabel());
+    }
+    if (graph->_textProvider != NULL) {
+      GraphvizAttributeWriter writer(added);
+      graph->_textProvider->AddEdgeText(*edge, writer);
+    }
+  }
+}
+
+Agraph_s* GraphvizRenderer::Build(const RootGraph& graph,
+  const GraphView* view) {
+  _id.clear();
+  graph.AppendId(_id);
+  Agraph_t* built = agopen(Text(_id),
+    graph.IsDigraph() ? Agdirected : Agundirected, NULL);
+  if (built == NULL) return NULL;
+
+  SetAttributes(built, graph.GetAttributes(), graph.GetLabel());
+  AddContents(built, &graph, view);
+  return built;
+}
+
+Agraph_s* GraphvizRenderer::Layout(const RootGraph& graph,
+  const PrintOptions& options) {
+  if (_context == NULL) {
+    Fail("cannot start Graphviz");
+    return NULL;
+  }
+
+  Agraph_t* built;
+  if (options.ReducesDetail()) {
+    RootGraph* reduced = DetailReducer::Reduce(graph, options);
+    // The view's changes are part of the reduced graph already.
+    built = Build(*reduced, NULL);
+    delete reduced;
+  } else {
+    built = Build(graph, options.view);
+  }
+  if (built == NULL) {
+    Fail("cannot build the Graphviz graph");
+    return NULL;
+  }
+
+  if (gvLayout(_context, built, _layout.c_str()) != 0) {
+    Fail("layout with " + _layout + " failed");
+    agclose(built);
+    return NULL;
+  }
+  return built;
+}
+
+void GraphvizRenderer::Close(Agraph_s* graph) {
+  gvFreeLayout(_context, graph);
+  agclose(graph);
+}
+#endif
+
+#ifdef HAVE_GRAPHVIZ
+bool GraphvizRenderer::Render(const RootGraph& graph,
+  const std::string& format, FILE* out, const PrintOptions& options) {
+  graphvizMessages.clear();
+  agusererrf previous = agseterrf(CollectMessage);
+
+  Agraph_t* built = Layout(graph, options);
+  bool ok = built != NULL;
+  if (ok && gvRender(_context, built, format.c_str(), out) != 0) {
+    ok = Fail("cannot render " + format);
+  }
+  if (built != NULL) Close(built);
+
+  agseterrf(previous);
+  return ok;
+}
+#else
+bool GraphvizRenderer::Render(const RootGraph& /*graph*/,
+  const std::string& /*format*/, FILE* /*out*/,
+  const PrintOptions& /*options*/) {
+  return Fail("Graphviz rendering not supported by this build");
+}
+#endif
+
+bool GraphvizRenderer::RenderToFile(const RootGraph& graph,
+  const std::string& format, const std::string& filename,
+  const PrintOptions& options) {
+  if (!IsSupported()) {
+    return Fail("Graphviz rendering not supported by this build");
+  }
+
+  OutputFile file;
+  if (!file.Open(filename)) return Fail(file.GetError());
+
+  // The stream gets a descriptor of its own, which shares the file offset.
+  int fd = dup(file.GetFd());
+  FILE* outFile = fd < 0 ? NULL : fdopen(fd, "wb");
+  if (outFile == NULL) {
+    std::string what = std::string("fdopen: ") + strerror(errno);
+    if (fd >= 0) close(fd);
+    return Fail(what);
+  }
+
+  bool ok = Render(graph, format, outFile, options);
+  if (fclose(outFile) != 0 && ok) {
+    ok = Fail(std::string("fclose: ") + strerror(errno));
+  }
+  if (!ok) return false;
+
+  if (!file.Commit()) return Fail(file.GetError());
+  return true;
+}
+
+}  // namespace DotWriter
@@ -0,0 +1,123 @@
+/**
+ * Lays out and renders graphs with Graphviz's own libraries (libcgraph and
+ * libgvc), in process, rather than by writing a DOT file and running dot on
+ * it.
+ *
+ * The renderer walks the graph and builds the same Graphviz graph that
+ * parsing its DOT output would have: every subgraph, cluster, node and edge,
+ * in print order, with the same attributes and defaults. That saves the
+ * time spent formatting the text, starting dot, and parsing the text back.
+ *
+ * Only available if configure found Graphviz; see IsSupported. Graphviz is
+ * not thread safe, so only one renderer should be used at a time.
+ */
+
+#ifndef DOTWRITER_GRAPHVIZRENDERER_H_
+#define DOTWRITER_GRAPHVIZRENDERER_H_
+
+#include <cstdio>
+#include <string>
+#include <utility>
+
+#include "PrintOptions.h"
+
+// Graphviz's types, which are only defined if configure found Graphviz.
+struct Agraph_s;
+struct GVC_s;
+
+namespace DotWriter {
+
+class AttributeSet;
+class Graph;
+class GraphView;
+class RootGraph;
+
+class GraphvizRenderer {
+private:
+  GVC_s* _context;
+  std::string _layout;
+  std::string _error;
+  // Scratch space for ids and attributes.
+  std::string _id;
+  std::string _name;
+  std::string _value;
+
+  bool Fail(const std::string& what);
+
+  /**
+   * Builds the Graphviz graph for graph, reduced first if options call for
+   * it (see DetailReducer), and lays it out. Returns NULL on failure.
+   */
+  Agraph_s* Layout(const RootGraph& graph, const PrintOptions& options);
+  Agraph_s* Build(const RootGraph& graph, const GraphView* view);
+  void Close(Agraph_s* graph);
+
+  /**
+   * Adds graph's defaults, nodes, subgraphs, clusters and edges to into, the
+   * way view (if not NULL) has them.
+   */
+  void AddContents(Agraph_s* into, const Graph* graph, const GraphView* view);
+
+  /**
+   * Sets attributes on obj (a Graphviz graph, node or edge), along with
+   * label, like AttributeSet::PrintWithLabel.
+   */
+  void SetAttributes(void* obj, const AttributeSet& attributes,
+    const std::string& label);
+
+  /**
+   * Sets the node (kind AGNODE) or edge (AGEDGE) defaults of graph.
+   */
+  void SetDefaults(Agraph_s* graph, int kind, const AttributeSet& defaults);
+
+  // Not copyable.
+  GraphvizRenderer(const GraphvizRenderer&);
+  GraphvizRenderer& operator=(const GraphvizRenderer&);
+
+public:
+  /**
+   * layout: Graphviz layout engine to use, e.g. "dot", "neato" or "sfdp".
+   */
+  GraphvizRenderer(std::string layout = "dot");
+  virtual ~GraphvizRenderer();
+
+  /**
+   * Returns true if this build can render through Graphviz.
+   */
+  static bool IsSupported();
+
+  const std::string& GetLayout() const {
+    return _layout;
+  }
+
+  void SetLayout(std::string layout) {
+    _layout = std::move(layout);
+  }
+
+  /**
+   * Renders graph in format (any that Graphviz has a plugin for, e.g. "svg"
+   * or "png") to filename. Like RootGraph::WriteToFile, the file only
+   * appears once it is complete. Of options, only the level of detail
+   * settings and view apply. Returns false on failure; see GetError.
+   */
+  bool RenderToFile(const RootGraph& graph, const std::string& format,
+    const std::string& filename, const PrintOptions& options = PrintOptions());
+
+  /**
+   * Same as above, but renders into out, which is neither flushed nor
+   * closed.
+   */
+  bool Render(const RootGraph& graph, const std::string& format, FILE* out,
+    const PrintOptions& options = PrintOptions());
+
+  /**
+   * Describes the last failure, including what Graphviz had to say about it.
+   */
+  const std::string& GetError() const {
+    return _error;
+  }
+};
+
+}  // namespace DotWriter
+
+#endif
@@ -1,91 +1,350 @@
 #include "IdManager.h"
 
-#include <sstream>
+#include "Util.h"
 
 namespace DotWriter {
 
-const std::string& IdManager::GetNodeId() {
-  std::stringstream nodeStream;
-  nodeStream << "Node" << GetNextNodeIdNum();
+// Hash table size before anything is reserved.
+static const size_t initialSlots = 64;
 
-  const std::string idStr = nodeStream.str();
-  bool success;
-  const std::string& val = RegisterId(&success, idStr);
+static const char* prefixes[] = { "", "Node", "Graph", "cluster_" };
 
-  if (success) {
-    return val;
+/**
+ * 32-bit FNV-1a.
+ */
+static uint32_t HashId(std::string_view id) {
+  uint32_t hash = 2166136261U;
+  for (size_t i = 0; i < id.size(); i++) {
+    hash ^= static_cast<unsigned char>(id[i]);
+    hash *= 16777619U;
   }
+  return hash;
+}
 
-  // Recurse if the chosen graph ID was already taken. This means that
-  // the user must have manually specified an ID with the name "Node##".
-  return GetNodeId();
+IdManager::IdManager(IdTracking::e tracking, size_t expectedIds) :
+  _nextNodeIdNum(0), _nextSubgraphIdNum(0), _nextCustomIdNum(0),
+  _tracking(tracking),
+  _idFilter(tracking == IdTracking::BLOOM ? expectedIds : 1),
+  _numLookalikeIds(0), _numCustomIds(0), _numCollisions(0) {
+  if (tracking == IdTracking::EXACT) {
+    _slots.resize(initialSlots);
+    _customOffsets.push_back(0);
+  }
 }
 
-const std::string& IdManager::GetSubgraphId() {
-  std::stringstream graphStream;
-  graphStream << "Graph" << GetNextSubgraphIdNum();
+IdManager::IdKind::e IdManager::ParseGeneratedId(std::string_view id,
+  unsigned long* num) {
+  for (unsigned kind = IdKind::NODE; kind <= IdKind::CLUSTER; kind++) {
+    const char* prefix = prefixes[kind];
+    size_t prefixLength = std::char_traits<char>::length(prefix);
+    if (id.compare(0, prefixLength, prefix) != 0) continue;
+
+    // Generated numbers have no leading zeros. Numbers too big for a handle
+    // are stored as custom ids (see CreateGeneratedId), so they are treated as
+    // such here.
+    size_t numDigits = id.size() - prefixLength;
+    if (numDigits == 0 || numDigits > 10) return IdKind::CUSTOM;
+    if (id[prefixLength] == '0' && numDigits > 1) return IdKind::CUSTOM;
 
-  const std::string idStr = graphStream.str();
-  bool success;
-  const std::string& val = RegisterId(&success, idStr);
+    uint64_t value = 0;
+    for (size_t i = prefixLength; i < id.size(); i++) {
+      if (id[i] < '0' || id[i] > '9') return IdKind::CUSTOM;
+      value = value * 10 + (id[i] - '0');
+    }
+    if (value >= _valueMask) return IdKind::CUSTOM;
 
-  if (success) {
-    return val;
+    *num = static_cast<unsigned long>(value);
+    return static_cast<IdKind::e>(kind);
   }
 
-  // Recurse if the chosen graph ID was already taken. This means that
-  // the user must have manually specified an ID with the name "Graph##".
-  return GetSubgraphId();
+  return IdKind::CUSTOM;
 }
 
-const std::string& IdManager::GetClusterId() {
-  std::stringstream graphStream;
-  graphStream << "cluster_" << GetNextSubgraphIdNum();
+bool IdManager::IsGenerated(std::string_view id) const {
+  unsigned long num;
+  switch (ParseGeneratedId(id, &num)) {
+    case IdKind::NODE:
+      return num < _nextNodeIdNum;
+    case IdKind::SUBGRAPH:
+    case IdKind::CLUSTER:
+      // Subgraphs and clusters share a counter, so this is conservative: it
+      // may report "Graph3" as taken when 3 actually went to "cluster_3".
+      return num < _nextSubgraphIdNum;
+    default:
+      return false;
+  }
+}
+
+size_t IdManager::FindSlot(std::string_view id, uint32_t hash) const {
+  size_t mask = _slots.size() - 1;
+  size_t pos = hash & mask;
 
-  const std::string idStr = graphStream.str();
-  bool success;
-  const std::string& val = RegisterId(&success, idStr);
+  // Linear probing.
+  while (_slots[pos].index != 0) {
+    const Slot& slot = _slots[pos];
+    if (slot.hash == hash) {
+      uint32_t begin = _customOffsets[slot.index - 1];
+      uint32_t end = _customOffsets[slot.index];
+      if (id.size() == end - begin &&
+        _customIds.compare(begin, end - begin, id) == 0) {
+        return pos;
+      }
+    }
+    pos = (pos + 1) & mask;
+  }
+
+  return pos;
+}
 
-  if (success) {
-    return val;
+bool IdManager::IsCustomIdTaken(std::string_view id) const {
+  switch (_tracking) {
+    case IdTracking::EXACT:
+      return _slots[FindSlot(id, HashId(id))].index != 0;
+    case IdTracking::BLOOM:
+      return _idFilter.MayContain(id);
+    default:
+      return false;
   }
+}
+
+void IdManager::Rehash(size_t numSlots) {
+  std::vector<Slot> oldSlots(numSlots);
+  oldSlots.swap(_slots);
 
-  // Recurse if the chosen graph ID was already taken. This means that
-  // the user must have manually specified an ID with the name "Graph##".
-  return GetClusterId();
+  size_t mask = numSlots - 1;
+  std::vector<Slot>::iterator it;
+  for (it = oldSlots.begin(); it != oldSlots.end(); it++) {
+    if (it->index == 0) continue;
+
+    size_t pos = it->hash & mask;
+    while (_slots[pos].index != 0) {
+      pos = (pos + 1) & mask;
+    }
+    _slots[pos] = *it;
+  }
 }
 
-const std::string& IdManager::ValidateCustomId(std::string customId) {
-  bool success;
-  const std::string& val = RegisterId(&success, customId);
+void IdManager::Reserve(size_t expectedIds) {
+  if (_tracking != IdTracking::EXACT) return;
 
-  if (success) {
-    return val;
+  size_t numIds = _customOffsets.size() - 1 + expectedIds;
+  size_t numSlots = _slots.size();
+  while (numSlots < numIds * 2) {
+    numSlots *= 2;
   }
 
-  std::ostringstream oss;
-  std::string newCustomId;
+  if (numSlots != _slots.size()) Rehash(numSlots);
+  _customOffsets.reserve(numIds + 1);
+}
+
+bool IdManager::ClaimCustomId(std::string_view id, IdHandle* handle) {
+  unsigned long num;
+  bool lookalike = ParseGeneratedId(id, &num) != IdKind::CUSTOM;
+  if (lookalike && IsGenerated(id)) return false;
 
-  while (!success) {
-    oss << customId << GetNextCustomIdNum(); 
+  switch (_tracking) {
+    case IdTracking::EXACT: {
+      uint32_t hash = HashId(id);
+      size_t pos = FindSlot(id, hash);
+      if (_slots[pos].index != 0) return false;
 
-    newCustomId = oss.str();
-    const std::string& val2 = RegisterId(&success, newCustomId);
-    if (success) return val2;
-    oss.clear();
+      _customIds.append(id);
+      _customOffsets.push_back(_customIds.size());
+      _slots[pos].hash = hash;
+      _slots[pos].index = _customOffsets.size() - 1;
+      *handle = MakeHandle(IdKind::CUSTOM, _slots[pos].index - 1);
+
+      if ((_customOffsets.size() - 1) * 2 > _slots.size()) {
+        Rehash(_slots.size() * 2);
+      }
+      break;
+    }
+    case IdTracking::BLOOM:
+      if (!_idFilter.Insert(id)) return false;
+      // Fall through.
+    default:
+      _transientId = id;
+      *handle = MakeHandle(IdKind::CUSTOM, _transientHandle);
+      break;
   }
 
-  // Unreachable.
-  return val;
+  if (lookalike) _numLookalikeIds++;
+  _numCustomIds++;
+  return true;
+}
+
+unsigned long IdManager::NextFreeNumber(IdKind::e kind,
+  unsigned long (IdManager::*next)()) {
+  // Loop if the chosen ID was already taken. This means that the user must
+  // have manually specified an ID of the same form.
+  while (true) {
+    unsigned long num = (this->*next)();
+    if (_numLookalikeIds == 0) return num;
+
+    _candidate.assign(prefixes[kind]);
+    AppendUnsigned(_candidate, num);
+    if (!IsCustomIdTaken(_candidate)) return num;
+  }
 }
 
-const std::string& IdManager::ValidateCustomClusterId(std::string customId) {
+IdHandle IdManager::CreateGeneratedId(IdKind::e kind,
+  unsigned long (IdManager::*next)()) {
+  unsigned long num = NextFreeNumber(kind, next);
+  if (num < _valueMask) return MakeHandle(kind, num);
+
+  // Out of room in the handle; store the text like any other custom id.
+  _candidate.assign(prefixes[kind]);
+  AppendUnsigned(_candidate, num);
+  IdHandle handle = MakeHandle(IdKind::CUSTOM, _transientHandle);
+  ClaimCustomId(_candidate, &handle);
+  return handle;
+}
+
+IdHandle IdManager::CreateNodeId() {
+  return CreateGeneratedId(IdKind::NODE, &IdManager::GetNextNodeIdNum);
+}
+
+IdHandle IdManager::CreateSubgraphId() {
+  return CreateGeneratedId(IdKind::SUBGRAPH, &IdManager::GetNextSubgraphIdNum);
+}
+
+IdHandle IdManager::CreateClusterId() {
+  return CreateGeneratedId(IdKind::CLUSTER, &IdManager::GetNextSubgraphIdNum);
+}
+
+IdHandle IdManager::CreateCustomId(std::string_view customId) {
+  IdHandle handle;
+  if (ClaimCustomId(customId, &handle)) {
+    return handle;
+  }
+
+  _numCollisions++;
+  while (true) {
+    _candidate.assign(customId);
+    AppendUnsigned(_candidate, GetNextCustomIdNum());
+    if (ClaimCustomId(_candidate, &handle)) return handle;
+  }
+}
+
+IdHandle IdManager::CreateCustomClusterId(std::string_view customId) {
   // Ensure it begins with 'cluster'
-  if (customId.substr(0,7).compare("cluster") != 0) {
-    customId = "cluster" + customId;
+  if (customId.compare(0, 7, "cluster") != 0) {
+    std::string id("cluster");
+    id.append(customId);
+    return CreateCustomId(id);
+  }
+
+  return CreateCustomId(customId);
+}
+
+size_t IdManager::GetMemoryUsage() const {
+  return _customIds.capacity() + _customOffsets.capacity() * sizeof(uint32_t) +
+    _slots.capacity() * sizeof(Slot) + _idFilter.GetMemoryUsage();
+}
+
+void IdManager::PrintId(DotSink& out, IdHandle id) const {
+  IdKind::e kind = GetKind(id);
+  IdHandle value = id & _valueMask;
+
+  if (kind != IdKind::CUSTOM) {
+    out.Write(prefixes[kind]);
+    out.WriteUnsigned(value);
+  } else if (_tracking != IdTracking::EXACT || value == _transientHandle) {
+    out.Write(_transientId);
+  } else {
+    uint32_t begin = _customOffsets[value];
+    out.Write(_customIds.data() + begin, _customOffsets[value + 1] - begin);
+  }
+}
+
+void IdManager::PrintId(std::ostream& out, IdHandle id) const {
+  IdKind::e kind = GetKind(id);
+  IdHandle value = id & _valueMask;
+
+  if (kind != IdKind::CUSTOM) {
+    // Prefix and digits go out in a single write.
+    char buffer[32];
+    const char* prefix = prefixes[kind];
+    size_t length = std::char_traits<char>::length(prefix);
+    std::char_traits<char>::copy(buffer, prefix, length);
+    length += FormatUnsigned(value, buffer + length);
+    out.write(buffer, length);
+  } else if (_tracking != IdTracking::EXACT || value == _transientHandle) {
+    out << _transientId;
+  } else {
+    uint32_t begin = _customOffsets[value];
+    out.write(_customIds.data() + begin, _customOffsets[value + 1] - begin);
+  }
+}
+
+void IdManager::AppendId(std::string& str, IdHandle id) const {
+  IdKind::e kind = GetKind(id);
+  IdHandle value = id & _valueMask;
+
+  if (kind != IdKind::CUSTOM) {
+    str.append(prefixes[kind]);
+    AppendUnsigned(str, value);
+  } else if (_tracking != IdTracking::EXACT || value == _transientHandle) {
+    str.append(_transientId);
+  } else {
+    uint32_t begin = _customOffsets[value];
+    str.append(_customIds, begin, _customOffsets[value + 1] - begin);
   }
+}
+
+bool IdManager::FindId(std::string_view id, IdHandle* handle) const {
+  // A custom id can have the form of a generated one that was skipped (see
+  // NextFreeNumber), so custom ids are looked up first.
+  if (_tracking == IdTracking::EXACT) {
+    const Slot& slot = _slots[FindSlot(id, HashId(id))];
+    if (slot.index != 0) {
+      *handle = MakeHandle(IdKind::CUSTOM, slot.index - 1);
+      return true;
+    }
+  }
+
+  unsigned long num;
+  IdKind::e kind = ParseGeneratedId(id, &num);
+  if (kind == IdKind::CUSTOM || !IsGenerated(id)) return false;
+
+  *handle = MakeHandle(kind, num);
+  return true;
+}
+
+const std::string& IdManager::GetNodeId() {
+  IdHandle id = CreateNodeId();
+  _lastId.clear();
+  AppendId(_lastId, id);
+  return _lastId;
+}
+
+const std::string& IdManager::GetSubgraphId() {
+  IdHandle id = CreateSubgraphId();
+  _lastId.clear();
+  AppendId(_lastId, id);
+  return _lastId;
+}
+
+const std::string& IdManager::GetClusterId() {
+  IdHandle id = CreateClusterId();
+  _lastId.clear();
+  AppendId(_lastId, id);
+  return _lastId;
+}
+
+const std::string& IdManager::ValidateCustomId(std::string_view customId) {
+  IdHandle id = CreateCustomId(customId);
+  _lastId.clear();
+  AppendId(_lastId, id);
+  return _lastId;
+}
 
-  return ValidateCustomId(customId);
+const std::string& IdManager::ValidateCustomClusterId(
+  std::string_view customId) {
+  IdHandle id = CreateCustomClusterId(customId);
+  _lastId.clear();
+  AppendId(_lastId, id);
+  return _lastId;
 }
 
 }  // namespace DotWriter
@@ -1,26 +1,107 @@
 #ifndef DOTWRITER_IDMANAGER_H
 #define DOTWRITER_IDMANAGER_H
 
+#include <ostream>
 #include <string>
-#include <set>
+#include <string_view>
+#include <vector>
+#include <stdint.h>
+
+#include "BloomFilter.h"
+#include "DotSink.h"
 
 namespace DotWriter {
 
+/**
+ * A compact reference to an id registered with an IdManager.
+ *
+ * The top two bits say what kind of id it is. Generated ids ("Node12",
+ * "Graph3", "cluster_4") keep their number in the remaining bits and are only
+ * turned into text when printed. Custom ids keep the index of their text in the
+ * IdManager's string pool.
+ */
+typedef uint32_t IdHandle;
+
+/**
+ * How an IdManager remembers the ids it has handed out.
+ */
+struct IdTracking {
+  enum e {
+    // Every custom id is kept, and handles stay valid for the IdManager's
+    // lifetime. Required by RootGraph.
+    EXACT,
+    // Custom ids are kept in a Bloom filter. Duplicates are still never
+    // produced, but a false positive occasionally renames an id that was
+    // actually unique.
+    BLOOM,
+    // Ids are not kept at all. Generated ids are still unique among
+    // themselves, but custom ids are trusted not to clash with each other or
+    // with generated ids.
+    NONE
+  };
+};
+
 /**
  * Ensures that no two IDs in a graph are the same.
  * This object also manages the memory for each ID.
+ *
+ * Generated ids are never stored: a custom id is checked against them by
+ * parsing its number instead. Custom ids are interned into one contiguous
+ * string pool, indexed by an open-addressing hash table.
  */
 class IdManager {
 private:
+  /**
+   * A hash table slot. index is one past the custom id's index; zero means
+   * the slot is empty.
+   */
+  struct Slot {
+    uint32_t hash;
+    uint32_t index;
+  };
+
+  struct IdKind {
+    enum e {
+      CUSTOM,
+      NODE,
+      SUBGRAPH,
+      CLUSTER
+    };
+  };
+
+  static const unsigned _kindShift = 30;
+  static const IdHandle _valueMask = (1U << _kindShift) - 1;
+  // Handle of the most recent custom id when custom ids are not kept.
+  static const IdHandle _transientHandle = _valueMask;
+
   unsigned long _nextNodeIdNum;
   unsigned long _nextSubgraphIdNum;
   // This is the next number to append to a non-unique custom ID supplied by the
   // user. Why just one count? It's simpler, and guarantees that I don't try the
-  // same number twice. 
+  // same number twice.
   // So if a user tries to create many nodes with the ID "foo", I don't retry
   // "foo0" as an alternative more than once across all attempts to use that ID.
   unsigned long _nextCustomIdNum;
-  std::set<std::string> _existingIds;
+  IdTracking::e _tracking;
+  // Text of every custom id, back to back. Custom id i spans
+  // [_customOffsets[i], _customOffsets[i+1]).
+  std::string _customIds;
+  std::vector<uint32_t> _customOffsets;
+  // Size is always a power of two, and at most half full.
+  std::vector<Slot> _slots;
+  BloomFilter _idFilter;
+  // Number of custom ids that have the same form as generated ones. While this
+  // is zero, generated ids need not be checked for collisions at all.
+  unsigned long _numLookalikeIds;
+  unsigned long _numCustomIds;
+  // Number of custom ids that were taken, and so got a number appended.
+  unsigned long _numCollisions;
+  // Text of _transientHandle.
+  std::string _transientId;
+  // Holds the text returned by the std::string based functions.
+  std::string _lastId;
+  // Scratch space for building candidate ids.
+  std::string _candidate;
 
   /** Use these functions to access the above ID counters within this class. **/
 
@@ -36,56 +117,161 @@ private:
     return _nextCustomIdNum++;
   }
 
+  static IdHandle MakeHandle(IdKind::e kind, unsigned long value) {
+    return (static_cast<IdHandle>(kind) << _kindShift) |
+      static_cast<IdHandle>(value);
+  }
+
+  static IdKind::e GetKind(IdHandle id) {
+    return static_cast<IdKind::e>(id >> _kindShift);
+  }
+
   /**
-   * Registers the given ID with the ID manager.
-   * Returns the string, and mutates success with whether or not the
-   * registration succeeded.
+   * Returns the kind of generated id that id looks like, and its number, or
+   * CUSTOM if it does not look like a generated id.
    */
-  const std::string& RegisterId(bool* success, const std::string& id) {
-    std::pair<std::set<std::string>::iterator, bool> retVal =
-        _existingIds.insert(id);
+  static IdKind::e ParseGeneratedId(std::string_view id,
+    unsigned long* num);
 
-    *success = retVal.second;
-    return *retVal.first;
-  }
+  /**
+   * Returns true if id has been handed out as a generated id.
+   */
+  bool IsGenerated(std::string_view id) const;
 
-public:
-  IdManager() : _nextNodeIdNum(0), _nextSubgraphIdNum(0), _nextCustomIdNum(0) {
+  /**
+   * Returns true if id has (or, with a Bloom filter, may have) been taken as a
+   * custom id.
+   */
+  bool IsCustomIdTaken(std::string_view id) const;
 
-  }
+  /**
+   * Looks up id in the hash table. Returns the index of the slot holding it,
+   * or of the empty slot where it would go.
+   */
+  size_t FindSlot(std::string_view id, uint32_t hash) const;
 
-  virtual ~IdManager() {};
+  void Rehash(size_t numSlots);
 
   /**
-   * Get a unique node ID. Used when the user does not specify
-   * an ID.
+   * Takes id as a custom id if nobody has it. Returns false if it is taken.
    */
-  const std::string& GetNodeId();
+  bool ClaimCustomId(std::string_view id, IdHandle* handle);
 
   /**
-   * Get a unique subgraph ID. Used when the user does not specify an
-   * ID.
+   * Hands out the next number from next for which prefix + number does not
+   * clash with a custom id.
    */
-  const std::string& GetSubgraphId();
+  unsigned long NextFreeNumber(IdKind::e kind,
+    unsigned long (IdManager::*next)());
+
+  IdHandle CreateGeneratedId(IdKind::e kind,
+    unsigned long (IdManager::*next)());
+
+  // Not copyable.
+  IdManager(const IdManager&);
+  IdManager& operator=(const IdManager&);
 
+public:
   /**
-   * Get a unique cluster ID. Used when a user does not specify an ID.
+   * - tracking: How ids are remembered. Anything but EXACT means that custom
+   *   id handles are only valid until the next id is created.
+   * - expectedIds: Sizes the Bloom filter when tracking is BLOOM.
    */
-  const std::string& GetClusterId();
+  IdManager(IdTracking::e tracking = IdTracking::EXACT,
+    size_t expectedIds = 1 << 20);
+
+  virtual ~IdManager() {};
+
+  /**
+   * Makes room for expectedIds more custom ids, so that adding that many
+   * does not have to grow the hash table. Useful when the size of the graph is
+   * known up front.
+   */
+  void Reserve(size_t expectedIds);
+
+  /**
+   * Create a unique node, subgraph or cluster id. Used when the user does not
+   * specify an id.
+   */
+  IdHandle CreateNodeId();
+  IdHandle CreateSubgraphId();
+  IdHandle CreateClusterId();
 
   /**
    * This is used to validate IDs specified by the user of the API
-   * (e.g. not retrieved through the GetId functions provided by this class).
+   * (e.g. not retrieved through the Create functions provided by this class).
    * This checks if the ID is unique. If it is not, it will append a number to
    * it until it is unique.
    */
-  const std::string& ValidateCustomId(std::string customId);
+  IdHandle CreateCustomId(std::string_view customId);
 
   /**
-   * Same as 'ValidateCustomId', but ensured that the ID begins with 'cluster'.
+   * Same as 'CreateCustomId', but ensures that the ID begins with 'cluster'.
    * This is required, unfortunately, for a subgraph to be treated as a cluster.
    */
-  const std::string& ValidateCustomClusterId(std::string customId);
+  IdHandle CreateCustomClusterId(std::string_view customId);
+
+  /**
+   * Writes the text of the given id.
+   */
+  void PrintId(DotSink& out, IdHandle id) const;
+  void PrintId(std::ostream& out, IdHandle id) const;
+
+  /**
+   * Appends the text of the given id to str.
+   */
+  void AppendId(std::string& str, IdHandle id) const;
+
+  std::string GetIdString(IdHandle id) const {
+    std::string str;
+    AppendId(str, id);
+    return str;
+  }
+
+  /**
+   * Finds the handle of an id that was handed out, by its text. Returns false
+   * if it was not handed out, or cannot be told: custom ids are only found
+   * with EXACT tracking. A generated id's handle comes from its number, so it
+   * is found even if whatever had the id has since been removed.
+   */
+  bool FindId(std::string_view id, IdHandle* handle) const;
+
+  /**
+   * Returns true for ids that were made up by the Create functions rather
+   * than given by the user.
+   */
+  static bool IsGeneratedId(IdHandle id) {
+    return GetKind(id) != IdKind::CUSTOM;
+  }
+
+  /**
+   * Number of custom ids handed out, counting those that were renamed.
+   */
+  size_t NumCustomIds() const {
+    return _numCustomIds;
+  }
+
+  /**
+   * Number of custom ids that were already taken, and so were renamed.
+   */
+  size_t NumCollisions() const {
+    return _numCollisions;
+  }
+
+  /**
+   * Bytes of memory taken up by the id table (or Bloom filter).
+   */
+  size_t GetMemoryUsage() const;
+
+  /**
+   * Same as the Create functions above, but return the text of the new id.
+   * The returned reference is only valid until the next call.
+   */
+  const std::string& GetNodeId();
+  const std::string& GetSubgraphId();
+  const std::string& GetClusterId();
+  const std::string& ValidateCustomId(std::string_view customId);
+  const std::string& ValidateCustomClusterId(std::string_view customId);
 };
 
 }  // namespace DotWriter
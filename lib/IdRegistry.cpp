@@ -0,0 +1,106 @@
+#include "IdRegistry.h"
+
+#include <cstring>
+
+namespace DotWriter {
+
+/**
+ * 64-bit FNV-1a.
+ */
+static uint64_t HashId(std::string_view id) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < id.size(); i++) {
+    hash ^= static_cast<unsigned char>(id[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+IdRegistry::IdRegistry(size_t expectedIds) {
+  // At most half full while it holds expectedIds.
+  size_t numSlots = 64;
+  while (numSlots < expectedIds * 2) {
+    numSlots *= 2;
+  }
+
+  _slots = new std::atomic<const Record*>[numSlots];
+  _mask = numSlots - 1;
+  for (size_t i = 0; i < numSlots; i++) {
+    _slots[i].store(NULL, std::memory_order_relaxed);
+  }
+}
+
+IdRegistry::~IdRegistry() {
+  delete[] _slots;
+}
+
+bool IdRegistry::Matches(const Record* record, uint64_t hash,
+  std::string_view id) {
+  return record->hash == hash && record->length == id.size() &&
+    memcmp(record + 1, id.data(), id.size()) == 0;
+}
+
+unsigned IdRegistry::Register(std::string_view id, unsigned owner,
+  Arena& arena) {
+  uint64_t hash = HashId(id);
+  size_t recordSize = sizeof(Record) + id.size();
+  Record* mine = NULL;
+
+  // Linear probing. A slot only ever goes from empty to holding a record,
+  // so anything seen in a slot stays there.
+  size_t pos = hash & _mask;
+  for (size_t probes = 0; probes <= _mask; probes++) {
+    const Record* record = _slots[pos].load(std::memory_order_acquire);
+    if (record == NULL) {
+      if (mine == NULL) {
+        mine = static_cast<Record*>(arena.Allocate(recordSize));
+        mine->hash = hash;
+        mine->owner = owner;
+        mine->length = id.size();
+        memcpy(mine + 1, id.data(), id.size());
+      }
+      if (_slots[pos].compare_exchange_strong(record, mine,
+        std::memory_order_acq_rel, std::memory_order_acquire)) {
+        return owner;
+      }
+      // Somebody else took the slot first; record is now theirs.
+    }
+
+    if (Matches(record, hash, id)) {
+      if (mine != NULL) arena.Deallocate(mine, recordSize);
+      return record->owner;
+    }
+    pos = (pos + 1) & _mask;
+  }
+
+  // Every slot is taken, and none of them by id.
+  if (mine != NULL) arena.Deallocate(mine, recordSize);
+  std::lock_guard<std::mutex> lock(_overflowMutex);
+  return _overflow.insert(std::make_pair(std::string(id), owner)).first->
+    second;
+}
+
+unsigned IdRegistry::Find(std::string_view id) {
+  uint64_t hash = HashId(id);
+  size_t pos = hash & _mask;
+  for (size_t probes = 0; probes <= _mask; probes++) {
+    const Record* record = _slots[pos].load(std::memory_order_acquire);
+    if (record == NULL) return none;
+    if (Matches(record, hash, id)) return record->owner;
+    pos = (pos + 1) & _mask;
+  }
+
+  std::lock_guard<std::mutex> lock(_overflowMutex);
+  std::unordered_map<std::string, unsigned>::const_iterator it =
+    _overflow.find(std::string(id));
+  return it != _overflow.end() ? it->second : none;
+}
+
+void IdRegistry::Clear() {
+  for (size_t i = 0; i <= _mask; i++) {
+    _slots[i].store(NULL, std::memory_order_relaxed);
+  }
+  _overflow.clear();
+}
+
+}  // namespace DotWriter
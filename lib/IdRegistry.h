@@ -0,0 +1,82 @@
+/**
+ * A set of custom ids that any number of threads can add to at once,
+ * without locking. Used by ShardedGraphBuilder to find out which ids are
+ * used by more than one shard.
+ *
+ * The ids live in an open-addressing hash table of atomic pointers. Adding
+ * an id claims its slot with a compare-and-swap, so when two threads add the
+ * same id at the same time, exactly one of them wins and the other one sees
+ * the winner's record. Records are never removed (except by Clear), which is
+ * what makes this safe. The table does not grow: sized by expectedIds, it
+ * stays fast as long as it holds no more than that. Should it ever fill up
+ * entirely, further ids go into a table behind a mutex.
+ */
+
+#ifndef DOTWRITER_IDREGISTRY_H_
+#define DOTWRITER_IDREGISTRY_H_
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <stdint.h>
+
+#include "Arena.h"
+
+namespace DotWriter {
+
+class IdRegistry {
+private:
+  /**
+   * A registered id. The id's text follows the record in memory.
+   */
+  struct Record {
+    uint64_t hash;
+    unsigned owner;
+    unsigned length;
+  };
+
+  std::atomic<const Record*>* _slots;
+  size_t _mask;
+  std::mutex _overflowMutex;
+  std::unordered_map<std::string, unsigned> _overflow;
+
+  static bool Matches(const Record* record, uint64_t hash,
+    std::string_view id);
+
+  // Not copyable.
+  IdRegistry(const IdRegistry&);
+  IdRegistry& operator=(const IdRegistry&);
+
+public:
+  /**
+   * Stands for no owner: see Find.
+   */
+  static const unsigned none = 0xFFFFFFFFU;
+
+  IdRegistry(size_t expectedIds);
+  virtual ~IdRegistry();
+
+  /**
+   * Registers id as owner's, unless somebody registered it already. Returns
+   * whoever registered it first: owner if the id is new. The record is
+   * allocated from arena, which must outlive the registry, or its next
+   * Clear. Each arena must only be used by one thread at a time.
+   */
+  unsigned Register(std::string_view id, unsigned owner, Arena& arena);
+
+  /**
+   * Returns whoever registered id, or none.
+   */
+  unsigned Find(std::string_view id);
+
+  /**
+   * Forgets every id. Must not run while anybody else uses the registry.
+   */
+  void Clear();
+};
+
+}  // namespace DotWriter
+
+#endif
@@ -1,23 +1,57 @@
 #ifndef DOTWRITER_IDABLE_H_
 #define DOTWRITER_IDABLE_H_
 
-#include<string>
+#include <ostream>
+#include <string>
+
+#include "IdManager.h"
 
 namespace DotWriter {
 
 /**
  * Interface for idable objects.
+ *
+ * Only the handle is stored. T looks up the IdManager that holds the id's
+ * text (the one created by its RootGraph) with GetIdManager, so that every
+ * node and graph does not have to carry a pointer to it.
  */
+template <typename T>
 class Idable {
 private:
-  const std::string& _id;  // Managed by a IdManager created by a RootGraph
+  IdHandle _id;
+
+  const IdManager& Ids() const {
+    return static_cast<const T*>(this)->GetIdManager();
+  }
 
 public:
-  Idable(const std::string& id) : _id(id) {};
+  Idable(IdHandle id) : _id(id) {};
 
-  const std::string& GetId() {
+  std::string GetId() const {
+    return Ids().GetIdString(_id);
+  }
+
+  /**
+   * Appends the id to str, which saves building a string for it.
+   */
+  void AppendId(std::string& str) const {
+    Ids().AppendId(str, _id);
+  }
+
+  IdHandle GetIdHandle() const {
     return _id;
   }
+
+  /**
+   * Writes the id without building a string for it.
+   */
+  void PrintId(DotSink& out) const {
+    Ids().PrintId(out, _id);
+  }
+
+  void PrintId(std::ostream& out) const {
+    Ids().PrintId(out, _id);
+  }
 };
 
 }  // namespace DotWriter
@@ -0,0 +1,64 @@
+#include "InputFile.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace DotWriter {
+
+bool InputFile::Open(const std::string& path) {
+  Close();
+  _error.clear();
+
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    _error = "open " + path + ": " + strerror(errno);
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+    void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      // The file is parsed front to back, once.
+      madvise(data, info.st_size, MADV_SEQUENTIAL);
+      close(fd);
+      _data = static_cast<const char*>(data);
+      _size = info.st_size;
+      _mapped = true;
+      return true;
+    }
+  }
+
+  char block[1 << 16];
+  for (;;) {
+    ssize_t count = read(fd, block, sizeof(block));
+    if (count == 0) break;
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      _error = "read " + path + ": " + strerror(errno);
+      _buffer.clear();
+      close(fd);
+      return false;
+    }
+    _buffer.append(block, count);
+  }
+
+  close(fd);
+  _data = _buffer.data();
+  _size = _buffer.size();
+  return true;
+}
+
+void InputFile::Close() {
+  if (_mapped) munmap(const_cast<char*>(_data), _size);
+  _mapped = false;
+  _data = NULL;
+  _size = 0;
+  std::string().swap(_buffer);
+}
+
+}  // namespace DotWriter
@@ -0,0 +1,62 @@
+/**
+ * A file whose whole contents are made available in memory at once, for
+ * parsing.
+ *
+ * Regular files are mapped rather than read, so nothing is copied and pages
+ * are only brought in as they are looked at. Anything that cannot be mapped
+ * (pipes, some special files) is read into a buffer instead.
+ */
+
+#ifndef DOTWRITER_INPUTFILE_H_
+#define DOTWRITER_INPUTFILE_H_
+
+#include <string>
+#include <string_view>
+
+namespace DotWriter {
+
+class InputFile {
+private:
+  const char* _data;
+  size_t _size;
+  bool _mapped;  // Otherwise _data is _buffer's.
+  std::string _buffer;
+  std::string _error;
+
+  // Not copyable.
+  InputFile(const InputFile&);
+  InputFile& operator=(const InputFile&);
+
+public:
+  InputFile() : _data(NULL), _size(0), _mapped(false) {};
+
+  ~InputFile() {
+    Close();
+  }
+
+  /**
+   * Makes the contents of path available. Returns false on failure.
+   */
+  bool Open(const std::string& path);
+
+  /**
+   * Releases the contents. Views returned by GetContents become invalid.
+   */
+  void Close();
+
+  std::string_view GetContents() const {
+    return std::string_view(_data, _size);
+  }
+
+  /**
+   * Describes the first failure, if any, e.g. "open in.dot: No such file or
+   * directory".
+   */
+  const std::string& GetError() const {
+    return _error;
+  }
+};
+
+}  // namespace DotWriter
+
+#endif
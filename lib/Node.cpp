@@ -1,29 +1,78 @@
 #include "Node.h"
+#include "Graph.h"
+#include "GraphView.h"
 #include "Util.h"
 
 namespace DotWriter {
 
+const IdManager& Node::GetIdManager() const {
+  return *_graph->_idManager;
+}
+
+void Node::MarkDirty() {
+  _graph->NodeChanged(this);
+}
+
+NodeAttributeSet& Node::MutableAttributes() {
+  return _style.Mutable(this, _graph->_stylePool);
+}
+
 /**
  * Prints out a string representation of the node (essentially, a line
  * describing it for the DOT file).
  */
-void Node::Print(std::ostream& out) {
+void Node::Print(DotSink& out) const {
+  Print(out, PrintOptions());
+}
+
+void Node::Print(DotSink& out, const PrintOptions& options,
+  const NodeAttributeSet* hoisted) const {
     //Node identifier in the DOT file.
-    out << GetId();
+    PrintId(out);
+
+    //Attributes, including the label, unless a view has its own.
+    const NodeAttributeSet* attributes = &_style.Get();
+    const std::string* label = &_label;
+    if (options.view != NULL) {
+      const GraphView::NodeCopy* copy = options.view->Find(this);
+      if (copy != NULL) {
+        attributes = &copy->attributes;
+        label = &copy->label;
+      }
+    }
+    // Hoisted attributes are printed once, as the graph's node defaults.
+    if (attributes == hoisted) attributes = &SharedNodeStyle::EmptySet();
+    bool open = !attributes->Empty() || !label->empty();
+    if (open) {
+      if (options.compact) {
+        out.Put('[');
+        attributes->PrintWithLabel(out, *label, "", ",", true);
+      } else {
+        out.Write(" [", 2);
+        attributes->PrintWithLabel(out, *label, "", ", ");
+      }
+    }
 
-    //Label
-    if (GetLabel() != "") {
-        _attributes.AddCustomAttribute("label", GetLabel());
+    // Provided attributes come last, so that they win.
+    const TextProvider* provider = _graph->_textProvider;
+    if (provider != NULL) {
+      SinkAttributeWriter writer(out, options.compact, open);
+      provider->AddNodeText(*this, writer);
+      open = writer.IsOpen();
     }
+    if (open) out.Put(']');
 
-    if (!_attributes.Empty()) {
-      out << " [";
-      _attributes.Print(out);
-      out << "]";
+    //Line ending semicolon and newline. Statements need no semicolon.
+    if (options.compact) {
+      out.Put('\n');
+    } else {
+      out.Write(";\n", 2);
     }
+}
 
-    //Line ending semicolon and newline.
-    out << ";\n";
+void Node::Print(std::ostream& out) const {
+  OstreamDotSink sink(out);
+  Print(sink);
 }
 
 }  // namespace DotWriter
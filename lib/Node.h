@@ -3,39 +3,142 @@
 
 #include <ostream>
 #include <string>
+#include <utility>
 
 #include "AttributeSet.h"
 #include "Idable.h"
+#include "PrintOptions.h"
+#include "Style.h"
 
 namespace DotWriter {
 
+class Edge;
+class Graph;
+
 /**
  * Represents a node in a graph.
  */
-class Node : public Idable {
+class Node : public Idable<Node>, public AttributeListener {
 private:
+  unsigned _slot;  // Position in the graph's node list. Packs with the id.
+  Graph* _graph;  // The graph that owns this node.
   std::string _label;
-  NodeAttributeSet _attributes;
+  // Usually shared with other nodes; see SetStyle.
+  SharedNodeStyle _style;
+  // Heads of the lists of edges leaving / entering this node, in every graph
+  // under the same root graph. Maintained by Edge.
+  Edge* _firstOutEdge;
+  Edge* _firstInEdge;
+  unsigned _outDegree;
+  unsigned _inDegree;
+
+  friend class DetailReducer;
+  friend class Edge;
+  friend class Graph;
+  friend class Idable<Node>;
+  friend class Snapshot;
+  template <typename T> friend class SlotList;
+
+  /**
+   * The IdManager of the node's root graph, which holds its id.
+   */
+  const IdManager& GetIdManager() const;
+
+  /**
+   * Lets the graph know that this node's output has changed.
+   */
+  void MarkDirty();
+
+  virtual void AttributesChanged() {
+    MarkDirty();
+  }
 
 public:
-  Node(const std::string& id, std::string label = "") :
-    Idable(id), _label(label) {
+  Node(Graph* graph, IdHandle id, std::string label = "") :
+    Idable(id), _slot(0), _graph(graph), _label(std::move(label)),
+    _firstOutEdge(NULL), _firstInEdge(NULL), _outDegree(0), _inDegree(0) {
   }
   virtual ~Node() {};
 
-  void Print(std::ostream& out);
+  /**
+   * Prints the node's line of a DOT file. Does not change the node.
+   */
+  void Print(DotSink& out) const;
+  void Print(std::ostream& out) const;
+
+  /**
+   * Same as Print, but formatted according to options, and leaving the
+   * attributes out if the node's style is hoisted, i.e. its attributes are
+   * the ones at that address.
+   */
+  void Print(DotSink& out, const PrintOptions& options,
+    const NodeAttributeSet* hoisted = NULL) const;
 
   /** Simple getters / setters **/
-  const std::string& GetLabel() {
+  const std::string& GetLabel() const {
     return _label;
   }
 
   void SetLabel(std::string label) {
-    _label = label;
+    _label = std::move(label);
+    MarkDirty();
   };
 
+  /**
+   * Returns the node's attributes for modification. If the node shares its
+   * style, this gives it a private copy first, so only call it to change
+   * them.
+   */
+  NodeAttributeSet& MutableAttributes();
+
+  /**
+   * Same as MutableAttributes, so it copies a shared style too. Read the
+   * attributes through a const node instead, which leaves them shared.
+   */
   NodeAttributeSet& GetAttributes() {
-    return _attributes;
+    return MutableAttributes();
+  }
+
+  const NodeAttributeSet& GetAttributes() const {
+    return _style.Get();
+  }
+
+  /**
+   * Makes the node share the given style, replacing its attributes. Giving
+   * many nodes the same style saves memory, and lets Graph::SetStyleHoisting
+   * shorten the output.
+   */
+  void SetStyle(const SharedNodeStyle& style) {
+    _style = style;
+    MarkDirty();
+  }
+
+  const SharedNodeStyle& GetStyle() const {
+    return _style;
+  }
+
+  /**
+   * Number of edges leaving / entering this node. Edges are counted by the
+   * direction they were added in, even in undirected graphs.
+   */
+  unsigned OutDegree() const {
+    return _outDegree;
+  }
+
+  unsigned InDegree() const {
+    return _inDegree;
+  }
+
+  /**
+   * First edge leaving / entering this node, or NULL. Continue with
+   * Edge::GetNextOutEdge / Edge::GetNextInEdge.
+   */
+  Edge* GetFirstOutEdge() {
+    return _firstOutEdge;
+  }
+
+  Edge* GetFirstInEdge() {
+    return _firstInEdge;
   }
 };
 
@@ -0,0 +1,40 @@
+#include "OutputCache.h"
+
+namespace DotWriter {
+
+void OutputCache::MarkAllDirty(std::vector<Fragment>& chunks) {
+  std::vector<Fragment>::iterator it;
+  for (it = chunks.begin(); it != chunks.end(); it++) {
+    it->dirty = true;
+  }
+}
+
+void OutputCache::Prepare(unsigned tabDepth, const PrintOptions& options,
+  size_t numNodeSlots, size_t numEdgeSlots) {
+  if (tabDepth != _tabDepth || options != _options) {
+    _tabDepth = tabDepth;
+    _options = options;
+    MarkHeaderDirty();
+    MarkNodesDirty();
+    MarkEdgesDirty();
+  }
+
+  _nodeChunks.resize((numNodeSlots + chunkSize - 1) / chunkSize);
+  _edgeChunks.resize((numEdgeSlots + chunkSize - 1) / chunkSize);
+}
+
+void OutputCache::SetHoistedStyles(bool hoisting,
+  const NodeAttributeSet* nodeStyle, const EdgeAttributeSet* edgeStyle) {
+  // The header holds the hoisted attributes themselves, which may have been
+  // replaced by others at the same address.
+  if (hoisting || _hoistedNodeStyle != NULL || _hoistedEdgeStyle != NULL) {
+    MarkHeaderDirty();
+  }
+  if (nodeStyle != _hoistedNodeStyle) MarkNodesDirty();
+  if (edgeStyle != _hoistedEdgeStyle) MarkEdgesDirty();
+
+  _hoistedNodeStyle = nodeStyle;
+  _hoistedEdgeStyle = edgeStyle;
+}
+
+}  // namespace DotWriter
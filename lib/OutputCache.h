@@ -0,0 +1,119 @@
+/**
+ * The text a graph printed last time, kept so that printing it again only
+ * has to redo the parts that changed.
+ *
+ * The text is cut the same way ParallelPrinter cuts it: a header (the opening
+ * line, the graph's attributes and its defaults), runs of consecutive node
+ * slots and runs of edge slots. The graph marks the pieces a change touches
+ * as dirty, and Graph::Print re-renders those and copies out the rest.
+ * Subgraphs and clusters keep caches of their own; closing braces are not
+ * worth caching.
+ */
+
+#ifndef DOTWRITER_OUTPUTCACHE_H_
+#define DOTWRITER_OUTPUTCACHE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "PrintOptions.h"
+
+namespace DotWriter {
+
+class EdgeAttributeSet;
+class NodeAttributeSet;
+
+class OutputCache {
+public:
+  struct Fragment {
+    std::string text;
+    bool dirty;
+
+    Fragment() : dirty(true) {};
+  };
+
+  // Number of node / edge slots per fragment.
+  static const size_t chunkSize = 256;
+
+private:
+  Fragment _header;
+  std::vector<Fragment> _nodeChunks;
+  std::vector<Fragment> _edgeChunks;
+  // tabDepth and options the text was printed with.
+  unsigned _tabDepth;
+  PrintOptions _options;
+  // Styles that were hoisted into the defaults (see SetHoistedStyles).
+  const NodeAttributeSet* _hoistedNodeStyle;
+  const EdgeAttributeSet* _hoistedEdgeStyle;
+
+  static void MarkDirty(std::vector<Fragment>& chunks, size_t slot) {
+    size_t chunk = slot / chunkSize;
+    // Chunks that do not exist yet start out dirty (see Prepare).
+    if (chunk < chunks.size()) chunks[chunk].dirty = true;
+  }
+
+  static void MarkAllDirty(std::vector<Fragment>& chunks);
+
+public:
+  OutputCache() :
+    _tabDepth(0), _hoistedNodeStyle(NULL), _hoistedEdgeStyle(NULL) {};
+
+  void MarkHeaderDirty() {
+    _header.dirty = true;
+  }
+
+  /**
+   * The element in the given slot has been added, removed or changed.
+   */
+  void MarkNodeDirty(size_t slot) {
+    MarkDirty(_nodeChunks, slot);
+  }
+
+  void MarkEdgeDirty(size_t slot) {
+    MarkDirty(_edgeChunks, slot);
+  }
+
+  /**
+   * Elements have moved to different slots (see SlotList::Compact).
+   */
+  void MarkNodesDirty() {
+    MarkAllDirty(_nodeChunks);
+  }
+
+  void MarkEdgesDirty() {
+    MarkAllDirty(_edgeChunks);
+  }
+
+  /**
+   * Gets ready to print a graph with the given number of node and edge slots
+   * at tabDepth. If tabDepth or options are not what they were last time,
+   * everything is dirty.
+   */
+  void Prepare(unsigned tabDepth, const PrintOptions& options,
+    size_t numNodeSlots, size_t numEdgeSlots);
+
+  /**
+   * Tells the cache which styles this Print hoists (see
+   * Graph::SetStyleHoisting), and so marks what they change as dirty.
+   * hoisting says whether the graph hoists styles at all.
+   */
+  void SetHoistedStyles(bool hoisting, const NodeAttributeSet* nodeStyle,
+    const EdgeAttributeSet* edgeStyle);
+
+  Fragment& GetHeader() {
+    return _header;
+  }
+
+  std::vector<Fragment>& GetNodeChunks() {
+    return _nodeChunks;
+  }
+
+  std::vector<Fragment>& GetEdgeChunks() {
+    return _edgeChunks;
+  }
+};
+
+}  // namespace DotWriter
+
+#endif
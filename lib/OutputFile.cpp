@@ -0,0 +1,95 @@
+#include "OutputFile.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Util.h"
+
+namespace DotWriter {
+
+void OutputFile::SetError(const std::string& what, int error) {
+  if (_error.empty()) _error = what + ": " + strerror(error);
+}
+
+bool OutputFile::Open(const std::string& path,
+  unsigned long long expectedSize) {
+  Discard();
+  _path = path;
+  _error.clear();
+
+  // path.tmp.<pid>.<n>, for the first n that is not taken. The file is
+  // created with the usual permissions, as fopen would.
+  for (unsigned long attempt = 0; _fd < 0; attempt++) {
+    _tempPath = path;
+    _tempPath += ".tmp.";
+    AppendUnsigned(_tempPath, getpid());
+    _tempPath += '.';
+    AppendUnsigned(_tempPath, attempt);
+
+    _fd = open(_tempPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+      0666);
+    if (_fd < 0 && errno != EEXIST) {
+      SetError("open " + _tempPath, errno);
+      _tempPath.clear();
+      return false;
+    }
+  }
+
+#ifdef HAVE_POSIX_FALLOCATE
+  if (expectedSize != 0) {
+    int error = posix_fallocate(_fd, 0, expectedSize);
+    // Not every file system can do this; that is fine.
+    if (error != 0 && error != EINVAL && error != EOPNOTSUPP) {
+      SetError("posix_fallocate " + _tempPath, error);
+      Discard();
+      return false;
+    }
+  }
+#endif
+
+  return true;
+}
+
+bool OutputFile::Commit() {
+  if (_fd < 0) return false;
+
+  off_t size = lseek(_fd, 0, SEEK_CUR);
+  if (size < 0) {
+    SetError("lseek " + _tempPath, errno);
+  } else if (ftruncate(_fd, size) != 0) {
+    SetError("ftruncate " + _tempPath, errno);
+  }
+
+  int fd = _fd;
+  _fd = -1;
+  if (close(fd) != 0) SetError("close " + _tempPath, errno);
+
+  if (_error.empty() && rename(_tempPath.c_str(), _path.c_str()) != 0) {
+    SetError("rename " + _path, errno);
+  }
+
+  if (!_error.empty()) {
+    unlink(_tempPath.c_str());
+    _tempPath.clear();
+    return false;
+  }
+
+  _tempPath.clear();
+  return true;
+}
+
+void OutputFile::Discard() {
+  if (_fd >= 0) {
+    close(_fd);
+    _fd = -1;
+  }
+  if (!_tempPath.empty()) {
+    unlink(_tempPath.c_str());
+    _tempPath.clear();
+  }
+}
+
+}  // namespace DotWriter
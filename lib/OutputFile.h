@@ -0,0 +1,77 @@
+/**
+ * A file that is written under a temporary name and only renamed into place
+ * once it is complete, so readers of the file never see half of it.
+ *
+ * The temporary file lives in the same directory as the final one (renames
+ * do not work across file systems). Space for the expected size is reserved
+ * up front when the file system supports it, to keep the file in one piece
+ * and to fail early when the disk is full.
+ */
+
+#ifndef DOTWRITER_OUTPUTFILE_H_
+#define DOTWRITER_OUTPUTFILE_H_
+
+#include <string>
+
+namespace DotWriter {
+
+class OutputFile {
+private:
+  std::string _path;
+  std::string _tempPath;
+  int _fd;
+  std::string _error;
+
+  void SetError(const std::string& what, int error);
+
+  // Not copyable.
+  OutputFile(const OutputFile&);
+  OutputFile& operator=(const OutputFile&);
+
+public:
+  OutputFile() : _fd(-1) {};
+
+  /**
+   * Discards the file unless it was committed.
+   */
+  ~OutputFile() {
+    Discard();
+  }
+
+  /**
+   * Creates the temporary file for path, reserving expectedSize bytes (0 to
+   * skip this). Returns false on failure.
+   */
+  bool Open(const std::string& path, unsigned long long expectedSize = 0);
+
+  /**
+   * Descriptor to write the contents to, or -1 if the file is not open.
+   */
+  int GetFd() const {
+    return _fd;
+  }
+
+  /**
+   * Cuts the file off at the current write position (dropping any space
+   * reserved beyond it), closes it, and renames it over the final path.
+   * Returns false on failure, in which case the file is discarded.
+   */
+  bool Commit();
+
+  /**
+   * Closes and removes the temporary file, leaving the final path alone.
+   */
+  void Discard();
+
+  /**
+   * Describes the first failure, if any, e.g. "rename out.dot: Permission
+   * denied".
+   */
+  const std::string& GetError() const {
+    return _error;
+  }
+};
+
+}  // namespace DotWriter
+
+#endif
@@ -0,0 +1,165 @@
+#include "ParallelPrinter.h"
+
+#include <thread>
+
+#include "Cluster.h"
+#include "Graph.h"
+#include "Subgraph.h"
+
+namespace DotWriter {
+
+const size_t ParallelPrinter::_chunkSize = 4096;
+const size_t ParallelPrinter::_fragmentsAheadPerThread = 4;
+
+ParallelPrinter::ParallelPrinter(unsigned numThreads) :
+  _numThreads(numThreads), _nextFragment(0), _numWritten(0) {
+  if (_numThreads == 0) _numThreads = std::thread::hardware_concurrency();
+  if (_numThreads == 0) _numThreads = 1;
+}
+
+void ParallelPrinter::AddFragment(const Graph* graph, Fragment::Kind kind,
+  unsigned tabDepth, const Graph::HoistedStyles& hoisted, size_t begin,
+  size_t end) {
+  Fragment fragment;
+  fragment.graph = graph;
+  fragment.kind = kind;
+  fragment.tabDepth = tabDepth;
+  fragment.begin = begin;
+  fragment.end = end;
+  fragment.hoisted = hoisted;
+  _fragments.push_back(fragment);
+}
+
+void ParallelPrinter::AddRanges(const Graph* graph, Fragment::Kind kind,
+  unsigned tabDepth, const Graph::HoistedStyles& hoisted, size_t numSlots) {
+  for (size_t begin = 0; begin < numSlots; begin += _chunkSize) {
+    size_t end = std::min(begin + _chunkSize, numSlots);
+    AddFragment(graph, kind, tabDepth, hoisted, begin, end);
+  }
+}
+
+/**
+ * Follows the same order as Graph::Print / Graph::PrintNECS.
+ */
+void ParallelPrinter::CollectFragments(const Graph* graph, unsigned tabDepth) {
+  Graph::HoistedStyles hoisted = graph->ChooseHoistedStyles();
+  AddFragment(graph, Fragment::HEADER, tabDepth, hoisted);
+  AddRanges(graph, Fragment::NODES, tabDepth, hoisted,
+    graph->_nodes.SlotCount());
+
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = graph->_subgraphs.begin(); sgIt != graph->_subgraphs.end();
+    sgIt++) {
+    CollectFragments(*sgIt, tabDepth + 1);
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = graph->_clusters.begin(); cIt != graph->_clusters.end(); cIt++) {
+    CollectFragments(*cIt, tabDepth + 1);
+  }
+
+  AddRanges(graph, Fragment::EDGES, tabDepth, hoisted,
+    graph->_edges.SlotCount());
+  AddFragment(graph, Fragment::FOOTER, tabDepth, hoisted);
+}
+
+void ParallelPrinter::Render(const Fragment& fragment, DotSink& out) {
+  const Graph* graph = fragment.graph;
+  switch (fragment.kind) {
+    case Fragment::HEADER:
+      graph->PrintHeader(out, _options, fragment.tabDepth);
+      graph->PrintDefaults(out, _options, fragment.tabDepth,
+        fragment.hoisted);
+      break;
+    case Fragment::NODES:
+      graph->PrintNodes(out, _options, fragment.tabDepth, fragment.hoisted,
+        fragment.begin, fragment.end);
+      break;
+    case Fragment::EDGES:
+      graph->PrintEdges(out, _options, fragment.tabDepth, fragment.hoisted,
+        fragment.begin, fragment.end);
+      break;
+    case Fragment::FOOTER:
+      graph->PrintFooter(out, _options, fragment.tabDepth);
+      break;
+  }
+}
+
+void ParallelPrinter::Work() {
+  size_t window = _numThreads * _fragmentsAheadPerThread;
+
+  while (true) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_nextFragment < _fragments.size() &&
+      _nextFragment >= _numWritten + window) {
+      _fragmentWritten.wait(lock);
+    }
+    if (_nextFragment >= _fragments.size()) return;
+    size_t i = _nextFragment++;
+    lock.unlock();
+
+    std::string text;
+    {
+      StringDotSink sink(text);
+      Render(_fragments[i], sink);
+    }
+
+    lock.lock();
+    _buffers[i].swap(text);
+    _done[i] = true;
+    _fragmentDone.notify_one();
+  }
+}
+
+void ParallelPrinter::Print(const Graph& graph, DotSink& out,
+  const PrintOptions& options, unsigned tabDepth) {
+  if (_numThreads <= 1) {
+    graph.Print(out, options, tabDepth);
+    return;
+  }
+
+  _options = options;
+  // Fragments are rendered out of order, on several threads.
+  _options.stats = NULL;
+  _fragments.clear();
+  CollectFragments(&graph, tabDepth);
+  _buffers.assign(_fragments.size(), std::string());
+  _done.assign(_fragments.size(), false);
+  _nextFragment = 0;
+  _numWritten = 0;
+
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < _numThreads; i++) {
+    workers.push_back(std::thread(&ParallelPrinter::Work, this));
+  }
+
+  // Write the fragments out in order, as they are finished.
+  std::string text;
+  for (size_t i = 0; i < _fragments.size(); i++) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      while (!_done[i]) _fragmentDone.wait(lock);
+      text.swap(_buffers[i]);
+    }
+
+    out.Write(text);
+    std::string().swap(text);
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _numWritten = i + 1;
+    }
+    _fragmentWritten.notify_all();
+  }
+
+  std::vector<std::thread>::iterator it;
+  for (it = workers.begin(); it != workers.end(); it++) {
+    it->join();
+  }
+
+  _fragments.clear();
+  _buffers.clear();
+  _done.clear();
+}
+
+}  // namespace DotWriter
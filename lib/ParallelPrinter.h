@@ -0,0 +1,100 @@
+/**
+ * Prints a graph on several threads at once.
+ *
+ * The output is first cut into an ordered list of fragments: the header and
+ * footer of every graph, and runs of its nodes and edges. Concatenating the
+ * fragments in order gives exactly what Graph::Print produces. Worker
+ * threads take the next fragment off the list, and render it into a buffer
+ * of its own, while the calling thread writes the finished buffers to the
+ * sink in order. Workers never get more than a fixed number of fragments
+ * ahead of the writer, so memory use does not grow with the graph.
+ *
+ * Used by RootGraph::PrintParallel.
+ */
+
+#ifndef DOTWRITER_PARALLELPRINTER_H_
+#define DOTWRITER_PARALLELPRINTER_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "DotSink.h"
+#include "Graph.h"
+#include "PrintOptions.h"
+
+namespace DotWriter {
+
+class ParallelPrinter {
+private:
+  struct Fragment {
+    enum Kind {
+      HEADER,  // Opening line, attributes and defaults.
+      NODES,
+      EDGES,
+      FOOTER
+    };
+
+    const Graph* graph;
+    Kind kind;
+    unsigned tabDepth;
+    // Slot range, for NODES and EDGES.
+    size_t begin;
+    size_t end;
+    Graph::HoistedStyles hoisted;
+  };
+
+  unsigned _numThreads;
+  PrintOptions _options;
+  std::vector<Fragment> _fragments;
+  std::vector<std::string> _buffers;
+  std::vector<bool> _done;
+  // Next fragment to hand to a worker, and number written to the sink.
+  size_t _nextFragment;
+  size_t _numWritten;
+  std::mutex _mutex;
+  // Signalled when a fragment is done / when the writer catches up.
+  std::condition_variable _fragmentDone;
+  std::condition_variable _fragmentWritten;
+
+  // Number of slots per NODES / EDGES fragment.
+  static const size_t _chunkSize;
+  // How many fragments per thread may be rendered ahead of the writer.
+  static const size_t _fragmentsAheadPerThread;
+
+  void AddFragment(const Graph* graph, Fragment::Kind kind, unsigned tabDepth,
+    const Graph::HoistedStyles& hoisted, size_t begin = 0, size_t end = 0);
+  void AddRanges(const Graph* graph, Fragment::Kind kind, unsigned tabDepth,
+    const Graph::HoistedStyles& hoisted, size_t numSlots);
+  void CollectFragments(const Graph* graph, unsigned tabDepth);
+  void Render(const Fragment& fragment, DotSink& out);
+  void Work();
+
+  // Not copyable.
+  ParallelPrinter(const ParallelPrinter&);
+  ParallelPrinter& operator=(const ParallelPrinter&);
+
+public:
+  /**
+   * numThreads: Number of worker threads. 0 means one per core.
+   */
+  ParallelPrinter(unsigned numThreads = 0);
+
+  /**
+   * With just one, Print simply calls graph.Print.
+   */
+  unsigned GetNumThreads() const {
+    return _numThreads;
+  }
+
+  /**
+   * Prints graph (as graph.Print(out, options, tabDepth) would) to out.
+   */
+  void Print(const Graph& graph, DotSink& out, const PrintOptions& options,
+    unsigned tabDepth);
+};
+
+}  // namespace DotWriter
+
+#endif
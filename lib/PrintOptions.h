@@ -0,0 +1,100 @@
+/**
+ * Settings that change how a graph is printed, without changing the graph.
+ */
+
+#ifndef DOTWRITER_PRINTOPTIONS_H_
+#define DOTWRITER_PRINTOPTIONS_H_
+
+#include <cstddef>
+
+namespace DotWriter {
+
+class GraphView;
+class Node;
+class PrintStats;
+
+/**
+ * Weight of a node, for PrintOptions::maxNodes. context is
+ * PrintOptions::weightContext.
+ */
+typedef double (*NodeWeight)(const Node* node, void* context);
+
+struct PrintOptions {
+  /**
+   * Output meant for programs rather than people: no indentation or optional
+   * punctuation, attribute values are only quoted when DOT requires it, and
+   * runs of edges with the same attributes are combined into chains
+   * (a->b->c) and fan-outs (a->{b c d}).
+   */
+  bool compact;
+
+  /**
+   * If set, Print adds the time and bytes spent on each phase of printing to
+   * these stats. NULL (the default) means that nothing is measured. Has no
+   * effect on the output, so it is not compared by operator==.
+   */
+  PrintStats* stats;
+
+  /**
+   * Level of detail, for overviews of graphs too big to lay out. These leave
+   * the graph alone, and only change what RootGraph::Print (and so
+   * WriteToFile and PrintParallel) writes; see DetailReducer. 0 means no
+   * limit.
+   * - collapseDepth: Clusters this deep (top-level clusters are at depth 1)
+   *   are printed as a single node that stands for everything inside of
+   *   them. Edges to and from it are combined into one per pair of nodes,
+   *   labelled with how many edges it stands for.
+   * - collapseSize: Same, for clusters that hold more than this many nodes,
+   *   counting their subgraphs and clusters.
+   * - maxNodes: Only this many nodes, counting collapsed clusters, are kept:
+   *   those with the highest weight. Edges are only kept if both ends are.
+   * - nodeWeight, weightContext: The weight of a node. A collapsed cluster
+   *   weighs as much as its nodes together. NULL (the default) weighs each
+   *   node by its number of edges.
+   * - maxParallelEdges: Only the first this many edges between the same two
+   *   nodes are kept.
+   */
+  unsigned collapseDepth;
+  size_t collapseSize;
+  size_t maxNodes;
+  NodeWeight nodeWeight;
+  void* weightContext;
+  size_t maxParallelEdges;
+
+  /**
+   * If set, nodes and edges are printed the way view has them, and the
+   * graph's output cache is not used (see GraphView). Set by
+   * GraphView::Print, rather than by hand.
+   */
+  const GraphView* view;
+
+  PrintOptions() :
+    compact(false), stats(NULL), collapseDepth(0), collapseSize(0),
+    maxNodes(0), nodeWeight(NULL), weightContext(NULL),
+    maxParallelEdges(0), view(NULL) {};
+
+  /**
+   * Returns true if any of the level of detail settings are on.
+   */
+  bool ReducesDetail() const {
+    return collapseDepth != 0 || collapseSize != 0 || maxNodes != 0 ||
+      maxParallelEdges != 0;
+  }
+
+  bool operator==(const PrintOptions& other) const {
+    return compact == other.compact &&
+      collapseDepth == other.collapseDepth &&
+      collapseSize == other.collapseSize && maxNodes == other.maxNodes &&
+      nodeWeight == other.nodeWeight &&
+      weightContext == other.weightContext &&
+      maxParallelEdges == other.maxParallelEdges && view == other.view;
+  }
+
+  bool operator!=(const PrintOptions& other) const {
+    return !(*this == other);
+  }
+};
+
+}  // namespace DotWriter
+
+#endif
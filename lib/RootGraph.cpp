@@ -1,48 +1,247 @@
 #include "RootGraph.h"
 
-#include <iostream>
-#include <fstream>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
 
+#include "DetailReducer.h"
+#include "DotParser.h"
+#include "InputFile.h"
+#include "OutputFile.h"
+#include "ParallelPrinter.h"
+#include "Snapshot.h"
 #include "Subgraph.h"
 
 namespace DotWriter {
 
+// Files are written in blocks of this size.
+static const size_t fileBlockSize = 1 << 20;
+
+static bool Failed(std::string* error, const std::string& what) {
+  if (error != NULL) *error = what;
+  return false;
+}
+
+RootGraph* RootGraph::ReadFromFile(const std::string& filename,
+  std::string* error) {
+  InputFile file;
+  if (!file.Open(filename)) {
+    Failed(error, file.GetError());
+    return NULL;
+  }
+
+  DotParser parser(file.GetContents());
+  RootGraph* graph = parser.Parse();
+  if (graph == NULL) Failed(error, filename + ": " + parser.GetError());
+  return graph;
+}
+
+RootGraph* RootGraph::Parse(std::string_view text, std::string* error) {
+  DotParser parser(text);
+  RootGraph* graph = parser.Parse();
+  if (graph == NULL) Failed(error, parser.GetError());
+  return graph;
+}
+
 /**
  * Outputs the graph as a dot file to the given filepath.
  * The path can be relative or absolute.
  *
  * Returns false if the operation fails, e.g. due to being unable to open the file.
  */
-bool RootGraph::WriteToFile(const std::string& filename) {
-  //Ensure that we can write to filename.
-  std::ofstream outFile;
-  outFile.open(filename.c_str(), std::ios::out);
+bool RootGraph::WriteToFile(const std::string& filename,
+  std::string* error) const {
+  return WriteToFile(filename, PrintOptions(), Compression::NONE, 0, error);
+}
 
-  if (outFile.fail()) return false;
+bool RootGraph::WriteToFile(const std::string& filename,
+  Compression::e compression, int level, std::string* error) const {
+  return WriteToFile(filename, PrintOptions(), compression, level, error);
+}
 
-  Print(outFile);
+bool RootGraph::WriteToFile(const std::string& filename,
+  const PrintOptions& options, Compression::e compression, int level,
+  std::string* error) const {
+  if (compression == Compression::NONE) {
+    OutputFile file;
+    // Nothing is reserved for reduced graphs, whose size is hard to guess.
+    unsigned long long expectedSize = options.ReducesDetail() ? 0 :
+      EstimateOutputSize(1);
+    if (!file.Open(filename, expectedSize)) {
+      return Failed(error, file.GetError());
+    }
 
-  outFile.close();
+    {
+      FdDotSink sink(file.GetFd(), fileBlockSize);
+      Print(sink, options);
+      if (!sink.Flush()) return Failed(error, sink.GetError());
+    }
 
+    if (!file.Commit()) return Failed(error, file.GetError());
+    return true;
+  }
+
+  if (!CompressedDotSink::IsSupported(compression)) {
+    return Failed(error, "compression method not supported by this build");
+  }
+
+  // The compressed size is anyone's guess, so nothing is reserved.
+  OutputFile file;
+  if (!file.Open(filename)) return Failed(error, file.GetError());
+
+  // The stream gets a descriptor of its own, which shares the file offset.
+  int fd = dup(file.GetFd());
+  FILE* outFile = fd < 0 ? NULL : fdopen(fd, "wb");
+  if (outFile == NULL) {
+    std::string what = std::string("fdopen: ") + strerror(errno);
+    if (fd >= 0) close(fd);
+    return Failed(error, what);
+  }
+
+  std::string sinkError;
+  {
+    CompressedDotSink sink(outFile, compression, level, fileBlockSize);
+    Print(sink, options);
+    if (!sink.Close()) sinkError = sink.GetError();
+  }
+
+  if (fclose(outFile) != 0 && sinkError.empty()) {
+    sinkError = std::string("fclose: ") + strerror(errno);
+  }
+  if (!sinkError.empty()) return Failed(error, sinkError);
+
+  if (!file.Commit()) return Failed(error, file.GetError());
   return true;
 }
 
-void RootGraph::Print(std::ostream& out, unsigned tabDepth) {
-  out << (IsDigraph() ? "digraph " : "graph ") << GetId() << " {\n";
-  std::string linePrefix = std::string(tabDepth*_tabIncrement, _tabCharacter);
+bool RootGraph::WriteSnapshot(const std::string& filename,
+  std::string* error) const {
+  return Snapshot::Write(*this, filename, error);
+}
+
+RootGraph* RootGraph::ReadSnapshot(const std::string& filename,
+  std::string* error) {
+  Snapshot snapshot;
+  if (!snapshot.Open(filename)) {
+    Failed(error, snapshot.GetError());
+    return NULL;
+  }
+  return snapshot.ToGraph();
+}
 
-  if (_label.compare("") != 0) {
-    _attributes.AddCustomAttribute("label", _label);
+GraphDiff RootGraph::Diff(const RootGraph& a, const RootGraph& b) {
+  return GraphMatcher::Diff(a, b);
+}
+
+GraphStats RootGraph::GetStats() const {
+  GraphStats stats;
+  std::unordered_set<const AttributeSet*> seen;
+  seen.insert(&_attributes);
+  stats.numAttributeSets = 1;
+  stats.attributeBytes = _attributes.GetMemoryUsage();
+  AddStats(stats, seen);
+
+  stats.numCustomIds = _idManager->NumCustomIds();
+  stats.idTableBytes = _idManager->GetMemoryUsage();
+  stats.numIdCollisions = _idManager->NumCollisions();
+  stats.arenaBytes = _arena->GetReservedBytes() +
+    _stylePool->GetReservedBytes();
+  return stats;
+}
+
+void RootGraph::Print(DotSink& out, const PrintOptions& options,
+  unsigned tabDepth) const {
+  if (_statsCallback == NULL || options.stats != NULL) {
+    PrintDetail(out, options, tabDepth);
+  } else {
+    PrintStats stats;
+    PrintOptions withStats = options;
+    withStats.stats = &stats;
+    PrintDetail(out, withStats, tabDepth);
+    _statsCallback(GetStats(), stats, _statsContext);
+    return;
+  }
+
+  if (_statsCallback != NULL) {
+    _statsCallback(GetStats(), *options.stats, _statsContext);
   }
+}
 
-  if (!_attributes.Empty()) {
-    _attributes.Print(out, linePrefix);
-    out << ";\n";
+void RootGraph::PrintDetail(DotSink& out, const PrintOptions& options,
+  unsigned tabDepth) const {
+  if (!options.ReducesDetail()) {
+    Graph::Print(out, options, tabDepth);
+    return;
   }
 
-  PrintNECS(out, tabDepth);
+  // The reduced graph already looks the way the view has it, and is only
+  // printed here.
+  RootGraph* reduced = DetailReducer::Reduce(*this, options);
+  PrintOptions reducedOptions = options;
+  reducedOptions.view = NULL;
+  reduced->Graph::Print(out, reducedOptions, tabDepth);
+  delete reduced;
+}
+
+void RootGraph::PrintParallel(DotSink& out, unsigned numThreads) const {
+  PrintParallel(out, PrintOptions(), numThreads);
+}
+
+void RootGraph::PrintParallel(std::ostream& out, unsigned numThreads) const {
+  PrintParallel(out, PrintOptions(), numThreads);
+}
+
+void RootGraph::PrintParallel(DotSink& out, const PrintOptions& options,
+  unsigned numThreads) const {
+  ParallelPrinter printer(numThreads);
+  if (options.ReducesDetail() && printer.GetNumThreads() > 1) {
+    // With one thread, Print reduces the graph itself.
+    RootGraph* reduced = DetailReducer::Reduce(*this, options);
+    printer.Print(*reduced, out, options, 1);
+    delete reduced;
+  } else {
+    printer.Print(*this, out, options, 1);
+  }
+
+  // With one thread, Print already called the callback.
+  if (_statsCallback != NULL && printer.GetNumThreads() > 1) {
+    _statsCallback(GetStats(), PrintStats(), _statsContext);
+  }
+}
+
+void RootGraph::PrintParallel(std::ostream& out, const PrintOptions& options,
+  unsigned numThreads) const {
+  OstreamDotSink sink(out);
+  PrintParallel(sink, options, numThreads);
+}
+
+void RootGraph::PrintHeader(DotSink& out, const PrintOptions& options,
+  unsigned tabDepth) const {
+  out.Write(IsDigraph() ? "digraph " : "graph ");
+  PrintId(out);
+  if (options.compact) {
+    out.Write("{\n");
+    if (!_attributes.Empty() || !_label.empty()) {
+      _attributes.PrintWithLabel(out, _label, "", "\n", true);
+      out.Put('\n');
+    }
+    return;
+  }
+
+  out.Write(" {\n");
+  std::string linePrefix = std::string(tabDepth*_tabIncrement, _tabCharacter);
+
+  // The label is printed along with the attributes.
+  if (!_attributes.Empty() || !_label.empty()) {
+    _attributes.PrintWithLabel(out, _label, linePrefix, ";\n");
+    out.Write(";\n");
+  }
+}
 
-  out << "}\n";
+void RootGraph::PrintFooter(DotSink& out, const PrintOptions& /*options*/,
+  unsigned /*tabDepth*/) const {
+  out.Write("}\n");
 }
 
 }  // namespace DotWriter
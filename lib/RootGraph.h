@@ -8,6 +8,7 @@
 #define DOTWRITER_ROOTGRAPH_H_
 
 #include "AttributeSet.h"
+#include "CompressedDotSink.h"
 #include "Graph.h"
 
 namespace DotWriter {
@@ -15,33 +16,167 @@ namespace DotWriter {
 class RootGraph : public Graph {
 private:
   GraphAttributeSet _attributes;
+  StatsCallback _statsCallback;
+  void* _statsContext;
+
+  /**
+   * Same as Graph::Print, but prints a reduced copy of the graph instead if
+   * options call for one (see DetailReducer).
+   */
+  void PrintDetail(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth) const;
 
 public:
-  RootGraph(bool isDigraph = false) : Graph(new IdManager(), isDigraph),
-    _attributes(GraphAttributeSet()) {};
-  RootGraph(bool isDigraph, const std::string& label) :
-    Graph(new IdManager(), isDigraph, label), _attributes(GraphAttributeSet())
-  {};
-  RootGraph(bool isDigraph, const std::string& label, std::string id) :
-    Graph(new IdManager(), isDigraph, label, id), _attributes(GraphAttributeSet())
-  {};
+  RootGraph(bool isDigraph = false) :
+    Graph(new IdManager(), new Arena(), new StylePool(), isDigraph),
+    _attributes(GraphAttributeSet()), _statsCallback(NULL),
+    _statsContext(NULL) {
+    _attributes.SetListener(this);
+  }
+  RootGraph(bool isDigraph, std::string label) :
+    Graph(new IdManager(), new Arena(), new StylePool(), isDigraph,
+      std::move(label)),
+    _attributes(GraphAttributeSet()), _statsCallback(NULL),
+    _statsContext(NULL) {
+    _attributes.SetListener(this);
+  }
+  RootGraph(bool isDigraph, std::string label, std::string_view id) :
+    Graph(new IdManager(), new Arena(), new StylePool(), isDigraph,
+      std::move(label), id),
+    _attributes(GraphAttributeSet()), _statsCallback(NULL),
+    _statsContext(NULL) {
+    _attributes.SetListener(this);
+  }
 
   virtual ~RootGraph() {
+    // Everything in the graph lives in the arena, so it has to go first.
+    DestroyContents();
+    delete _arena;
     delete _idManager;
+    // Styles taken from the pool may still be in use elsewhere.
+    _stylePool->Release();
   }
 
   GraphAttributeSet& GetAttributes() {
     return _attributes;
   }
 
+  const GraphAttributeSet& GetAttributes() const {
+    return _attributes;
+  }
+
+  /**
+   * Reads a graph back from the DOT file at filename (see DotParser for how
+   * DOT maps onto DotWriter's graphs). The file is mapped rather than read
+   * where possible.
+   *
+   * Returns the new graph, which the caller owns, or NULL if the file
+   * cannot be read or parsed. If error is given, it receives a description
+   * of what went wrong.
+   */
+  static RootGraph* ReadFromFile(const std::string& filename,
+    std::string* error = NULL);
+
+  /**
+   * Same as above, but parses DOT text that is already in memory.
+   */
+  static RootGraph* Parse(std::string_view text, std::string* error = NULL);
+
   /**
    * Writes the graph to the specified filename in the DOT format.
    *
-   * Returns true if successful, false otherwise.
+   * The file is written under a temporary name and renamed into place at the
+   * end (see OutputFile), so nobody ever sees a partial file, and a failed
+   * write leaves any existing file alone.
+   *
+   * Returns true if successful, false otherwise. If error is given, it
+   * receives a description of what went wrong.
+   */
+  bool WriteToFile(const std::string& filename,
+    std::string* error = NULL) const;
+
+  /**
+   * Same as above, but compresses the file as it is written (see
+   * CompressedDotSink). level 0 means the codec's default. Fails if this
+   * build does not support the given compression.
+   */
+  bool WriteToFile(const std::string& filename, Compression::e compression,
+    int level = 0, std::string* error = NULL) const;
+
+  /**
+   * Same as above, but printed according to options.
+   */
+  bool WriteToFile(const std::string& filename, const PrintOptions& options,
+    Compression::e compression = Compression::NONE, int level = 0,
+    std::string* error = NULL) const;
+
+  /**
+   * Writes a binary snapshot of the graph to filename (see Snapshot), which
+   * can be printed or queried later without building the graph again. Like
+   * Print, this must not run while the graph is being printed.
+   */
+  bool WriteSnapshot(const std::string& filename,
+    std::string* error = NULL) const;
+
+  /**
+   * Builds a graph from a snapshot written by WriteSnapshot. Returns the new
+   * graph, which the caller owns, or NULL on failure.
+   */
+  static RootGraph* ReadSnapshot(const std::string& filename,
+    std::string* error = NULL);
+
+  /**
+   * Compares graph a with graph b (see GraphDiff).
+   */
+  static GraphDiff Diff(const RootGraph& a, const RootGraph& b);
+
+  /**
+   * Counts what the graph holds (see GraphStats). This walks the whole graph.
+   */
+  GraphStats GetStats() const;
+
+  /**
+   * Has callback called with GetStats and the PrintStats of every Print
+   * (including WriteToFile and PrintParallel, whose PrintStats are empty),
+   * once the output is written. NULL turns it back off. If the PrintOptions
+   * given to Print have stats of their own, those are what the callback
+   * sees; otherwise they are collected just for it.
+   */
+  void SetStatsCallback(StatsCallback callback, void* context = NULL) {
+    _statsCallback = callback;
+    _statsContext = context;
+  }
+
+  virtual void Print(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth = 1) const;
+  void Print(std::ostream& out, const PrintOptions& options,
+    unsigned tabDepth = 1) const {
+    Graph::Print(out, options, tabDepth);
+  }
+  void Print(DotSink& out, unsigned tabDepth = 1) const {
+    Graph::Print(out, tabDepth);
+  }
+  void Print(std::ostream& out, unsigned tabDepth = 1) const {
+    Graph::Print(out, tabDepth);
+  }
+
+  /**
+   * Same as Print, but splits the work across numThreads threads (0 means one
+   * per core). The output is exactly what Print produces. The graph must not
+   * be modified until this returns.
    */
-  bool WriteToFile(const std::string& filename);
+  void PrintParallel(DotSink& out, unsigned numThreads = 0) const;
+  void PrintParallel(std::ostream& out, unsigned numThreads = 0) const;
+  void PrintParallel(DotSink& out, const PrintOptions& options,
+    unsigned numThreads = 0) const;
+  void PrintParallel(std::ostream& out, const PrintOptions& options,
+    unsigned numThreads = 0) const;
 
-  virtual void Print(std::ostream& out, unsigned tabDepth = 1);
+protected:
+  virtual void PrintHeader(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth) const;
+  virtual void PrintFooter(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth) const;
 };
 
 }  // namespace DotWriter
@@ -0,0 +1,224 @@
+/**
+ * An insertion ordered list of graph elements with O(1) removal.
+ *
+ * Each element remembers the slot it occupies, so removing it just clears the
+ * slot (leaving a tombstone) instead of searching for it and shifting
+ * everything after it. Iteration skips tombstones, so elements always come
+ * out in the order they were added.
+ *
+ * T must have an 'unsigned _slot' member that SlotList can access.
+ */
+
+#ifndef DOTWRITER_SLOTLIST_H_
+#define DOTWRITER_SLOTLIST_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace DotWriter {
+
+/**
+ * A run of consecutive slots of a SlotList, as a plain array. Removed
+ * elements show up as NULL. Only valid until the list is next changed.
+ */
+template <typename T>
+class SlotRange {
+private:
+  T * const * _begin;
+  T * const * _end;
+
+public:
+  SlotRange() : _begin(NULL), _end(NULL) {};
+  SlotRange(T * const * begin, T * const * end) : _begin(begin), _end(end) {};
+
+  T * const * begin() const {
+    return _begin;
+  }
+
+  T * const * end() const {
+    return _end;
+  }
+
+  size_t Size() const {
+    return _end - _begin;
+  }
+
+  T * operator[](size_t i) const {
+    return _begin[i];
+  }
+};
+
+template <typename T>
+class SlotList {
+private:
+  std::vector<T *> _slots;
+  // Number of tombstones in _slots.
+  size_t _numDead;
+
+  // Tombstones are reclaimed automatically once there are at least this many
+  // of them, and they outnumber the live elements.
+  static const size_t _minDeadToCompact = 64;
+
+public:
+  /**
+   * Iterates over the live elements, in insertion order.
+   */
+  class iterator {
+  private:
+    T * const * _pos;
+    T * const * _end;
+
+    void SkipDead() {
+      while (_pos != _end && *_pos == NULL) _pos++;
+    }
+
+  public:
+    iterator() : _pos(NULL), _end(NULL) {};
+
+    iterator(T * const * pos, T * const * end) : _pos(pos), _end(end) {
+      SkipDead();
+    }
+
+    T * operator*() const {
+      return *_pos;
+    }
+
+    iterator& operator++() {
+      _pos++;
+      SkipDead();
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator old = *this;
+      ++(*this);
+      return old;
+    }
+
+    bool operator==(const iterator& other) const {
+      return _pos == other._pos;
+    }
+
+    bool operator!=(const iterator& other) const {
+      return _pos != other._pos;
+    }
+  };
+
+  SlotList() : _numDead(0) {};
+
+  iterator begin() const {
+    return iterator(_slots.data(), _slots.data() + _slots.size());
+  }
+
+  iterator end() const {
+    return iterator(_slots.data() + _slots.size(),
+      _slots.data() + _slots.size());
+  }
+
+  /**
+   * Iterates from the given slot onwards. Slots are numbered in insertion
+   * order, from 0 to SlotCount(); [IteratorAt(a), IteratorAt(b)) covers the
+   * live elements in slots a to b - 1.
+   */
+  iterator IteratorAt(size_t slot) const {
+    return iterator(_slots.data() + slot, _slots.data() + _slots.size());
+  }
+
+  /**
+   * Slots [begin, end) as an array.
+   */
+  SlotRange<T> RangeAt(size_t begin, size_t end) const {
+    return SlotRange<T>(_slots.data() + begin, _slots.data() + end);
+  }
+
+  /**
+   * Number of slots, including those of removed elements.
+   */
+  size_t SlotCount() const {
+    return _slots.size();
+  }
+
+  /**
+   * Number of live elements.
+   */
+  size_t Size() const {
+    return _slots.size() - _numDead;
+  }
+
+  bool Empty() const {
+    return Size() == 0;
+  }
+
+  void Reserve(size_t size) {
+    _slots.reserve(size);
+  }
+
+  /**
+   * Makes room for count more elements. Unlike Reserve, grows the list
+   * geometrically, so calling this before every few insertions is fine.
+   */
+  void ReserveMore(size_t count) {
+    size_t size = _slots.size() + count;
+    if (size <= _slots.capacity()) return;
+    _slots.reserve(size < 2 * _slots.capacity() ? 2 * _slots.capacity() : size);
+  }
+
+  void PushBack(T * item) {
+    item->_slot = _slots.size();
+    _slots.push_back(item);
+  }
+
+  /**
+   * Returns true if item is in this list.
+   */
+  bool Contains(const T * item) const {
+    return item->_slot < _slots.size() && _slots[item->_slot] == item;
+  }
+
+  /**
+   * Removes item in O(1). Returns false (and does nothing) if item is not in
+   * this list.
+   */
+  bool Remove(T * item) {
+    if (!Contains(item)) return false;
+
+    _slots[item->_slot] = NULL;
+    _numDead++;
+
+    if (_numDead >= _minDeadToCompact && _numDead * 2 > _slots.size()) {
+      Compact();
+    }
+    return true;
+  }
+
+  /**
+   * Reclaims the space held by removed elements. Order is preserved.
+   */
+  void Compact() {
+    if (_numDead == 0) return;
+
+    size_t live = 0;
+    for (size_t i = 0; i < _slots.size(); i++) {
+      T * item = _slots[i];
+      if (item == NULL) continue;
+      item->_slot = live;
+      _slots[live++] = item;
+    }
+
+    _slots.resize(live);
+    _numDead = 0;
+
+    if (_slots.capacity() > 2 * live) {
+      std::vector<T *>(_slots).swap(_slots);
+    }
+  }
+
+  void Clear() {
+    _slots.clear();
+    _numDead = 0;
+  }
+};
+
+}  // namespace DotWriter
+
+#endif
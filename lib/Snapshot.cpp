@@ -0,0 +1,1010 @@
+#include "Snapshot.h"
+
+#include <cstring>
+#include <unordered_map>
+
+#include "Cluster.h"
+#include "Edge.h"
+#include "Node.h"
+#include "OutputCache.h"
+#include "OutputFile.h"
+#include "RootGraph.h"
+#include "Subgraph.h"
+
+namespace DotWriter {
+
+/**
+ * The file starts with this header. Every section after it begins on an
+ * 8-byte boundary. Strings are referred to by their offset in the string
+ * section, where each one is its length (a uint32_t), its bytes and a NUL.
+ * Offset 0 always holds the empty string.
+ */
+struct Snapshot::Header {
+  char magic[8];
+  uint32_t version;
+  // byteOrderMark as the writer stored it.
+  uint32_t byteOrder;
+  // sizeof(Attribute) for the writer, which packed attribute sets depend on.
+  uint32_t attributeSize;
+  uint32_t flags;
+  uint32_t numGraphs;
+  uint32_t numNodes;
+  uint32_t numEdges;
+  uint32_t numSets;
+  uint64_t indexSize;
+  uint64_t fileSize;
+  uint64_t stringsOffset;
+  uint64_t stringsSize;
+  uint64_t graphsOffset;
+  uint64_t nodesOffset;
+  uint64_t edgesOffset;
+  // numSets + 1 offsets into the set section; set i ends where i + 1 starts.
+  uint64_t setOffsetsOffset;
+  uint64_t setsOffset;
+  uint64_t setsSize;
+  uint64_t indexOffset;
+};
+
+struct Snapshot::GraphRecord {
+  uint64_t id;
+  uint64_t label;
+  uint32_t kind;
+  uint32_t parent;
+  uint32_t firstChild;
+  uint32_t nextSibling;
+  uint32_t firstNode;
+  uint32_t numNodes;
+  uint32_t firstEdge;
+  uint32_t numEdges;
+  // Attribute sets. Set 0 is always the empty set.
+  uint32_t attributes;
+  uint32_t nodeDefaults;
+  uint32_t edgeDefaults;
+  // The styles Print hoists into the defaults, or none.
+  uint32_t hoistedNodeStyle;
+  uint32_t hoistedEdgeStyle;
+  uint32_t flags;
+};
+
+struct Snapshot::NodeRecord {
+  uint64_t id;
+  uint64_t label;
+  uint32_t graph;
+  uint32_t style;
+};
+
+struct Snapshot::EdgeRecord {
+  uint64_t label;
+  uint32_t src;
+  uint32_t dst;
+  uint32_t style;
+  // Compact output only joins edges with the same chunk into one statement
+  // (see Graph::PrintEdgeRuns).
+  uint32_t chunk;
+};
+
+static const char magic[8] = { 'D', 'W', 'S', 'N', 'A', 'P', '\r', '\n' };
+static const uint32_t version = 1;
+static const uint32_t byteOrderMark = 0x01020304U;
+
+// Header flags.
+static const uint32_t digraphFlag = 1;
+// Graph flags.
+static const uint32_t hoistFlag = 1;
+
+static uint64_t Align(uint64_t offset) {
+  return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+
+/**
+ * 32-bit FNV-1a, with a final avalanche (see DotParser). Part of the file
+ * format, since the node index is stored.
+ */
+static uint32_t HashId(std::string_view id) {
+  uint32_t hash = 2166136261U;
+  for (size_t i = 0; i < id.size(); i++) {
+    hash ^= static_cast<unsigned char>(id[i]);
+    hash *= 16777619U;
+  }
+  hash ^= hash >> 16;
+  hash *= 0x85EBCA6BU;
+  hash ^= hash >> 13;
+  return hash;
+}
+
+/**
+ * Turns a graph into the sections of a snapshot. Graphs are numbered in the
+ * order Print visits them, and all nodes are numbered before any edge refers
+ * to them.
+ */
+class Snapshot::Builder {
+private:
+  std::string _strings;
+  std::vector<GraphRecord> _graphRecords;
+  std::vector<const Graph*> _graphs;
+  std::vector<NodeRecord> _nodes;
+  std::vector<EdgeRecord> _edges;
+  std::string _sets;
+  std::vector<uint64_t> _setOffsets;
+  std::unordered_map<const AttributeSet*, unsigned> _setIndices;
+  std::unordered_map<const Graph*, unsigned> _graphIndices;
+  // Index in _nodes of every node, by graph and slot.
+  std::vector<std::vector<uint32_t> > _nodeIndices;
+  // Hash of every node's id, for the index.
+  std::vector<uint32_t> _hashes;
+  std::vector<uint32_t> _index;
+  std::string _scratch;
+  Header _header;
+
+  uint64_t AddString(std::string_view str);
+
+  /**
+   * Returns the index of set, packing it if it has not been seen before. Sets
+   * are told apart by address, so elements that share a style share a set.
+   */
+  unsigned AddSet(const AttributeSet& set);
+
+  unsigned AddGraph(const Graph* graph, GraphKind::e kind, unsigned parent,
+    const AttributeSet& attributes);
+  void AddEdges(unsigned index);
+  void BuildIndex();
+  unsigned NodeIndex(const Node* node);
+
+public:
+  Builder(const RootGraph& graph);
+
+  uint64_t Size() const {
+    return _header.fileSize;
+  }
+
+  void Write(DotSink& out) const;
+};
+
+Snapshot::Builder::Builder(const RootGraph& graph) {
+  AddString("");
+  _setOffsets.push_back(0);
+  AttributeSet().Pack(_sets);
+  _setOffsets.push_back(_sets.size());
+
+  AddGraph(&graph, GraphKind::ROOT, none, graph.GetAttributes());
+  for (unsigned i = 0; i < _graphs.size(); i++) AddEdges(i);
+  BuildIndex();
+
+  memset(&_header, 0, sizeof(_header));
+  memcpy(_header.magic, magic, sizeof(magic));
+  _header.version = version;
+  _header.byteOrder = byteOrderMark;
+  _header.attributeSize = sizeof(Attribute);
+  _header.flags = graph.IsDigraph() ? digraphFlag : 0;
+  _header.numGraphs = _graphRecords.size();
+  _header.numNodes = _nodes.size();
+  _header.numEdges = _edges.size();
+  _header.numSets = _setOffsets.size() - 1;
+  _header.indexSize = _index.size();
+
+  uint64_t offset = Align(sizeof(Header));
+  _header.stringsOffset = offset;
+  _header.stringsSize = _strings.size();
+  offset = Align(offset + _strings.size());
+  _header.graphsOffset = offset;
+  offset += _graphRecords.size()*sizeof(GraphRecord);
+  _header.nodesOffset = offset;
+  offset += _nodes.size()*sizeof(NodeRecord);
+  _header.edgesOffset = offset;
+  offset += _edges.size()*sizeof(EdgeRecord);
+  _header.setOffsetsOffset = offset;
+  offset += _setOffsets.size()*sizeof(uint64_t);
+  _header.setsOffset = offset;
+  _header.setsSize = _sets.size();
+  offset = Align(offset + _sets.size());
+  _header.indexOffset = offset;
+  _header.fileSize = Align(offset + _index.size()*sizeof(uint32_t));
+}
+
+uint64_t Snapshot::Builder::AddString(std::string_view str) {
+  if (str.empty() && !_strings.empty()) return 0;
+
+  uint64_t offset = _strings.size();
+  uint32_t length = str.size();
+  _strings.append(reinterpret_cast<const char*>(&length), sizeof(length));
+  _strings.append(str);
+  _strings.push_back('\0');
+  return offset;
+}
+
+unsigned Snapshot::Builder::AddSet(const AttributeSet& set) {
+  if (set.Empty()) return 0;
+
+  std::pair<std::unordered_map<const AttributeSet*, unsigned>::iterator, bool>
+    inserted = _setIndices.insert(std::make_pair(&set,
+    static_cast<unsigned>(_setOffsets.size() - 1)));
+  if (inserted.second) {
+    set.Pack(_sets);
+    _setOffsets.push_back(_sets.size());
+  }
+  return inserted.first->second;
+}
+
+unsigned Snapshot::Builder::AddGraph(const Graph* graph, GraphKind::e kind,
+  unsigned parent, const AttributeSet& attributes) {
+  unsigned index = _graphRecords.size();
+  _graphs.push_back(graph);
+  _graphIndices[graph] = index;
+
+  // The styles a Print would hoist right now.
+  Graph::HoistedStyles hoisted = graph->ChooseHoistedStyles();
+
+  GraphRecord record;
+  memset(&record, 0, sizeof(record));
+  _scratch.clear();
+  graph->_idManager->AppendId(_scratch, graph->GetIdHandle());
+  record.id = AddString(_scratch);
+  record.label = AddString(graph->GetLabel());
+  record.kind = kind;
+  record.parent = parent;
+  record.firstChild = none;
+  record.nextSibling = none;
+  record.firstNode = _nodes.size();
+  record.numNodes = graph->_nodes.Size();
+  record.attributes = AddSet(attributes);
+  record.nodeDefaults = AddSet(graph->_defaultNodeAttributes);
+  record.edgeDefaults = AddSet(graph->_defaultEdgeAttributes);
+  record.hoistedNodeStyle = hoisted.node != NULL ? AddSet(*hoisted.node) :
+    none;
+  record.hoistedEdgeStyle = hoisted.edge != NULL ? AddSet(*hoisted.edge) :
+    none;
+  record.flags = graph->_hoistStyles ? hoistFlag : 0;
+  _graphRecords.push_back(record);
+
+  _nodeIndices.push_back(std::vector<uint32_t>(graph->_nodes.SlotCount()));
+  SlotList<Node>::iterator nodeIt;
+  for (nodeIt = graph->_nodes.begin(); nodeIt != graph->_nodes.end();
+    nodeIt++) {
+    const Node* node = *nodeIt;
+    _nodeIndices.back()[node->_slot] = _nodes.size();
+
+    NodeRecord nodeRecord;
+    _scratch.clear();
+    graph->_idManager->AppendId(_scratch, node->GetIdHandle());
+    nodeRecord.id = AddString(_scratch);
+    _hashes.push_back(HashId(_scratch));
+    nodeRecord.label = AddString(node->GetLabel());
+    nodeRecord.graph = index;
+    nodeRecord.style = AddSet(node->GetAttributes());
+    _nodes.push_back(nodeRecord);
+  }
+
+  // Children, in print order, each linked to the one before.
+  unsigned previous = none;
+  SlotList<Subgraph>::iterator sgIt;
+  for (sgIt = graph->_subgraphs.begin(); sgIt != graph->_subgraphs.end();
+    sgIt++) {
+    const Subgraph* sg = *sgIt;
+    unsigned child = AddGraph(sg, GraphKind::SUBGRAPH, index,
+      sg->GetAttributes());
+    if (previous == none) {
+      _graphRecords[index].firstChild = child;
+    } else {
+      _graphRecords[previous].nextSibling = child;
+    }
+    previous = child;
+  }
+
+  SlotList<Cluster>::iterator cIt;
+  for (cIt = graph->_clusters.begin(); cIt != graph->_clusters.end(); cIt++) {
+    const Cluster* cluster = *cIt;
+    unsigned child = AddGraph(cluster, GraphKind::CLUSTER, index,
+      cluster->GetAttributes());
+    if (previous == none) {
+      _graphRecords[index].firstChild = child;
+    } else {
+      _graphRecords[previous].nextSibling = child;
+    }
+    previous = child;
+  }
+
+  return index;
+}
+
+unsigned Snapshot::Builder::NodeIndex(const Node* node) {
+  return _nodeIndices[_graphIndices[node->_graph]][node->_slot];
+}
+
+void Snapshot::Builder::AddEdges(unsigned index) {
+  const Graph* graph = _graphs[index];
+  _graphRecords[index].firstEdge = _edges.size();
+  _graphRecords[index].numEdges = graph->_edges.Size();
+
+  SlotList<Edge>::iterator edgeIt;
+  for (edgeIt = graph->_edges.begin(); edgeIt != graph->_edges.end();
+    edgeIt++) {
+    const Edge* edge = *edgeIt;
+    EdgeRecord record;
+    record.label = AddString(edge->GetLabel());
+    record.src = NodeIndex(edge->_src);
+    record.dst = NodeIndex(edge->_dst);
+    record.style = AddSet(edge->GetAttributes());
+    record.chunk = edge->_slot / OutputCache::chunkSize;
+    _edges.push_back(record);
+  }
+}
+
+void Snapshot::Builder::BuildIndex() {
+  // A power of two, at most half full.
+  size_t size = 1;
+  while (size < 2*_nodes.size()) size *= 2;
+  _index.assign(size, 0);
+
+  size_t mask = size - 1;
+  for (size_t i = 0; i < _nodes.size(); i++) {
+    size_t pos = _hashes[i] & mask;
+    while (_index[pos] != 0) pos = (pos + 1) & mask;
+    _index[pos] = i + 1;
+  }
+}
+
+/**
+ * Writes a section of the file, followed by enough padding to reach the
+ * offset of the next one.
+ */
+static void WriteSection(DotSink& out, const void* data, uint64_t size,
+  uint64_t offset, uint64_t next) {
+  static const char padding[8] = { 0 };
+  if (size != 0) out.Write(static_cast<const char*>(data), size);
+  out.Write(padding, next - offset - size);
+}
+
+void Snapshot::Builder::Write(DotSink& out) const {
+  const Header& header = _header;
+  WriteSection(out, &header, sizeof(header), 0, header.stringsOffset);
+  WriteSection(out, _strings.data(), _strings.size(), header.stringsOffset,
+    header.graphsOffset);
+  WriteSection(out, _graphRecords.data(),
+    _graphRecords.size()*sizeof(GraphRecord), header.graphsOffset,
+    header.nodesOffset);
+  WriteSection(out, _nodes.data(), _nodes.size()*sizeof(NodeRecord),
+    header.nodesOffset, header.edgesOffset);
+  WriteSection(out, _edges.data(), _edges.size()*sizeof(EdgeRecord),
+    header.edgesOffset, header.setOffsetsOffset);
+  WriteSection(out, _setOffsets.data(), _setOffsets.size()*sizeof(uint64_t),
+    header.setOffsetsOffset, header.setsOffset);
+  WriteSection(out, _sets.data(), _sets.size(), header.setsOffset,
+    header.indexOffset);
+  WriteSection(out, _index.data(), _index.size()*sizeof(uint32_t),
+    header.indexOffset, header.fileSize);
+}
+
+bool Snapshot::Write(const RootGraph& graph, const std::string& filename,
+  std::string* error) {
+  Builder builder(graph);
+
+  OutputFile file;
+  bool ok = file.Open(filename, builder.Size());
+  if (ok) {
+    FdDotSink sink(file.GetFd(), 1 << 20);
+    builder.Write(sink);
+    if (!sink.Flush()) {
+      if (error != NULL) *error = sink.GetError();
+      return false;
+    }
+    ok = file.Commit();
+  }
+
+  if (!ok && error != NULL) *error = file.GetError();
+  return ok;
+}
+
+void Snapshot::Write(const RootGraph& graph, std::string& out) {
+  Builder builder(graph);
+  out.reserve(out.size() + builder.Size());
+  StringDotSink sink(out);
+  builder.Write(sink);
+}
+
+Snapshot::Snapshot() : _data(NULL), _header(NULL), _graphs(NULL),
+  _nodes(NULL), _edges(NULL), _setOffsets(NULL), _sets(NULL), _index(NULL) {
+}
+
+bool Snapshot::Fail(const std::string& what) {
+  _error = what;
+  _header = NULL;
+  return false;
+}
+
+bool Snapshot::Open(const std::string& filename) {
+  if (!_file.Open(filename)) return Fail(_file.GetError());
+  if (!Load(_file.GetContents())) return Fail(filename + ": " + _error);
+  return true;
+}
+
+/**
+ * Returns true if [offset, offset + size) lies within a file of fileSize
+ * bytes.
+ */
+static bool InFile(uint64_t offset, uint64_t size, uint64_t fileSize) {
+  return offset <= fileSize && size <= fileSize - offset;
+}
+
+bool Snapshot::Load(std::string_view data) {
+  _error.clear();
+  _header = NULL;
+
+  // Records are read in place, so they have to be aligned.
+  if (reinterpret_cast<uintptr_t>(data.data()) % sizeof(uint64_t) != 0) {
+    _copy.assign((data.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+    memcpy(_copy.data(), data.data(), data.size());
+    data = std::string_view(reinterpret_cast<const char*>(_copy.data()),
+      data.size());
+  }
+
+  const Header* header = reinterpret_cast<const Header*>(data.data());
+  if (data.size() < sizeof(Header) ||
+      memcmp(header->magic, magic, sizeof(magic)) != 0) {
+    return Fail("not a DotWriter snapshot");
+  }
+  if (header->version != version) {
+    return Fail("unsupported snapshot version " +
+      std::to_string(header->version));
+  }
+  if (header->byteOrder != byteOrderMark ||
+      header->attributeSize != sizeof(Attribute)) {
+    return Fail("snapshot was written on a different kind of machine");
+  }
+
+  uint64_t size = data.size();
+  if (header->fileSize != size) return Fail("snapshot is truncated");
+
+  const uint64_t offsets[] = { header->stringsOffset, header->graphsOffset,
+    header->nodesOffset, header->edgesOffset, header->setOffsetsOffset,
+    header->indexOffset };
+  for (unsigned i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+    if (offsets[i] % sizeof(uint64_t) != 0) {
+      return Fail("snapshot is corrupt");
+    }
+  }
+
+  if (header->numGraphs == 0 || header->numSets == 0 ||
+      header->indexSize == 0 ||
+      !InFile(header->stringsOffset, header->stringsSize, size) ||
+      !InFile(header->graphsOffset,
+        header->numGraphs*static_cast<uint64_t>(sizeof(GraphRecord)), size) ||
+      !InFile(header->nodesOffset,
+        header->numNodes*static_cast<uint64_t>(sizeof(NodeRecord)), size) ||
+      !InFile(header->edgesOffset,
+        header->numEdges*static_cast<uint64_t>(sizeof(EdgeRecord)), size) ||
+      !InFile(header->setOffsetsOffset,
+        (header->numSets + 1ULL)*sizeof(uint64_t), size) ||
+      !InFile(header->setsOffset, header->setsSize, size) ||
+      header->indexSize > size ||
+      !InFile(header->indexOffset, header->indexSize*sizeof(uint32_t),
+        size)) {
+    return Fail("snapshot is corrupt");
+  }
+
+  _data = data.data();
+  _graphs = reinterpret_cast<const GraphRecord*>(_data + header->graphsOffset);
+  _nodes = reinterpret_cast<const NodeRecord*>(_data + header->nodesOffset);
+  _edges = reinterpret_cast<const EdgeRecord*>(_data + header->edgesOffset);
+  _setOffsets = reinterpret_cast<const uint64_t*>(_data +
+    header->setOffsetsOffset);
+  _sets = _data + header->setsOffset;
+  _index = reinterpret_cast<const uint32_t*>(_data + header->indexOffset);
+  _header = header;
+
+  if (!Validate()) return Fail("snapshot is corrupt");
+  return true;
+}
+
+bool Snapshot::IsString(uint64_t ref) const {
+  uint64_t size = _header->stringsSize;
+  if (!InFile(ref, sizeof(uint32_t), size)) return false;
+
+  const char* strings = _data + _header->stringsOffset;
+  uint32_t length;
+  memcpy(&length, strings + ref, sizeof(length));
+  uint64_t end = ref + sizeof(uint32_t) + length;
+  return end < size && strings[end] == '\0';
+}
+
+std::string_view Snapshot::GetString(uint64_t ref) const {
+  const char* str = _data + _header->stringsOffset + ref;
+  uint32_t length;
+  memcpy(&length, str, sizeof(length));
+  return std::string_view(str + sizeof(length), length);
+}
+
+std::string_view Snapshot::GetSet(unsigned set) const {
+  return std::string_view(_sets + _setOffsets[set],
+    _setOffsets[set + 1] - _setOffsets[set]);
+}
+
+bool Snapshot::Validate() {
+  const Header& header = *_header;
+  unsigned numSets = header.numSets;
+
+  if (!IsString(0) || !GetString(0).empty()) return false;
+
+  if (_setOffsets[0] != 0 || _setOffsets[numSets] != header.setsSize) {
+    return false;
+  }
+  AttributeSet scratch;
+  for (unsigned i = 0; i < numSets; i++) {
+    if (_setOffsets[i + 1] < _setOffsets[i]) return false;
+    if (!scratch.Unpack(GetSet(i))) return false;
+    if (i == 0 && !scratch.Empty()) return false;
+  }
+
+  // Graphs come in print order, so parents come before their children, and
+  // every child or sibling link points forward. Printing always ends. Each
+  // graph's nodes and edges follow those of the graph before it.
+  uint64_t numChildren = 0;
+  uint64_t nextNode = 0;
+  uint64_t nextEdge = 0;
+  for (unsigned i = 0; i < header.numGraphs; i++) {
+    const GraphRecord& graph = _graphs[i];
+    bool isRoot = i == 0;
+    if (graph.kind > GraphKind::CLUSTER ||
+        (graph.kind == GraphKind::ROOT) != isRoot ||
+        (isRoot ? graph.parent != none : graph.parent >= i) ||
+        !IsString(graph.id) || !IsString(graph.label) ||
+        graph.attributes >= numSets || graph.nodeDefaults >= numSets ||
+        graph.edgeDefaults >= numSets ||
+        (graph.hoistedNodeStyle != none &&
+          graph.hoistedNodeStyle >= numSets) ||
+        (graph.hoistedEdgeStyle != none &&
+          graph.hoistedEdgeStyle >= numSets) ||
+        graph.firstNode != nextNode || graph.firstEdge != nextEdge) {
+      return false;
+    }
+    nextNode += graph.numNodes;
+    nextEdge += graph.numEdges;
+    if (nextNode > header.numNodes || nextEdge > header.numEdges) return false;
+
+    for (unsigned j = 0; j < graph.numNodes; j++) {
+      if (_nodes[graph.firstNode + j].graph != i) return false;
+    }
+
+    if (graph.firstChild != none && (graph.firstChild <= i ||
+        graph.firstChild >= header.numGraphs ||
+        _graphs[graph.firstChild].parent != i)) {
+      return false;
+    }
+    if (graph.nextSibling != none && (graph.nextSibling <= i ||
+        graph.nextSibling >= header.numGraphs ||
+        _graphs[graph.nextSibling].parent != graph.parent)) {
+      return false;
+    }
+    if (graph.firstChild != none) numChildren++;
+    if (graph.nextSibling != none) numChildren++;
+  }
+
+  // Every graph but the root is someone's child.
+  if (numChildren + 1 != header.numGraphs || nextNode != header.numNodes ||
+      nextEdge != header.numEdges) {
+    return false;
+  }
+
+  for (unsigned i = 0; i < header.numNodes; i++) {
+    const NodeRecord& node = _nodes[i];
+    if (!IsString(node.id) || !IsString(node.label) ||
+        node.graph >= header.numGraphs || node.style >= numSets) {
+      return false;
+    }
+  }
+
+  for (unsigned i = 0; i < header.numEdges; i++) {
+    const EdgeRecord& edge = _edges[i];
+    if (!IsString(edge.label) || edge.src >= header.numNodes ||
+        edge.dst >= header.numNodes || edge.style >= numSets) {
+      return false;
+    }
+  }
+
+  // The index needs an empty slot for lookups to end at.
+  uint64_t indexSize = header.indexSize;
+  uint64_t used = 0;
+  for (uint64_t i = 0; i < indexSize; i++) {
+    if (_index[i] > header.numNodes) return false;
+    if (_index[i] != 0) used++;
+  }
+  return (indexSize & (indexSize - 1)) == 0 && used < indexSize;
+}
+
+bool Snapshot::IsDigraph() const {
+  return (_header->flags & digraphFlag) != 0;
+}
+
+unsigned Snapshot::NumGraphs() const {
+  return _header->numGraphs;
+}
+
+unsigned Snapshot::NumNodes() const {
+  return _header->numNodes;
+}
+
+unsigned Snapshot::NumEdges() const {
+  return _header->numEdges;
+}
+
+Snapshot::GraphKind::e Snapshot::GetGraphKind(unsigned graph) const {
+  return static_cast<GraphKind::e>(_graphs[graph].kind);
+}
+
+std::string_view Snapshot::GetGraphId(unsigned graph) const {
+  return GetString(_graphs[graph].id);
+}
+
+std::string_view Snapshot::GetGraphLabel(unsigned graph) const {
+  return GetString(_graphs[graph].label);
+}
+
+unsigned Snapshot::GetParent(unsigned graph) const {
+  return _graphs[graph].parent;
+}
+
+unsigned Snapshot::GetFirstChild(unsigned graph) const {
+  return _graphs[graph].firstChild;
+}
+
+unsigned Snapshot::GetNextSibling(unsigned graph) const {
+  return _graphs[graph].nextSibling;
+}
+
+unsigned Snapshot::GetFirstNode(unsigned graph) const {
+  return _graphs[graph].firstNode;
+}
+
+unsigned Snapshot::GetNumNodes(unsigned graph) const {
+  return _graphs[graph].numNodes;
+}
+
+unsigned Snapshot::GetFirstEdge(unsigned graph) const {
+  return _graphs[graph].firstEdge;
+}
+
+unsigned Snapshot::GetNumEdges(unsigned graph) const {
+  return _graphs[graph].numEdges;
+}
+
+void Snapshot::GetGraphAttributes(unsigned graph, AttributeSet& set) const {
+  set.Unpack(GetSet(_graphs[graph].attributes));
+}
+
+void Snapshot::GetDefaultNodeAttributes(unsigned graph,
+  NodeAttributeSet& set) const {
+  set.Unpack(GetSet(_graphs[graph].nodeDefaults));
+}
+
+void Snapshot::GetDefaultEdgeAttributes(unsigned graph,
+  EdgeAttributeSet& set) const {
+  set.Unpack(GetSet(_graphs[graph].edgeDefaults));
+}
+
+std::string_view Snapshot::GetNodeId(unsigned node) const {
+  return GetString(_nodes[node].id);
+}
+
+std::string_view Snapshot::GetNodeLabel(unsigned node) const {
+  return GetString(_nodes[node].label);
+}
+
+unsigned Snapshot::GetNodeGraph(unsigned node) const {
+  return _nodes[node].graph;
+}
+
+void Snapshot::GetNodeAttributes(unsigned node, NodeAttributeSet& set) const {
+  set.Unpack(GetSet(_nodes[node].style));
+}
+
+unsigned Snapshot::FindNode(std::string_view id) const {
+  size_t mask = _header->indexSize - 1;
+  size_t pos = HashId(id) & mask;
+
+  // Linear probing.
+  for (;;) {
+    uint32_t entry = _index[pos];
+    if (entry == 0) return none;
+    if (GetString(_nodes[entry - 1].id) == id) return entry - 1;
+    pos = (pos + 1) & mask;
+  }
+}
+
+unsigned Snapshot::GetEdgeSource(unsigned edge) const {
+  return _edges[edge].src;
+}
+
+unsigned Snapshot::GetEdgeDest(unsigned edge) const {
+  return _edges[edge].dst;
+}
+
+std::string_view Snapshot::GetEdgeLabel(unsigned edge) const {
+  return GetString(_edges[edge].label);
+}
+
+void Snapshot::GetEdgeAttributes(unsigned edge, EdgeAttributeSet& set) const {
+  set.Unpack(GetSet(_edges[edge].style));
+}
+
+void Snapshot::Print(std::ostream& out, const PrintOptions& options) const {
+  OstreamDotSink sink(out);
+  Print(sink, options);
+}
+
+void Snapshot::Print(DotSink& out, const PrintOptions& options) const {
+  PrintGraph(out, options, 0, 1);
+}
+
+/**
+ * What follows mirrors Graph::Print and the PrintHeader functions of the
+ * graph classes, which produce the same text from the objects.
+ */
+
+void Snapshot::PrintHeader(DotSink& out, const PrintOptions& options,
+  const GraphRecord& graph, unsigned tabDepth) const {
+  std::string_view id = GetString(graph.id);
+  std::string_view label = GetString(graph.label);
+  AttributeSet attributes;
+  attributes.Unpack(GetSet(graph.attributes));
+
+  if (graph.kind == GraphKind::ROOT) {
+    out.Write(IsDigraph() ? "digraph " : "graph ");
+  } else if (!options.compact) {
+    out.Fill(Graph::_tabCharacter, (tabDepth-1)*Graph::_tabIncrement);
+    out.Write("subgraph ");
+  } else {
+    out.Write("subgraph ");
+  }
+  out.Write(id.data(), id.size());
+
+  if (options.compact) {
+    out.Write("{\n");
+    if (!attributes.Empty() || !label.empty()) {
+      attributes.PrintWithLabel(out, label, "", "\n", true);
+      out.Put('\n');
+    }
+    return;
+  }
+
+  out.Write(" {\n");
+  std::string linePrefix = std::string(tabDepth*Graph::_tabIncrement,
+    Graph::_tabCharacter);
+  if (!attributes.Empty() || !label.empty()) {
+    attributes.PrintWithLabel(out, label, linePrefix, ";\n");
+    out.Write(";\n");
+  }
+}
+
+void Snapshot::PrintAttributes(DotSink& out, const PrintOptions& options,
+  unsigned set, unsigned hoisted, std::string_view label,
+  AttributeSet& attributes, unsigned* current) const {
+  // Hoisted attributes are printed once, as the graph's defaults.
+  if (set == hoisted) set = 0;
+  if (set != *current) {
+    attributes.Unpack(GetSet(set));
+    *current = set;
+  }
+  if (attributes.Empty() && label.empty()) return;
+
+  if (options.compact) {
+    out.Put('[');
+    attributes.PrintWithLabel(out, label, "", ",", true);
+  } else {
+    out.Write(" [", 2);
+    attributes.PrintWithLabel(out, label, "", ", ");
+  }
+  out.Put(']');
+}
+
+void Snapshot::PrintGraph(DotSink& out, const PrintOptions& options,
+  unsigned index, unsigned tabDepth) const {
+  const GraphRecord& graph = _graphs[index];
+  PrintHeader(out, options, graph, tabDepth);
+
+  unsigned indent = options.compact ? 0 : tabDepth*Graph::_tabIncrement;
+  const char* postfix = options.compact ? "]\n" : "];\n";
+  AttributeSet attributes;
+
+  attributes.Unpack(GetSet(graph.hoistedNodeStyle != none ?
+    graph.hoistedNodeStyle : graph.nodeDefaults));
+  if (!attributes.Empty()) {
+    out.Fill(Graph::_tabCharacter, indent);
+    out.Write(options.compact ? "node[" : "node [");
+    attributes.PrintWithLabel(out, "", "", options.compact ? "," : ", ",
+      options.compact);
+    out.Write(postfix);
+  }
+
+  attributes.Unpack(GetSet(graph.hoistedEdgeStyle != none ?
+    graph.hoistedEdgeStyle : graph.edgeDefaults));
+  if (!attributes.Empty()) {
+    out.Fill(Graph::_tabCharacter, indent);
+    out.Write(options.compact ? "edge[" : "edge [");
+    attributes.PrintWithLabel(out, "", "", options.compact ? "," : ", ",
+      options.compact);
+    out.Write(postfix);
+  }
+
+  // Consecutive elements often share a style, which is then only unpacked
+  // once.
+  attributes.Unpack(GetSet(0));
+  unsigned current = 0;
+  for (unsigned i = 0; i < graph.numNodes; i++) {
+    const NodeRecord& node = _nodes[graph.firstNode + i];
+    out.Fill(Graph::_tabCharacter, indent);
+    std::string_view id = GetString(node.id);
+    out.Write(id.data(), id.size());
+    PrintAttributes(out, options, node.style, graph.hoistedNodeStyle,
+      GetString(node.label), attributes, &current);
+    if (options.compact) {
+      out.Put('\n');
+    } else {
+      out.Write(";\n", 2);
+    }
+  }
+
+  for (unsigned child = graph.firstChild; child != none;
+    child = _graphs[child].nextSibling) {
+    PrintGraph(out, options, child, tabDepth+1);
+  }
+
+  PrintEdges(out, options, graph, tabDepth);
+
+  if (graph.kind != GraphKind::ROOT && !options.compact) {
+    out.Fill(Graph::_tabCharacter, (tabDepth-1)*Graph::_tabIncrement);
+  }
+  out.Write("}\n");
+}
+
+void Snapshot::PrintEdges(DotSink& out, const PrintOptions& options,
+  const GraphRecord& graph, unsigned tabDepth) const {
+  const char* arrow = IsDigraph() ? "->" : "--";
+  AttributeSet attributes;
+  unsigned current = 0;
+
+  if (!options.compact) {
+    unsigned indent = tabDepth*Graph::_tabIncrement;
+    for (unsigned i = 0; i < graph.numEdges; i++) {
+      const EdgeRecord& edge = _edges[graph.firstEdge + i];
+      out.Fill(Graph::_tabCharacter, indent);
+      std::string_view src = GetString(_nodes[edge.src].id);
+      std::string_view dst = GetString(_nodes[edge.dst].id);
+      out.Write(src.data(), src.size());
+      out.Write(arrow, 2);
+      out.Write(dst.data(), dst.size());
+      PrintAttributes(out, options, edge.style, graph.hoistedEdgeStyle,
+        GetString(edge.label), attributes, &current);
+      out.Write(";\n", 2);
+    }
+    return;
+  }
+
+  // Runs of edges that look the same, as in Graph::PrintEdgeRuns.
+  const EdgeRecord* first = NULL;
+  std::vector<unsigned> targets;
+  bool fanOut = false;
+
+  for (unsigned i = 0;; i++) {
+    const EdgeRecord* edge = i < graph.numEdges ?
+      &_edges[graph.firstEdge + i] : NULL;
+
+    if (edge != NULL && first != NULL && edge->chunk == first->chunk &&
+      edge->style == first->style &&
+      GetString(edge->label) == GetString(first->label)) {
+      bool single = targets.size() == 1;
+      if ((single || !fanOut) && edge->src == targets.back()) {
+        fanOut = false;
+        targets.push_back(edge->dst);
+        continue;
+      }
+      if ((single || fanOut) && edge->src == first->src) {
+        fanOut = true;
+        targets.push_back(edge->dst);
+        continue;
+      }
+    }
+
+    if (first != NULL) {
+      std::string_view src = GetString(_nodes[first->src].id);
+      out.Write(src.data(), src.size());
+      out.Write(arrow, 2);
+      if (fanOut) out.Put('{');
+      std::vector<unsigned>::iterator it;
+      for (it = targets.begin(); it != targets.end(); it++) {
+        if (it != targets.begin()) {
+          if (fanOut) {
+            out.Put(' ');
+          } else {
+            out.Write(arrow, 2);
+          }
+        }
+        std::string_view dst = GetString(_nodes[*it].id);
+        out.Write(dst.data(), dst.size());
+      }
+      if (fanOut) out.Put('}');
+      PrintAttributes(out, options, first->style, graph.hoistedEdgeStyle,
+        GetString(first->label), attributes, &current);
+      out.Put('\n');
+    }
+
+    if (edge == NULL) break;
+    first = edge;
+    targets.assign(1, edge->dst);
+    fanOut = false;
+  }
+}
+
+RootGraph* Snapshot::ToGraph() const {
+  const GraphRecord& root = _graphs[0];
+  RootGraph* graph = new RootGraph(IsDigraph(),
+    std::string(GetString(root.label)), GetString(root.id));
+  graph->SetStyleHoisting((root.flags & hoistFlag) != 0);
+  graph->GetAttributes().Unpack(GetSet(root.attributes));
+
+  // Graphs and nodes first, so that edges can refer to nodes anywhere.
+  std::vector<Graph*> graphs(_header->numGraphs);
+  std::vector<Node*> nodes(_header->numNodes);
+  std::vector<SharedNodeStyle> nodeStyles(_header->numSets);
+  std::vector<SharedEdgeStyle> edgeStyles(_header->numSets);
+  graphs[0] = graph;
+
+  for (unsigned i = 0; i < _header->numGraphs; i++) {
+    const GraphRecord& record = _graphs[i];
+    Graph* current = graphs[i];
+    current->GetDefaultNodeAttributes().Unpack(GetSet(record.nodeDefaults));
+    current->GetDefaultEdgeAttributes().Unpack(GetSet(record.edgeDefaults));
+    current->Reserve(record.numNodes, record.numEdges, record.numNodes);
+
+    for (unsigned j = 0; j < record.numNodes; j++) {
+      unsigned n = record.firstNode + j;
+      const NodeRecord& node = _nodes[n];
+      nodes[n] = current->AddNode(std::string(GetString(node.label)),
+        GetString(node.id));
+      if (node.style == 0) continue;
+
+      if (nodeStyles[node.style].Empty()) {
+        NodeAttributeSet set;
+        set.Unpack(GetSet(node.style));
+        nodeStyles[node.style] = SharedNodeStyle(set);
+      }
+      nodes[n]->SetStyle(nodeStyles[node.style]);
+    }
+
+    for (unsigned child = record.firstChild; child != none;
+      child = _graphs[child].nextSibling) {
+      const GraphRecord& childRecord = _graphs[child];
+      std::string label(GetString(childRecord.label));
+      if (childRecord.kind == GraphKind::CLUSTER) {
+        Cluster* cluster = current->AddCluster(label,
+          GetString(childRecord.id));
+        cluster->GetAttributes().Unpack(GetSet(childRecord.attributes));
+        graphs[child] = cluster;
+      } else {
+        Subgraph* sg = current->AddSubgraph(label, GetString(childRecord.id));
+        sg->GetAttributes().Unpack(GetSet(childRecord.attributes));
+        graphs[child] = sg;
+      }
+      graphs[child]->SetStyleHoisting((childRecord.flags & hoistFlag) != 0);
+    }
+  }
+
+  for (unsigned i = 0; i < _header->numGraphs; i++) {
+    const GraphRecord& record = _graphs[i];
+    for (unsigned j = 0; j < record.numEdges; j++) {
+      const EdgeRecord& edge = _edges[record.firstEdge + j];
+      Edge* added = graphs[i]->AddEdge(nodes[edge.src], nodes[edge.dst],
+        std::string(GetString(edge.label)));
+      if (edge.style == 0) continue;
+
+      if (edgeStyles[edge.style].Empty()) {
+        EdgeAttributeSet set;
+        set.Unpack(GetSet(edge.style));
+        edgeStyles[edge.style] = SharedEdgeStyle(set);
+      }
+      added->SetStyle(edgeStyles[edge.style]);
+    }
+  }
+
+  return graph;
+}
+
+}  // namespace DotWriter
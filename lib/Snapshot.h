@@ -0,0 +1,213 @@
+/**
+ * A binary image of a RootGraph that can be printed or looked at without
+ * building the graph again.
+ *
+ * A snapshot holds every id and label in one string pool, tables of graphs,
+ * nodes and edges that refer to each other by index, every distinct attribute
+ * set in packed form (see AttributeSet::Pack) and a hash index of node ids.
+ * Opening a snapshot maps the file and checks it. Neither that nor querying
+ * or printing the snapshot copies it, or allocates anything per node or edge.
+ *
+ * Graphs are numbered in the order Print visits them, starting with the root
+ * graph at 0. Each graph's nodes and edges are consecutive, in print order.
+ * Elements that shared a style in the graph share an attribute set in the
+ * snapshot, and style hoisting (see Graph::SetStyleHoisting) is kept, so
+ * printing a snapshot produces exactly what printing its graph did.
+ *
+ * The format is versioned, and only meant to be read on the kind of machine
+ * that wrote it: a snapshot written with a different byte order or struct
+ * layout is rejected.
+ */
+
+#ifndef DOTWRITER_SNAPSHOT_H_
+#define DOTWRITER_SNAPSHOT_H_
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stdint.h>
+
+#include "AttributeSet.h"
+#include "DotSink.h"
+#include "InputFile.h"
+#include "PrintOptions.h"
+
+namespace DotWriter {
+
+class RootGraph;
+
+class Snapshot {
+public:
+  /**
+   * Stands for no graph, e.g. as the parent of the root graph, or for a node
+   * that FindNode did not find.
+   */
+  static const unsigned none = 0xFFFFFFFFU;
+
+  struct GraphKind {
+    enum e {
+      ROOT,
+      SUBGRAPH,
+      CLUSTER
+    };
+  };
+
+private:
+  struct Header;
+  struct GraphRecord;
+  struct NodeRecord;
+  struct EdgeRecord;
+  class Builder;
+
+  InputFile _file;
+  // Holds the snapshot if Load was given data that is not suitably aligned.
+  std::vector<uint64_t> _copy;
+  const char* _data;
+  const Header* _header;
+  const GraphRecord* _graphs;
+  const NodeRecord* _nodes;
+  const EdgeRecord* _edges;
+  const uint64_t* _setOffsets;
+  const char* _sets;
+  const uint32_t* _index;
+  std::string _error;
+
+  // Not copyable.
+  Snapshot(const Snapshot&);
+  Snapshot& operator=(const Snapshot&);
+
+  bool Fail(const std::string& what);
+
+  /**
+   * Checks that every record refers to things that exist, so that nothing
+   * read later can go out of bounds.
+   */
+  bool Validate();
+  bool IsString(uint64_t ref) const;
+  std::string_view GetString(uint64_t ref) const;
+  std::string_view GetSet(unsigned set) const;
+
+  void PrintGraph(DotSink& out, const PrintOptions& options, unsigned graph,
+    unsigned tabDepth) const;
+  void PrintHeader(DotSink& out, const PrintOptions& options,
+    const GraphRecord& graph, unsigned tabDepth) const;
+  void PrintEdges(DotSink& out, const PrintOptions& options,
+    const GraphRecord& graph, unsigned tabDepth) const;
+
+  /**
+   * Prints the [...] list of a node or edge, if it has anything to put in it.
+   * attributes holds the last set unpacked, number current.
+   */
+  void PrintAttributes(DotSink& out, const PrintOptions& options,
+    unsigned set, unsigned hoisted, std::string_view label,
+    AttributeSet& attributes, unsigned* current) const;
+
+public:
+  Snapshot();
+
+  /**
+   * Writes a snapshot of graph to filename, atomically (see OutputFile).
+   * Returns false on failure. If error is given, it receives a description
+   * of what went wrong.
+   */
+  static bool Write(const RootGraph& graph, const std::string& filename,
+    std::string* error = NULL);
+
+  /**
+   * Same as above, but appends the snapshot to out.
+   */
+  static void Write(const RootGraph& graph, std::string& out);
+
+  /**
+   * Maps the snapshot in filename. Returns false if it cannot be read, or is
+   * not a valid snapshot.
+   */
+  bool Open(const std::string& filename);
+
+  /**
+   * Same as Open, but for a snapshot already in memory. data must stay valid
+   * for as long as the snapshot is used.
+   */
+  bool Load(std::string_view data);
+
+  /**
+   * Describes why Open or Load failed.
+   */
+  const std::string& GetError() const {
+    return _error;
+  }
+
+  /**
+   * The functions below may only be used once Open or Load succeeded. Index
+   * arguments must be in range.
+   */
+
+  bool IsDigraph() const;
+  unsigned NumGraphs() const;
+  unsigned NumNodes() const;
+  unsigned NumEdges() const;
+
+  GraphKind::e GetGraphKind(unsigned graph) const;
+  std::string_view GetGraphId(unsigned graph) const;
+  std::string_view GetGraphLabel(unsigned graph) const;
+  unsigned GetParent(unsigned graph) const;
+
+  /**
+   * Subgraphs and clusters directly inside graph, in print order (subgraphs
+   * first), as a list: GetFirstChild, then GetNextSibling until none.
+   */
+  unsigned GetFirstChild(unsigned graph) const;
+  unsigned GetNextSibling(unsigned graph) const;
+
+  /**
+   * The nodes of graph are [GetFirstNode, GetFirstNode + GetNumNodes), and
+   * likewise for its edges. Neither includes those of its subgraphs.
+   */
+  unsigned GetFirstNode(unsigned graph) const;
+  unsigned GetNumNodes(unsigned graph) const;
+  unsigned GetFirstEdge(unsigned graph) const;
+  unsigned GetNumEdges(unsigned graph) const;
+
+  /**
+   * Copies a graph's own attributes, or its node / edge defaults, into set.
+   */
+  void GetGraphAttributes(unsigned graph, AttributeSet& set) const;
+  void GetDefaultNodeAttributes(unsigned graph, NodeAttributeSet& set) const;
+  void GetDefaultEdgeAttributes(unsigned graph, EdgeAttributeSet& set) const;
+
+  std::string_view GetNodeId(unsigned node) const;
+  std::string_view GetNodeLabel(unsigned node) const;
+  unsigned GetNodeGraph(unsigned node) const;
+  void GetNodeAttributes(unsigned node, NodeAttributeSet& set) const;
+
+  /**
+   * Returns the node with the given id, or none.
+   */
+  unsigned FindNode(std::string_view id) const;
+
+  unsigned GetEdgeSource(unsigned edge) const;
+  unsigned GetEdgeDest(unsigned edge) const;
+  std::string_view GetEdgeLabel(unsigned edge) const;
+  void GetEdgeAttributes(unsigned edge, EdgeAttributeSet& set) const;
+
+  /**
+   * Prints the DOT text of the graph, the same as RootGraph::Print would
+   * with the same options.
+   */
+  void Print(DotSink& out, const PrintOptions& options = PrintOptions()) const;
+  void Print(std::ostream& out,
+    const PrintOptions& options = PrintOptions()) const;
+
+  /**
+   * Builds the graph again. The caller owns the new graph, which prints the
+   * same as the snapshot, except that compact output may join edges into
+   * runs differently if edges had been removed from the original graph (see
+   * Graph::PrintEdgeRuns).
+   */
+  RootGraph* ToGraph() const;
+};
+
+}  // namespace DotWriter
+
+#endif
@@ -0,0 +1,221 @@
+#include "StreamingGraphWriter.h"
+
+namespace DotWriter {
+
+// Matches the layout produced by Graph::Print.
+const char StreamingGraphWriter::_tabCharacter = ' ';
+const unsigned StreamingGraphWriter::_tabIncrement = 2;
+
+StreamingGraphWriter::StreamingGraphWriter(DotSink& out, bool isDigraph,
+  const std::string& label, const std::string& id,
+  IdTracking::e idTracking) : _ownedSink(NULL), _out(out),
+  _isDigraph(isDigraph), _idManager(idTracking), _depth(1) {
+  Open(label, id);
+}
+
+StreamingGraphWriter::StreamingGraphWriter(std::ostream& out, bool isDigraph,
+  const std::string& label, const std::string& id,
+  IdTracking::e idTracking) : _ownedSink(new OstreamDotSink(out)),
+  _out(*_ownedSink), _isDigraph(isDigraph), _idManager(idTracking),
+  _depth(1) {
+  Open(label, id);
+}
+
+void StreamingGraphWriter::Open(const std::string& label,
+  const std::string& id) {
+  _out.Write(_isDigraph ? "digraph " : "graph ");
+  _out.Write(_idManager.ValidateCustomId(id));
+  _out.Write(" {\n");
+
+  WriteAttributes(GraphAttributeSet(), label);
+}
+
+StreamingGraphWriter::~StreamingGraphWriter() {
+  Close();
+  delete _ownedSink;
+}
+
+void StreamingGraphWriter::PrintIndent(unsigned depth) {
+  _out.Fill(_tabCharacter, depth * _tabIncrement);
+}
+
+void StreamingGraphWriter::WriteAttributes(const AttributeSet& attributes) {
+  WriteAttributes(attributes, "");
+}
+
+void StreamingGraphWriter::WriteAttributes(const AttributeSet& attributes,
+  const std::string& label) {
+  if (_depth == 0 || (attributes.Empty() && label.empty())) return;
+
+  std::string linePrefix(_depth * _tabIncrement, _tabCharacter);
+  attributes.PrintWithLabel(_out, label, linePrefix, ";\n");
+  _out.Write(";\n");
+}
+
+void StreamingGraphWriter::SetDefaultNodeAttributes(
+  const NodeAttributeSet& attributes) {
+  if (_depth == 0 || attributes.Empty()) return;
+
+  PrintIndent(_depth);
+  _out.Write("node [");
+  attributes.Print(_out);
+  _out.Write("];\n");
+}
+
+void StreamingGraphWriter::SetDefaultEdgeAttributes(
+  const EdgeAttributeSet& attributes) {
+  if (_depth == 0 || attributes.Empty()) return;
+
+  PrintIndent(_depth);
+  _out.Write("edge [");
+  attributes.Print(_out);
+  _out.Write("];\n");
+}
+
+void StreamingGraphWriter::PrintNode(const std::string& id,
+  const NodeAttributeSet& attributes, const std::string& label) {
+  PrintIndent(_depth);
+  _out.Write(id);
+
+  if (!attributes.Empty() || !label.empty()) {
+    _out.Write(" [");
+    attributes.PrintWithLabel(_out, label, "", ", ");
+    _out.Put(']');
+  }
+
+  _out.Write(";\n");
+}
+
+std::string StreamingGraphWriter::AddNode(const std::string& label) {
+  return AddNode(NodeAttributeSet(), label);
+}
+
+std::string StreamingGraphWriter::AddNode(const std::string& label,
+  const std::string& id) {
+  return AddNode(NodeAttributeSet(), label, id);
+}
+
+std::string StreamingGraphWriter::AddNode(const NodeAttributeSet& attributes,
+  const std::string& label) {
+  std::string id = _idManager.GetNodeId();
+  if (_depth != 0) PrintNode(id, attributes, label);
+  return id;
+}
+
+std::string StreamingGraphWriter::AddNode(const NodeAttributeSet& attributes,
+  const std::string& label, const std::string& id) {
+  std::string validId = _idManager.ValidateCustomId(id);
+  if (_depth != 0) PrintNode(validId, attributes, label);
+  return validId;
+}
+
+void StreamingGraphWriter::AddEdge(const std::string& src,
+  const std::string& dst) {
+  AddEdge(src, dst, EdgeAttributeSet());
+}
+
+void StreamingGraphWriter::AddEdge(const std::string& src,
+  const std::string& dst, const EdgeAttributeSet& attributes) {
+  if (_depth == 0) return;
+
+  PrintIndent(_depth);
+  _out.Write(src);
+  _out.Write(_isDigraph ? "->" : "--", 2);
+  _out.Write(dst);
+
+  if (!attributes.Empty()) {
+    _out.Write(" [");
+    attributes.Print(_out);
+    _out.Put(']');
+  }
+
+  _out.Write(";\n");
+}
+
+void StreamingGraphWriter::PrintSubgraphHeader(const std::string& id,
+  const AttributeSet& attributes, const std::string& label) {
+  PrintIndent(_depth);
+  _out.Write("subgraph ");
+  _out.Write(id);
+  _out.Write(" {\n");
+  _depth++;
+  WriteAttributes(attributes, label);
+}
+
+std::string StreamingGraphWriter::BeginSubgraph(const std::string& label) {
+  return BeginSubgraph(SubgraphAttributeSet(), label);
+}
+
+std::string StreamingGraphWriter::BeginSubgraph(const std::string& label,
+  const std::string& id) {
+  return BeginSubgraph(SubgraphAttributeSet(), label, id);
+}
+
+std::string StreamingGraphWriter::BeginSubgraph(
+  const SubgraphAttributeSet& attributes, const std::string& label) {
+  return BeginSubgraph(attributes, label, "");
+}
+
+std::string StreamingGraphWriter::BeginSubgraph(
+  const SubgraphAttributeSet& attributes, const std::string& label,
+  const std::string& id) {
+  std::string validId = id.empty() ? _idManager.GetSubgraphId() :
+    _idManager.ValidateCustomId(id);
+  if (_depth == 0) return validId;
+
+  PrintSubgraphHeader(validId, attributes, label);
+  return validId;
+}
+
+std::string StreamingGraphWriter::BeginCluster(const std::string& label) {
+  return BeginCluster(ClusterAttributeSet(), label);
+}
+
+std::string StreamingGraphWriter::BeginCluster(const std::string& label,
+  const std::string& id) {
+  return BeginCluster(ClusterAttributeSet(), label, id);
+}
+
+std::string StreamingGraphWriter::BeginCluster(
+  const ClusterAttributeSet& attributes, const std::string& label) {
+  return BeginCluster(attributes, label, "");
+}
+
+std::string StreamingGraphWriter::BeginCluster(
+  const ClusterAttributeSet& attributes, const std::string& label,
+  const std::string& id) {
+  std::string validId = id.empty() ? _idManager.GetClusterId() :
+    _idManager.ValidateCustomClusterId(id);
+  if (_depth == 0) return validId;
+
+  PrintSubgraphHeader(validId, attributes, label);
+  return validId;
+}
+
+void StreamingGraphWriter::EndSubgraph() {
+  // The root graph is only closed by Close().
+  if (_depth <= 1) return;
+
+  _depth--;
+  PrintIndent(_depth);
+  _out.Write("}\n");
+}
+
+void StreamingGraphWriter::Close() {
+  while (_depth > 1) {
+    EndSubgraph();
+  }
+
+  if (_depth == 1) {
+    _out.Write("}\n");
+    _depth = 0;
+  }
+
+  Flush();
+}
+
+bool StreamingGraphWriter::Flush() {
+  return _out.Flush();
+}
+
+}  // namespace DotWriter
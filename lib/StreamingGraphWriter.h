@@ -0,0 +1,156 @@
+/**
+ * Writes a DOT file as the graph is being described, without keeping the
+ * graph in memory.
+ *
+ * Each node, edge, subgraph opening and subgraph closing is written to the
+ * output stream as soon as it is declared, so memory use only depends on how
+ * deeply subgraphs are nested and on how ids are tracked (see IdTracking).
+ * Ids follow the same rules as RootGraph's.
+ *
+ * Unlike Graph::Print, edges are written where they are declared rather than
+ * after the graph's subgraphs. Nodes must be declared before the edges that
+ * refer to them, since DOT applies attributes at a node's first appearance.
+ */
+
+#ifndef DOTWRITER_STREAMINGGRAPHWRITER_H_
+#define DOTWRITER_STREAMINGGRAPHWRITER_H_
+
+#include <ostream>
+#include <string>
+
+#include "AttributeSet.h"
+#include "DotSink.h"
+#include "IdManager.h"
+
+namespace DotWriter {
+
+class StreamingGraphWriter {
+private:
+  // Set when constructed with a std::ostream.
+  OstreamDotSink* _ownedSink;
+  DotSink& _out;
+  bool _isDigraph;
+  IdManager _idManager;
+  // Number of graphs currently open, including the root graph.
+  unsigned _depth;
+
+  // Used as 'tab' in output DOT files.
+  static const char _tabCharacter;
+  // Used to determine how many _tabCharacters are printed per tab level.
+  static const unsigned _tabIncrement;
+
+  void Open(const std::string& label, const std::string& id);
+  void PrintIndent(unsigned depth);
+  void PrintNode(const std::string& id, const NodeAttributeSet& attributes,
+    const std::string& label);
+  void PrintSubgraphHeader(const std::string& id,
+    const AttributeSet& attributes, const std::string& label);
+  void WriteAttributes(const AttributeSet& attributes,
+    const std::string& label);
+
+  // Not copyable.
+  StreamingGraphWriter(const StreamingGraphWriter&);
+  StreamingGraphWriter& operator=(const StreamingGraphWriter&);
+
+public:
+  /**
+   * Writes the opening of the root graph to out.
+   * - isDigraph: Set to 'true' if this is a directed graph.
+   * - label: Text that is printed somewhere adjacent to the graph.
+   * - id: Custom id for the root graph.
+   * - idTracking: How ids are remembered to keep them unique. EXACT keeps
+   *   every id; BLOOM and NONE use little or no memory per id.
+   */
+  StreamingGraphWriter(DotSink& out, bool isDigraph = false,
+    const std::string& label = "", const std::string& id = "somegraph",
+    IdTracking::e idTracking = IdTracking::EXACT);
+  StreamingGraphWriter(std::ostream& out, bool isDigraph = false,
+    const std::string& label = "", const std::string& id = "somegraph",
+    IdTracking::e idTracking = IdTracking::EXACT);
+
+  /**
+   * Closes any graphs that are still open.
+   */
+  virtual ~StreamingGraphWriter();
+
+  bool IsDigraph() const {
+    return _isDigraph;
+  }
+
+  /**
+   * Writes attribute statements for the innermost open graph.
+   */
+  void WriteAttributes(const AttributeSet& attributes);
+
+  /**
+   * Writes a 'node [...]' statement. It applies to nodes declared after it in
+   * the innermost open graph and its subgraphs.
+   */
+  void SetDefaultNodeAttributes(const NodeAttributeSet& attributes);
+
+  /**
+   * Writes an 'edge [...]' statement. It applies to edges declared after it in
+   * the innermost open graph and its subgraphs.
+   */
+  void SetDefaultEdgeAttributes(const EdgeAttributeSet& attributes);
+
+  /**
+   * Writes a node into the innermost open graph, and returns its id.
+   */
+  std::string AddNode(const std::string& label = "");
+  std::string AddNode(const std::string& label, const std::string& id);
+  std::string AddNode(const NodeAttributeSet& attributes,
+    const std::string& label = "");
+  std::string AddNode(const NodeAttributeSet& attributes,
+    const std::string& label, const std::string& id);
+
+  /**
+   * Writes an edge between two previously returned node ids.
+   */
+  void AddEdge(const std::string& src, const std::string& dst);
+  void AddEdge(const std::string& src, const std::string& dst,
+    const EdgeAttributeSet& attributes);
+
+  /**
+   * Opens a subgraph inside the innermost open graph, and returns its id.
+   * Everything written until the matching EndSubgraph goes into it. An empty
+   * id means that one is generated.
+   */
+  std::string BeginSubgraph(const std::string& label = "");
+  std::string BeginSubgraph(const std::string& label, const std::string& id);
+  std::string BeginSubgraph(const SubgraphAttributeSet& attributes,
+    const std::string& label = "");
+  std::string BeginSubgraph(const SubgraphAttributeSet& attributes,
+    const std::string& label, const std::string& id);
+
+  /**
+   * Same as BeginSubgraph, but opens a cluster.
+   */
+  std::string BeginCluster(const std::string& label = "");
+  std::string BeginCluster(const std::string& label, const std::string& id);
+  std::string BeginCluster(const ClusterAttributeSet& attributes,
+    const std::string& label = "");
+  std::string BeginCluster(const ClusterAttributeSet& attributes,
+    const std::string& label, const std::string& id);
+
+  /**
+   * Closes the innermost open subgraph or cluster.
+   */
+  void EndSubgraph();
+
+  /**
+   * Closes every open graph, including the root graph, and flushes the
+   * output. Nothing may be written afterwards.
+   */
+  void Close();
+
+  /**
+   * Output is buffered; this pushes what has been written so far to the
+   * underlying sink or stream. Returns false if writing has failed.
+   */
+  bool Flush();
+};
+
+}  // namespace DotWriter
+
+#endif
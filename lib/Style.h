@@ -0,0 +1,146 @@
+/**
+ * Attribute sets that any number of nodes or edges can share.
+ *
+ * Large graphs tend to use a handful of looks over and over. Rather than
+ * every element carrying its own copy of the same attributes, elements hold
+ * a Style: a reference counted handle to an attribute set. Handles are cheap
+ * to copy, and the set they refer to never changes while it is shared.
+ * Mutable() gives the handle a private copy first if anyone else refers to
+ * its set (copy-on-write). Sets made that way can come from a StylePool
+ * instead of the heap.
+ *
+ * Handles may be copied and dropped from several threads at once, but a single
+ * handle must not be used from two threads at the same time.
+ */
+
+#ifndef DOTWRITER_STYLE_H_
+#define DOTWRITER_STYLE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+#include "AttributeSet.h"
+#include "StylePool.h"
+
+namespace DotWriter {
+
+template <typename T>
+class Style {
+private:
+  struct Block {
+    T attributes;
+    std::atomic<unsigned> references;
+    StylePool* pool;  // Where the block came from, or NULL for the heap.
+
+    Block(StylePool* pool) : references(1), pool(pool) {};
+    Block(const T& other, StylePool* pool) :
+      attributes(other), references(1), pool(pool) {};
+  };
+
+  Block* _block;  // NULL until the style has any attributes.
+
+  /**
+   * A new block from pool, or from the heap if pool is NULL, with a copy of
+   * attributes if given.
+   */
+  static Block* NewBlock(const T* attributes, StylePool* pool) {
+    void* memory = pool == NULL ? ::operator new(sizeof(Block)) :
+      pool->Allocate(sizeof(Block));
+    return attributes == NULL ? new (memory) Block(pool) :
+      new (memory) Block(*attributes, pool);
+  }
+
+  void Release() {
+    if (_block != NULL && _block->references.fetch_sub(1) == 1) {
+      StylePool* pool = _block->pool;
+      _block->~Block();
+      if (pool == NULL) {
+        ::operator delete(_block);
+      } else {
+        pool->Deallocate(_block, sizeof(Block));
+      }
+    }
+    _block = NULL;
+  }
+
+public:
+  /**
+   * What Get returns for a style without attributes.
+   */
+  static const T& EmptySet() {
+    static const T empty;
+    return empty;
+  }
+
+  Style() : _block(NULL) {};
+
+  /**
+   * A new style with a copy of the given attributes.
+   */
+  explicit Style(const T& attributes) :
+    _block(NewBlock(&attributes, NULL)) {};
+
+  Style(const Style& other) : _block(other._block) {
+    if (_block != NULL) _block->references.fetch_add(1);
+  }
+
+  Style& operator=(const Style& other) {
+    if (other._block != NULL) other._block->references.fetch_add(1);
+    Release();
+    _block = other._block;
+    return *this;
+  }
+
+  ~Style() {
+    Release();
+  }
+
+  /**
+   * The style's attributes. Valid for as long as this handle keeps referring
+   * to them; the address identifies the shared set.
+   */
+  const T& Get() const {
+    return _block == NULL ? EmptySet() : _block->attributes;
+  }
+
+  bool Empty() const {
+    return _block == NULL || _block->attributes.Empty();
+  }
+
+  bool IsShared() const {
+    return _block != NULL && _block->references.load() > 1;
+  }
+
+  /**
+   * Returns true if both handles refer to the same attribute set.
+   */
+  bool SameAs(const Style& other) const {
+    return _block == other._block;
+  }
+
+  /**
+   * Returns the attributes for modification, after copying them if they are
+   * shared. From then on, listener is told about changes to them (see
+   * AttributeSet::SetListener). A copy, or the first set of a style without
+   * attributes, comes from pool if given.
+   */
+  T& Mutable(AttributeListener* listener = NULL, StylePool* pool = NULL) {
+    if (_block == NULL) {
+      _block = NewBlock(NULL, pool);
+    } else if (IsShared()) {
+      Block* copy = NewBlock(&_block->attributes, pool);
+      Release();
+      _block = copy;
+    }
+    _block->attributes.SetListener(listener);
+    return _block->attributes;
+  }
+};
+
+typedef Style<NodeAttributeSet> SharedNodeStyle;
+typedef Style<EdgeAttributeSet> SharedEdgeStyle;
+
+}  // namespace DotWriter
+
+#endif
@@ -0,0 +1,34 @@
+#include "StylePool.h"
+
+namespace DotWriter {
+
+void* StylePool::Allocate(size_t size) {
+  void* ptr;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ptr = _arena.Allocate(size);
+  }
+  _references.fetch_add(1);
+  return ptr;
+}
+
+void StylePool::Deallocate(void* ptr, size_t size) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _arena.Deallocate(ptr, size);
+  }
+  Release();
+}
+
+void StylePool::Release() {
+  if (_references.fetch_sub(1) == 1) {
+    delete this;
+  }
+}
+
+size_t StylePool::GetReservedBytes() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _arena.GetReservedBytes();
+}
+
+}  // namespace DotWriter
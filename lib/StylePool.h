@@ -0,0 +1,69 @@
+/**
+ * Where the attribute sets of a root graph's elements live.
+ *
+ * Giving a node or edge attributes of its own (Node::MutableAttributes) takes
+ * a Style block from its root's pool rather than from the heap, so graphs
+ * that style many elements individually do not pay for an allocation per
+ * element.
+ *
+ * A block can outlive the graph it came from, e.g. when a style handle is
+ * kept or given to another graph, and can be dropped from any thread. The
+ * pool is therefore reference counted: the root graph holds one reference,
+ * every block taken from the pool holds another, and the pool goes away with
+ * the last of them.
+ */
+
+#ifndef DOTWRITER_STYLEPOOL_H_
+#define DOTWRITER_STYLEPOOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+#include "Arena.h"
+
+namespace DotWriter {
+
+class StylePool {
+private:
+  std::mutex _mutex;
+  Arena _arena;
+  std::atomic<unsigned> _references;
+
+  ~StylePool() {};
+
+  // Not copyable.
+  StylePool(const StylePool&);
+  StylePool& operator=(const StylePool&);
+
+public:
+  /**
+   * A new pool, with a single reference held by the caller.
+   */
+  StylePool() : _references(1) {};
+
+  /**
+   * Returns uninitialized memory for a block of the given size. The block
+   * holds a reference to the pool until it is given back.
+   */
+  void* Allocate(size_t size);
+
+  /**
+   * Gives a block obtained from Allocate back, along with its reference.
+   */
+  void Deallocate(void* ptr, size_t size);
+
+  /**
+   * Drops a reference to the pool, destroying it if that was the last.
+   */
+  void Release();
+
+  /**
+   * Number of bytes the pool has requested from the system allocator.
+   */
+  size_t GetReservedBytes();
+};
+
+}  // namespace DotWriter
+
+#endif
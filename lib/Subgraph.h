@@ -18,9 +18,11 @@ private:
   SubgraphAttributeSet _attributes;
 
 public:
-  Subgraph(const std::string& id, IdManager* idManager, bool isDigraph = false,
-    std::string label = "") : Graph(idManager, isDigraph, label, id),
+  Subgraph(IdHandle id, IdManager* idManager, Arena* arena,
+    StylePool* stylePool, bool isDigraph = false, std::string label = "") :
+    Graph(idManager, arena, stylePool, id, isDigraph, std::move(label)),
     _attributes(SubgraphAttributeSet()) {
+    _attributes.SetListener(this);
   }
 
   virtual ~Subgraph() {};
@@ -30,7 +32,15 @@ public:
     return _attributes;
   }
 
-  virtual void Print(std::ostream& out, unsigned tabDepth);
+  const SubgraphAttributeSet& GetAttributes() const {
+    return _attributes;
+  }
+
+protected:
+  virtual void PrintHeader(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth) const;
+  virtual void PrintFooter(DotSink& out, const PrintOptions& options,
+    unsigned tabDepth) const;
 };
 
 }  // namespace DotWriter
@@ -0,0 +1,28 @@
+#include "TextProvider.h"
+
+#include "DotSink.h"
+#include "Util.h"
+
+namespace DotWriter {
+
+void SinkAttributeWriter::Add(std::string_view name, std::string_view value) {
+  if (_open) {
+    _out.Write(_compact ? "," : ", ");
+  } else {
+    _out.Write(_compact ? "[" : " [");
+    _open = true;
+  }
+
+  _out.Write(name.data(), name.size());
+  if (_compact && IsPlainId(value.data(), value.size())) {
+    _out.Put('=');
+    _out.Write(value.data(), value.size());
+    return;
+  }
+
+  _out.Write("=\"", 2);
+  _out.WriteEscaped(value.data(), value.size());
+  _out.Put('"');
+}
+
+}  // namespace DotWriter
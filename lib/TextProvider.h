@@ -0,0 +1,88 @@
+/**
+ * Labels and attributes that are worked out while a graph is printed,
+ * rather than stored in it (see Graph::SetTextProvider).
+ *
+ * Long labels on millions of nodes take up far more memory than the nodes
+ * themselves, and are often never printed, or printed just once. A
+ * TextProvider produces them on demand instead: each time a node or edge is
+ * printed, it is asked for attributes to add, which go straight into the
+ * output and are then forgotten.
+ */
+
+#ifndef DOTWRITER_TEXTPROVIDER_H_
+#define DOTWRITER_TEXTPROVIDER_H_
+
+#include <string_view>
+
+namespace DotWriter {
+
+class DotSink;
+class Edge;
+class Node;
+
+/**
+ * Receives a node's or edge's provided attributes.
+ */
+class AttributeWriter {
+public:
+  virtual ~AttributeWriter() {};
+
+  /**
+   * Adds the attribute called name, e.g. "label" or "tooltip". value is
+   * plain text, which is escaped on the way out. Added attributes win over
+   * the element's own, including its label, as do later ones over earlier
+   * ones.
+   */
+  virtual void Add(std::string_view name, std::string_view value) = 0;
+};
+
+/**
+ * Derive from this, and override the functions for the elements that
+ * something should be added for.
+ *
+ * Provided text is seen by everything that prints: Print, WriteToFile,
+ * PrintParallel (where the functions are called from several threads at
+ * once), the level of detail settings in PrintOptions, and
+ * GraphvizRenderer. It is not part of the graph as far as anything else is
+ * concerned, such as RootGraph::Diff, Graph::Merge or snapshots.
+ */
+class TextProvider {
+public:
+  virtual ~TextProvider() {};
+
+  virtual void AddNodeText(const Node& /*node*/,
+    AttributeWriter& /*out*/) const {};
+  virtual void AddEdgeText(const Edge& /*edge*/,
+    AttributeWriter& /*out*/) const {};
+};
+
+/**
+ * Writes provided attributes into the bracketed attribute list of a DOT
+ * statement. Used by Node::Print and Edge::Print.
+ */
+class SinkAttributeWriter : public AttributeWriter {
+private:
+  DotSink& _out;
+  bool _compact;
+  bool _open;
+
+public:
+  /**
+   * open says whether the list's opening bracket has been printed already.
+   */
+  SinkAttributeWriter(DotSink& out, bool compact, bool open) :
+    _out(out), _compact(compact), _open(open) {};
+
+  virtual void Add(std::string_view name, std::string_view value);
+
+  /**
+   * Returns true if the list has been opened, and so needs closing.
+   */
+  bool IsOpen() const {
+    return _open;
+  }
+};
+
+}  // namespace DotWriter
+
+#endif
@@ -1,5 +1,17 @@
 #include "Util.h"
 
+#include <charconv>
+#include <cstring>
+#include <strings.h>
+
+#if defined(__SSE2__)
+#define DOTWRITER_ESCAPE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define DOTWRITER_ESCAPE_NEON
+#include <arm_neon.h>
+#endif
+
 namespace DotWriter {
 
 /**
@@ -21,15 +33,197 @@ void ReplaceAll(std::string& str, const std::string& from, const std::string& to
  * Takes a string and escapes necessary characters for output to a
  * DOT file.
  *
- * Currently, it just escapes quotation marks with a forward slash,
- * and changes newlines to \n.
+ * Quotation marks get a backslash in front of them, and newlines are changed
+ * to \n. Other backslashes are left for Graphviz (see AppendEscaped).
  */
 std::string SanitizeString(std::string& label) {
-    // escape a double quote
-    ReplaceAll(label, "\"", "\\\"");
-    // newline -> \n
-    ReplaceAll(label, "\n", "\\n");
+    if (NeedsEscaping(label.data(), label.size())) {
+      std::string escaped;
+      AppendEscaped(escaped, label.data(), label.size());
+      label.swap(escaped);
+    }
     return label;
 }
 
+static inline bool IsSpecial(char c) {
+  return c == '"' || c == '\n';
+}
+
+bool EndsInOddBackslashes(const char* data, size_t end) {
+  size_t run = 0;
+  while (run < end && data[end - run - 1] == '\\') run++;
+  return run % 2 == 1;
+}
+
+size_t FindEscapedCharacter(const char* data, size_t pos, size_t length) {
+#if defined(DOTWRITER_ESCAPE_SSE2)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i newline = _mm_set1_epi8('\n');
+  for (; pos + 16 <= length; pos += 16) {
+    __m128i chunk =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+      _mm_cmpeq_epi8(chunk, newline));
+    int mask = _mm_movemask_epi8(hits);
+    if (mask != 0) return pos + __builtin_ctz(mask);
+  }
+#elif defined(DOTWRITER_ESCAPE_NEON)
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t newline = vdupq_n_u8('\n');
+  for (; pos + 16 <= length; pos += 16) {
+    uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(data + pos));
+    uint8x16_t hits = vorrq_u8(vceqq_u8(chunk, quote),
+      vceqq_u8(chunk, newline));
+    // Only find out where the hit is once we know there is one.
+    if (vmaxvq_u8(hits) != 0) break;
+  }
+#endif
+
+  for (; pos < length; pos++) {
+    if (IsSpecial(data[pos])) return pos;
+  }
+  return length;
+}
+
+bool NeedsEscaping(const char* data, size_t length) {
+  return FindEscapedCharacter(data, 0, length) != length ||
+    EndsInOddBackslashes(data, length);
+}
+
+void AppendEscaped(std::string& out, const char* data, size_t length) {
+  if (!NeedsEscaping(data, length)) {
+    out.append(data, length);
+    return;
+  }
+
+  // Every special character grows by one, and so does every odd run of
+  // backslashes in front of one or at the end.
+  size_t numExtra = EndsInOddBackslashes(data, length) ? 1 : 0;
+  for (size_t pos = FindEscapedCharacter(data, 0, length); pos < length;
+    pos = FindEscapedCharacter(data, pos + 1, length)) {
+    numExtra += EndsInOddBackslashes(data, pos) ? 2 : 1;
+  }
+
+  size_t outPos = out.size();
+  out.resize(outPos + length + numExtra);
+  char* dst = &out[outPos];
+
+  size_t pos = 0;
+  while (true) {
+    size_t next = FindEscapedCharacter(data, pos, length);
+    memcpy(dst, data + pos, next - pos);
+    dst += next - pos;
+    if (EndsInOddBackslashes(data, next)) *dst++ = '\\';
+    if (next == length) break;
+
+    *dst++ = '\\';
+    *dst++ = data[next] == '\n' ? 'n' : data[next];
+    pos = next + 1;
+  }
+}
+
+const std::string& EscapeString(const std::string& str, std::string& scratch) {
+  if (!NeedsEscaping(str.data(), str.size())) return str;
+
+  scratch.clear();
+  AppendEscaped(scratch, str.data(), str.size());
+  return scratch;
+}
+
+static const char digitPairs[] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+size_t FormatUnsigned(unsigned long value, char* buffer) {
+  // Fill a scratch buffer from the end two digits at a time, then copy.
+  char scratch[20];
+  char* end = scratch + sizeof(scratch);
+  char* pos = end;
+
+  while (value >= 100) {
+    unsigned pair = (value % 100) * 2;
+    value /= 100;
+    *--pos = digitPairs[pair + 1];
+    *--pos = digitPairs[pair];
+  }
+
+  if (value >= 10) {
+    unsigned pair = value * 2;
+    *--pos = digitPairs[pair + 1];
+    *--pos = digitPairs[pair];
+  } else {
+    *--pos = static_cast<char>('0' + value);
+  }
+
+  size_t length = end - pos;
+  memcpy(buffer, pos, length);
+  return length;
+}
+
+void AppendUnsigned(std::string& str, unsigned long value) {
+  char buffer[20];
+  str.append(buffer, FormatUnsigned(value, buffer));
+}
+
+size_t FormatDouble(double value, char* buffer) {
+  std::to_chars_result result = std::to_chars(buffer, buffer + 32, value);
+  return result.ptr - buffer;
+}
+
+void AppendDouble(std::string& str, double value) {
+  char buffer[32];
+  str.append(buffer, FormatDouble(value, buffer));
+}
+
+static inline bool IsIdStart(unsigned char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' ||
+    c >= 0x80;
+}
+
+static inline bool IsDigit(unsigned char c) {
+  return c >= '0' && c <= '9';
+}
+
+static bool IsKeyword(const char* data, size_t length) {
+  static const char* const keywords[] = {
+    "node", "edge", "graph", "digraph", "subgraph", "strict"
+  };
+  for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+    if (strlen(keywords[i]) == length &&
+      strncasecmp(keywords[i], data, length) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IsPlainId(const char* data, size_t length) {
+  if (length == 0) return false;
+
+  const unsigned char* text = reinterpret_cast<const unsigned char*>(data);
+  if (IsIdStart(text[0])) {
+    for (size_t i = 1; i < length; i++) {
+      if (!IsIdStart(text[i]) && !IsDigit(text[i])) return false;
+    }
+    return !IsKeyword(data, length);
+  }
+
+  // A numeral: [-]?(.[0-9]+ | [0-9]+(.[0-9]*)?)
+  size_t i = text[0] == '-' ? 1 : 0;
+  size_t digits = 0;
+  for (; i < length && IsDigit(text[i]); i++) digits++;
+  if (i < length && text[i] == '.') {
+    for (i++; i < length && IsDigit(text[i]); i++) digits++;
+  }
+  return i == length && digits > 0;
+}
+
 }  // namespace DotWriter
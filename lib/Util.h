@@ -17,14 +17,87 @@ void ReplaceAll(std::string& str, const std::string& from,
 
 /**
  * Takes a string and escapes necessary characters for output to a
- * DOT file.
+ * DOT file, in place.
  *
- * Currently, it just escapes quotation marks with a forward slash.
+ * Quotation marks are escaped with a backslash, and newlines become \n. See
+ * AppendEscaped.
  *
  * This is used to sanitize IDs and labels during DOT file writing.
  */
 std::string SanitizeString(std::string& label);
 
+/**
+ * Returns true if any character in data must be escaped to appear inside a
+ * quoted DOT string.
+ */
+bool NeedsEscaping(const char* data, size_t length);
+
+/**
+ * Returns the position of the first character in [pos, length) that must be
+ * escaped, or length if there is none.
+ */
+size_t FindEscapedCharacter(const char* data, size_t pos, size_t length);
+
+/**
+ * Returns true if data[0, end) ends in an odd number of backslashes, which
+ * would escape whatever is written after them.
+ */
+bool EndsInOddBackslashes(const char* data, size_t end);
+
+/**
+ * Appends data to out, escaped for use inside a quoted DOT string.
+ *
+ * Backslashes are left alone, so that escString sequences such as \l, \N and
+ * \G keep their meaning. The exception is an odd run of backslashes right
+ * before a character that gets escaped, or at the very end: that gets one
+ * more backslash, so the run cannot swallow the escape or the closing quote.
+ *
+ * This makes a single pass over runs that need no escaping (16 bytes at a
+ * time where SSE2 or NEON is available), and grows out exactly once.
+ */
+void AppendEscaped(std::string& out, const char* data, size_t length);
+
+/**
+ * Returns str itself if nothing in it needs escaping. Otherwise, stores the
+ * escaped text in scratch and returns that.
+ */
+const std::string& EscapeString(const std::string& str, std::string& scratch);
+
+/**
+ * Returns true if data can appear in a DOT file as is, without quotes: an
+ * identifier or a number, but not a keyword.
+ */
+bool IsPlainId(const char* data, size_t length);
+
+/**
+ * Writes the decimal digits of value into buffer, which must have room for at
+ * least 20 characters. No terminating NUL is written. Returns the number of
+ * characters written.
+ *
+ * Unlike std::ostream, this does not consult the locale.
+ */
+size_t FormatUnsigned(unsigned long value, char* buffer);
+
+/**
+ * Appends the decimal digits of value to str.
+ */
+void AppendUnsigned(std::string& str, unsigned long value);
+
+/**
+ * Writes the shortest text that reads back as exactly value into buffer, which
+ * must have room for at least 32 characters. No terminating NUL is written.
+ * Returns the number of characters written.
+ *
+ * Like FormatUnsigned, this does not consult the locale, so the decimal point
+ * is always '.'.
+ */
+size_t FormatDouble(double value, char* buffer);
+
+/**
+ * Appends the text of value, as formatted by FormatDouble, to str.
+ */
+void AppendDouble(std::string& str, double value);
+
 }  // namespace DotWriter
 
 #endif